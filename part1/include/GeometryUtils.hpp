@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 struct Point { // Struct representing a 2D point with x and y coordinates.
@@ -12,9 +14,86 @@ struct Point { // Struct representing a 2D point with x and y coordinates.
      * @param other The point to compare to.
      * @return true if this point is less than the other.
      */
-    bool operator<(const Point& other) const;
+    bool operator<(const Point& other) const {
+        return x < other.x || (x == other.x && y < other.y);
+    }
 };
 
+/**
+ * @struct BasicPoint
+ * @brief A 2D point with integer coordinates of type T.
+ * 
+ * Point stays a plain struct rather than BasicPoint<double>: part2 shares its
+ * layout and links against the functions declared with it.
+ */
+template <typename T>
+struct BasicPoint {
+    T x, y;
+
+    /**
+     * @brief Comparison operator to sort points, by x and then by y.
+     * 
+     * @param other The point to compare to.
+     * @return true if this point is less than the other.
+     */
+    bool operator<(const BasicPoint& other) const {
+        return x < other.x || (x == other.x && y < other.y);
+    }
+};
+
+typedef BasicPoint<int32_t> Point32; // Integer grid coordinates, half the memory of Point
+typedef BasicPoint<int64_t> Point64; // Integer coordinates within +-INT64_COORDINATE_LIMIT
+
+/**
+ * @brief Point64 coordinates must have a magnitude below this for the hull to stay exact.
+ * 
+ * Coordinate differences then fit in int64_t and the cross product in __int128.
+ */
+const int64_t INT64_COORDINATE_LIMIT = int64_t(1) << 62;
+
+/**
+ * @struct CoordinateTraits
+ * @brief Arithmetic of the hull's orientation test for one coordinate type.
+ * 
+ * Wide holds the cross product of two coordinate differences. For integer
+ * coordinates it is wide enough for the product to be exact, so collinear
+ * points are always detected; for double it is double, as before.
+ */
+template <typename T>
+struct CoordinateTraits;
+
+template <>
+struct CoordinateTraits<double> {
+    typedef double Wide;
+
+    static Wide cross(const Point& O, const Point& A, const Point& B) {
+        return (A.x - O.x) * (B.y - O.y) - (A.y - O.y) * (B.x - O.x);
+    }
+};
+
+template <>
+struct CoordinateTraits<int32_t> {
+    typedef __int128 Wide; // Differences fit in 33 bits, their products in 66
+
+    static Wide cross(const Point32& O, const Point32& A, const Point32& B) {
+        return Wide(int64_t(A.x) - O.x) * (int64_t(B.y) - O.y) - Wide(int64_t(A.y) - O.y) * (int64_t(B.x) - O.x);
+    }
+};
+
+template <>
+struct CoordinateTraits<int64_t> {
+    typedef __int128 Wide; // Exact while coordinates stay within INT64_COORDINATE_LIMIT
+
+    static Wide cross(const Point64& O, const Point64& A, const Point64& B) {
+        return Wide(A.x - O.x) * (B.y - O.y) - Wide(A.y - O.y) * (B.x - O.x);
+    }
+};
+
+/**
+ * @brief Integer inputs smaller than this are sorted with std::sort instead of a radix sort.
+ */
+const size_t RADIX_SORT_THRESHOLD = 256;
+
 /**
  * @brief Computes the convex hull of a set of 2D points using the Monotone Chain algorithm.
  * 
@@ -23,6 +102,166 @@ struct Point { // Struct representing a 2D point with x and y coordinates.
  */
 std::vector<Point> compute_convex_hull(std::vector<Point> points);
 
+/**
+ * @brief Computes the convex hull of integer points using the Monotone Chain algorithm.
+ * 
+ * The same algorithm as for Point, but the points are sorted with an LSD
+ * radix sort and tested with the exact cross product of CoordinateTraits,
+ * so the hull of integer input is exact.
+ * 
+ * @param points The input vector of points.
+ * @return A vector of points representing the convex hull in counter-clockwise order.
+ */
+std::vector<Point32> compute_convex_hull(std::vector<Point32> points);
+
+/**
+ * @brief Computes the convex hull of integer points within INT64_COORDINATE_LIMIT.
+ * 
+ * @param points The input vector of points.
+ * @return A vector of points representing the convex hull in counter-clockwise order.
+ */
+std::vector<Point64> compute_convex_hull(std::vector<Point64> points);
+
+/**
+ * @brief Inputs smaller than this are always processed on a single thread.
+ */
+const size_t PARALLEL_HULL_THRESHOLD = 100000;
+
+/**
+ * @brief Fewest points a parallel hull hands each thread; fewer threads are used otherwise.
+ */
+const size_t PARALLEL_MIN_CHUNK = 16384;
+
+/**
+ * @brief Inputs smaller than this skip the interior-point pre-filter.
+ */
+const size_t PREFILTER_THRESHOLD = 1000;
+
+/**
+ * @struct HullOptions
+ * @brief Runtime settings for compute_convex_hull().
+ */
+struct HullOptions {
+    unsigned threads = 1;   // Worker threads; 0 uses every hardware thread
+    bool prefilter = true;  // Drop points inside the Akl-Toussaint octagon before sorting
+};
+
+/**
+ * @brief Computes the convex hull of a set of 2D points with the given options.
+ * 
+ * With more than one thread and at least PARALLEL_HULL_THRESHOLD points, the points
+ * are sorted in parallel chunks, each chunk builds its own lower and upper chains,
+ * and a final Monotone Chain pass over the chunk chains merges them. Otherwise it
+ * falls back to the serial algorithm. With prefilter enabled, points strictly
+ * inside the octagon of the eight extreme points are discarded first, so only
+ * candidates that may lie on the hull are sorted. The result is identical in all cases.
+ * 
+ * @param points The input vector of points.
+ * @param options Thread count and other settings.
+ * @return A vector of points representing the convex hull in counter-clockwise order.
+ */
+std::vector<Point> compute_convex_hull(std::vector<Point> points, const HullOptions& options);
+
+/**
+ * @struct PointColumns
+ * @brief Read-only view of points stored as x and y coordinate arrays.
+ * 
+ * Point i is (x[i * stride], y[i * stride]): separate columns have stride 1,
+ * interleaved x,y pairs have stride 2 with y == x + 1. Used to run the hull on
+ * memory-mapped point files without copying them first.
+ */
+struct PointColumns {
+    const double* x; // First x coordinate
+    const double* y; // First y coordinate
+    size_t stride;   // Distance in doubles between consecutive points
+    size_t count;    // Number of points
+
+    size_t size() const { return count; }
+    Point operator[](size_t i) const { return Point{x[i * stride], y[i * stride]}; }
+};
+
+/**
+ * @brief Computes the convex hull of read-only point columns with the given options.
+ * 
+ * Only the points that survive the prefilter are copied out of the columns,
+ * so a memory-mapped input is never duplicated as a whole. Same result as
+ * the vector overload.
+ * 
+ * Coordinates are checked for NaN and infinity in the same pass, block by
+ * block as the prefilter reads them, since those values would break the
+ * sort order.
+ * 
+ * @param points The input points.
+ * @param options Thread count and other settings.
+ * @param hull Receives the points of the convex hull in counter-clockwise order.
+ * @return false if a coordinate is NaN or infinite; hull is then left empty.
+ */
+bool compute_convex_hull(const PointColumns& points, const HullOptions& options, std::vector<Point>& hull);
+
+/**
+ * @brief Default number of points StreamingHull buffers before each merge.
+ */
+const size_t STREAM_CHUNK_SIZE = 1 << 20;
+
+/**
+ * @class StreamingHull
+ * @brief Convex hull of a point stream too large to hold in memory.
+ * 
+ * Points are buffered in fixed-size chunks. Each full chunk is merged into
+ * the running hull by taking the hull of both together, which is the hull of
+ * everything seen so far since hull(A + B) = hull(hull(A) + B). Memory stays
+ * O(chunk + h) however long the stream is.
+ */
+class StreamingHull {
+public:
+    /**
+     * @brief Creates an empty stream.
+     * 
+     * @param chunk_size Points buffered per merge (at least 1).
+     * @param options Settings used for every merge.
+     */
+    explicit StreamingHull(size_t chunk_size = STREAM_CHUNK_SIZE, const HullOptions& options = HullOptions());
+
+    /**
+     * @brief Adds one point, merging the chunk once it is full.
+     * 
+     * @param p The point to add.
+     */
+    void add(const Point& p);
+
+    /**
+     * @brief Adds every point of a column view, e.g. a mapped point file.
+     * 
+     * @param points The points to add.
+     * @return false if a coordinate is NaN or infinite; the points before it were added.
+     */
+    bool add(const PointColumns& points);
+
+    /**
+     * @brief Merges the buffered points and returns the hull of everything added.
+     * 
+     * @return The hull in counter-clockwise order, valid until the next add().
+     */
+    const std::vector<Point>& hull();
+
+    /**
+     * @brief Number of points added so far.
+     */
+    unsigned long long count() const;
+
+private:
+    /**
+     * @brief Replaces the running hull with the hull of itself and the buffer.
+     */
+    void merge();
+
+    HullOptions options;          // Settings for each merge
+    size_t chunk_size;            // Buffer size that triggers a merge
+    std::vector<Point> buffer;    // Points added since the last merge
+    std::vector<Point> current;   // Hull of every point merged so far
+    unsigned long long added;     // Points added so far
+};
+
 /**
  * @brief Computes the area of a polygon given its vertices in order.
  * 
@@ -32,3 +271,24 @@ std::vector<Point> compute_convex_hull(std::vector<Point> points);
  * @return The absolute area of the polygon.
  */
 double compute_area(const std::vector<Point>& polygon);
+
+/**
+ * @brief Computes the area of a polygon with integer vertices.
+ * 
+ * The shoelace sum is accumulated exactly and halved once at the end.
+ * 
+ * @param polygon The polygon's vertices in order.
+ * @return The absolute area of the polygon.
+ */
+double compute_area(const std::vector<Point32>& polygon);
+
+/**
+ * @brief Computes the area of a polygon with integer vertices within INT64_COORDINATE_LIMIT.
+ * 
+ * Each triangle of a fan from the first vertex is computed exactly; the sum
+ * is accumulated in long double, since it may not fit in __int128.
+ * 
+ * @param polygon The polygon's vertices in order.
+ * @return The absolute area of the polygon.
+ */
+double compute_area(const std::vector<Point64>& polygon);
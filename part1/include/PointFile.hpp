@@ -0,0 +1,91 @@
+#pragma once
+#include "GeometryUtils.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @brief Binary point-set files that the CLIs map into memory instead of parsing text.
+ *
+ * A file is a 64-byte PointFileHeader followed by count points stored as
+ * doubles in the producer's byte order, in one of two layouts:
+ * - PointLayout::Interleaved: x0, y0, x1, y1, ...
+ * - PointLayout::Columns: x0, x1, ..., then y0, y1, ...
+ *
+ * The header keeps the doubles 8-byte aligned, so the mapped data is read in
+ * place through a PointColumns view. Files are produced from the text format
+ * by ConvertPoints.
+ */
+
+#define POINT_FILE_MAGIC "CHPOINTS"     // First 8 bytes of every file, no terminator
+#define POINT_FILE_BYTE_ORDER 0x01020304u // Reads differently on a host of the other endianness
+
+/**
+ * @enum PointLayout
+ * @brief How the coordinates follow the header.
+ */
+enum class PointLayout : uint32_t {
+    Interleaved = 0, // x,y pairs
+    Columns = 1      // All x values, then all y values
+};
+
+/**
+ * @struct PointFileHeader
+ * @brief Fixed-size header at the start of a point file.
+ */
+struct PointFileHeader {
+    char magic[8];       // POINT_FILE_MAGIC
+    uint32_t byte_order; // POINT_FILE_BYTE_ORDER as written by the producer
+    uint32_t layout;     // A PointLayout value
+    uint64_t count;      // Number of points
+    double min_x, min_y; // Bounding box of the points (all 0 when count is 0)
+    double max_x, max_y;
+    uint64_t reserved;   // Written as 0
+};
+
+static_assert(sizeof(PointFileHeader) == 64, "PointFileHeader must stay 64 bytes");
+
+/**
+ * @struct MappedPointFile
+ * @brief A point file mapped read-only into memory.
+ */
+struct MappedPointFile {
+    PointFileHeader header;               // Copy of the file's header
+    PointColumns points = PointColumns(); // View of the mapped coordinates
+    void* base = nullptr;                 // Start of the mapping
+    size_t length = 0;                    // Length of the mapping in bytes
+};
+
+/**
+ * @brief Maps a point file and checks its header against its size.
+ *
+ * The coordinates are not read here, so mapping costs no pass over the data;
+ * the hull functions that consume the mapping reject NaN and infinite
+ * coordinates as they read them (see compute_convex_hull()).
+ *
+ * @param path The file to map.
+ * @param file Receives the mapping; release it with unmap_point_file().
+ * @param error Receives a message if the file cannot be used.
+ * @return true on success.
+ */
+bool map_point_file(const char* path, MappedPointFile& file, std::string& error);
+
+/**
+ * @brief Releases a mapping made by map_point_file().
+ *
+ * @param file The mapping; left empty.
+ */
+void unmap_point_file(MappedPointFile& file);
+
+/**
+ * @brief Writes points to a new point file.
+ *
+ * @param path The file to create or truncate.
+ * @param points The points to store.
+ * @param layout Coordinate layout to write.
+ * @param error Receives a message if writing fails.
+ * @return true on success.
+ */
+bool write_point_file(const char* path, const std::vector<Point>& points, PointLayout layout, std::string& error);
@@ -0,0 +1,102 @@
+#include "../include/GeometryUtils.hpp"
+#include "../include/PointFile.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @brief Converts the text point format into a binary point file.
+ *
+ * Reads the same input as ConvexHull from stdin (a count N, then N lines
+ * x,y; invalid lines are reported and skipped) and writes the points to a
+ * file that ConvexHull --input and part2's ConvexHullDeque --input map directly.
+ *
+ * Usage: ConvertPoints [--columns] OUTPUT
+ * - --columns: store all x values, then all y values (default: x,y pairs).
+ */
+
+/**
+ * @brief Parses a whole string as a finite double.
+ *
+ * @param s The text, without surrounding content.
+ * @param value Receives the number.
+ * @return false if s is not exactly one finite number.
+ */
+static bool parse_double(const std::string& s, double& value) {
+    if (s.empty()) return false;
+    char* end = nullptr;
+    value = std::strtod(s.c_str(), &end);
+    return end == s.c_str() + s.size() && std::isfinite(value);
+}
+
+/**
+ * @brief Reads the text points from stdin and writes the binary file.
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments (see the usage above).
+ * @return 0 on success, 1 on invalid arguments, input or output errors.
+ */
+int main(int argc, char* argv[]) {
+    PointLayout layout = PointLayout::Interleaved;
+    const char* output = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--columns") == 0) layout = PointLayout::Columns;
+        else if (!output) output = argv[i];
+        else {
+            output = nullptr; // More than one output file
+            break;
+        }
+    }
+    if (!output) {
+        std::cerr << "Usage: " << argv[0] << " [--columns] OUTPUT < input.txt" << std::endl;
+        return 1;
+    }
+
+    std::string line;
+    long n = 0;
+    while (true) {
+        if (!std::getline(std::cin, line)) {
+            std::cerr << "ERROR: Missing number of points." << std::endl;
+            return 1;
+        }
+        char* end = nullptr;
+        n = std::strtol(line.c_str(), &end, 10);
+        if (end != line.c_str() && n > 0) break;
+        std::cerr << "ERROR: Invalid number format." << std::endl;
+    }
+
+    std::vector<Point> points;
+    points.reserve(static_cast<size_t>(std::min(n, 1L << 24)));
+    while (static_cast<long>(points.size()) < n) {
+        if (!std::getline(std::cin, line)) {
+            std::cerr << "ERROR: Unexpected end of input — expected "
+                      << (n - points.size()) << " more point(s)." << std::endl;
+            return 1;
+        }
+        if (line.empty()) continue;
+
+        size_t comma = line.find(',');
+        if (comma == std::string::npos) {
+            std::cerr << "ERROR: Invalid point format." << std::endl;
+            continue;
+        }
+        Point p;
+        if (!parse_double(line.substr(0, comma), p.x) || !parse_double(line.substr(comma + 1), p.y)) {
+            std::cerr << "ERROR: Invalid point values." << std::endl;
+            continue;
+        }
+        points.push_back(p);
+    }
+
+    std::string error;
+    if (!write_point_file(output, points, layout, error)) {
+        std::cerr << "ERROR: " << error << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,9 +1,14 @@
 #include "../include/GeometryUtils.hpp"
+#include "../include/PointFile.hpp"
 #include <iostream>
 #include <sstream>
 #include <vector>
 #include <string>
 #include <cctype>
+#include <climits>
+#include <cstring>
+#include <cstdint>
+#include <utility>
 
 /**
  * @file
@@ -19,6 +24,18 @@
  *
  * Output:
  * - A single floating-point number: the area of the convex hull.
+ *
+ * Options:
+ * - -j N: compute the hull with N threads (0 = all hardware threads). Inputs below
+ *   PARALLEL_HULL_THRESHOLD points are always processed serially.
+ * - --no-prefilter: sort every point instead of discarding interior ones first.
+ * - --input FILE: map a binary point file (written by ConvertPoints) instead of
+ *   reading text from stdin. The hull is computed on the mapped data.
+ * - --stream N: merge the points into a running hull every N points
+ *   (StreamingHull), so memory stays O(N + h) for inputs larger than RAM.
+ * - --int: read the coordinates as 32-bit integers. Points take half the
+ *   memory, are radix sorted and the hull is exact; -j and --no-prefilter do
+ *   not apply. Cannot be combined with --input or --stream.
  */
 
 /**
@@ -33,17 +50,113 @@ bool is_number(const std::string& s) {
     return (iss >> d) && iss.eof();
 }
 
+/**
+ * @brief Parses a string as a 32-bit integer coordinate.
+ * 
+ * @param s The input string to parse.
+ * @param value Receives the coordinate.
+ * @return true if the string is an integer that fits in int32_t.
+ */
+bool parse_int32(const std::string& s, int32_t& value) {
+    std::istringstream iss(s);
+    long long v;
+    if (!(iss >> v) || !iss.eof() || v < INT32_MIN || v > INT32_MAX) return false;
+    value = static_cast<int32_t>(v);
+    return true;
+}
+
+/**
+ * @brief Parses a string of decimal digits as an unsigned integer.
+ * 
+ * @param s The input string to parse.
+ * @param max Largest accepted value.
+ * @param value Receives the number.
+ * @return true if s is only digits and its value is at most max.
+ */
+bool parse_unsigned(const std::string& s, unsigned long long max, unsigned long long& value) {
+    if (s.empty() || s.size() > 19) return false; // 19 digits cannot overflow
+    value = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + static_cast<unsigned long long>(c - '0');
+    }
+    return value <= max;
+}
+
 /**
  * @brief Main entry point of the program.
  * 
  * Reads input from stdin, collects valid points, computes their convex hull,
  * and prints the area of the convex hull to stdout.
  * 
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments (see the options above).
  * @return 0 on success, 1 on input error.
  */
-int main() {
+int main(int argc, char* argv[]) {
+    HullOptions options;
+    const char* input_path = nullptr;
+    size_t stream_chunk = 0; // 0 keeps every point in memory
+    unsigned long long number; // Value of a numeric option
+    bool integer = false;     // --int
+    bool usage = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc && parse_unsigned(argv[i + 1], UINT_MAX, number)) {
+            options.threads = static_cast<unsigned>(number); // Clamped to the cores by the hull
+            ++i;
+        } else if (std::strcmp(argv[i], "--no-prefilter") == 0) {
+            options.prefilter = false;
+        } else if (std::strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            input_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--stream") == 0 && i + 1 < argc &&
+                   parse_unsigned(argv[i + 1], SIZE_MAX, number) && number > 0) {
+            stream_chunk = static_cast<size_t>(number);
+            ++i;
+        } else if (std::strcmp(argv[i], "--int") == 0) {
+            integer = true;
+        } else {
+            usage = true;
+            break;
+        }
+    }
+    if (usage || (integer && (input_path || stream_chunk))) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [-j threads] [--no-prefilter] [--input points.bin] [--stream N] [--int]" << std::endl;
+        return 1;
+    }
+
+    if (input_path) {
+        MappedPointFile file;
+        std::string error;
+        if (!map_point_file(input_path, file, error)) {
+            std::cerr << "ERROR: " << error << std::endl;
+            return 1;
+        }
+        if (file.points.size() == 0) {
+            std::cerr << "ERROR: Missing number of points." << std::endl;
+            unmap_point_file(file);
+            return 1;
+        }
+        std::vector<Point> hull;
+        bool finite; // Checked while the hull reads the mapping
+        if (stream_chunk) {
+            StreamingHull stream(stream_chunk, options);
+            finite = stream.add(file.points);
+            if (finite) hull = stream.hull();
+        } else {
+            finite = compute_convex_hull(file.points, options, hull);
+        }
+        unmap_point_file(file);
+        if (!finite) {
+            std::cerr << "ERROR: " << input_path << ": holds a NaN or infinite coordinate" << std::endl;
+            return 1;
+        }
+        std::cout << compute_area(hull) << std::endl;
+        return 0;
+    }
+
     std::string line;
-    int n = 0;
+    long long n = 0;
 
     // Read number of points from the first line
     while (true) {
@@ -59,12 +172,15 @@ int main() {
     }
 
     std::vector<Point> points;
+    std::vector<Point32> integer_points; // Used with --int
+    StreamingHull stream(stream_chunk ? stream_chunk : STREAM_CHUNK_SIZE, options); // Used with --stream
+    long long collected = 0;
 
     // Read exactly N valid points
-    while ((int)points.size() < n) {
+    while (collected < n) {
         if (!std::getline(std::cin, line)) {
             std::cerr << "ERROR: Unexpected end of input — expected " 
-                      << (n - points.size()) << " more point(s)." << std::endl;
+                      << (n - collected) << " more point(s)." << std::endl;
             return 1;
         }
 
@@ -79,6 +195,17 @@ int main() {
         std::string x_str = line.substr(0, comma);
         std::string y_str = line.substr(comma + 1);
 
+        if (integer) {
+            Point32 p;
+            if (!parse_int32(x_str, p.x) || !parse_int32(y_str, p.y)) {
+                std::cerr << "ERROR: Invalid point values." << std::endl;
+                continue;
+            }
+            integer_points.push_back(p);
+            ++collected;
+            continue;
+        }
+
         if (!is_number(x_str) || !is_number(y_str)) {
             std::cerr << "ERROR: Invalid point values." << std::endl;
             continue;
@@ -87,11 +214,18 @@ int main() {
         Point p;
         p.x = std::stod(x_str);
         p.y = std::stod(y_str);
-        points.push_back(p);
+        if (stream_chunk) stream.add(p);
+        else points.push_back(p);
+        ++collected;
+    }
+
+    if (integer) {
+        std::cout << compute_area(compute_convex_hull(std::move(integer_points))) << std::endl;
+        return 0;
     }
 
     // Compute convex hull and area
-    std::vector<Point> hull = compute_convex_hull(points);
+    std::vector<Point> hull = stream_chunk ? stream.hull() : compute_convex_hull(points, options);
     double area = compute_area(hull);
 
     // Print the result
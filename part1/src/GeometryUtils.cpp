@@ -1,43 +1,108 @@
 #include "../include/GeometryUtils.hpp"
+#include "../include/SimdKernels.hpp"
 #include <algorithm>
 #include <cmath>
+#include <thread>
+#include <type_traits>
 
 /**
- * @brief Comparison operator to sort points.
- * 
- * Points are compared first by x-coordinate, then by y-coordinate if x is equal.
+ * @brief Computes the cross product of vectors OA and OB.
  * 
- * @param other The point to compare to.
- * @return true if this point is less than the other.
+ * @param O Origin point O.
+ * @param A Endpoint of vector OA.
+ * @param B Endpoint of vector OB.
+ * @return The cross product value, exact for integer coordinates.
  */
-bool Point::operator<(const Point& other) const {
-    return x < other.x || (x == other.x && y < other.y);
+template <typename P>
+static typename CoordinateTraits<decltype(P::x)>::Wide cross(const P& O, const P& A, const P& B) {
+    return CoordinateTraits<decltype(P::x)>::cross(O, A, B);
 }
 
 /**
- * @brief Computes the cross product of vectors OA and OB.
+ * @brief Maps a signed coordinate to an unsigned radix key with the same order.
+ */
+template <typename T>
+static typename std::make_unsigned<T>::type radix_key(T value) {
+    typedef typename std::make_unsigned<T>::type Key;
+    return static_cast<Key>(value) ^ (Key(1) << (8 * sizeof(T) - 1));
+}
+
+/**
+ * @brief Sorts integer points by x, then by y, with an LSD radix sort.
  * 
- * @param O Origin point O.
- * @param A Endpoint of vector OA.
- * @param B Endpoint of vector OB.
- * @return The cross product value.
+ * One read of the input counts every byte of both coordinates. Each byte,
+ * from the lowest of y to the highest of x, is then a stable counting-sort
+ * pass; bytes shared by every point, such as the high bytes of small
+ * coordinates, are skipped.
+ * 
+ * @param points The points to sort.
+ */
+template <typename T>
+static void radix_sort(std::vector<BasicPoint<T>>& points) {
+    const unsigned bytes = sizeof(T);
+    size_t n = points.size();
+    std::vector<size_t> counts(2 * bytes * 256, 0); // Pass p counts byte p % bytes of y, then of x
+    for (const BasicPoint<T>& p : points) {
+        auto x = radix_key(p.x), y = radix_key(p.y);
+        for (unsigned b = 0; b < bytes; ++b) {
+            ++counts[b * 256 + ((y >> (8 * b)) & 0xff)];
+            ++counts[(bytes + b) * 256 + ((x >> (8 * b)) & 0xff)];
+        }
+    }
+
+    std::vector<BasicPoint<T>> scratch(n);
+    BasicPoint<T>* from = points.data();
+    BasicPoint<T>* to = scratch.data();
+    for (unsigned pass = 0; pass < 2 * bytes; ++pass) {
+        size_t* offsets = &counts[pass * 256];
+        bool by_y = pass < bytes;
+        unsigned shift = 8 * (pass % bytes);
+        if (offsets[(radix_key(by_y ? from[0].y : from[0].x) >> shift) & 0xff] == n) continue;
+
+        size_t offset = 0;
+        for (unsigned digit = 0; digit < 256; ++digit) {
+            size_t count = offsets[digit];
+            offsets[digit] = offset;
+            offset += count;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            auto key = radix_key(by_y ? from[i].y : from[i].x);
+            to[offsets[(key >> shift) & 0xff]++] = from[i];
+        }
+        std::swap(from, to);
+    }
+    if (from != points.data()) points.swap(scratch);
+}
+
+/**
+ * @brief Sorts floating-point points for the Monotone Chain.
  */
-static double cross(const Point& O, const Point& A, const Point& B) {
-    return (A.x - O.x) * (B.y - O.y) - (A.y - O.y) * (B.x - O.x);
+static void sort_points(std::vector<Point>& points) {
+    std::sort(points.begin(), points.end());
+}
+
+/**
+ * @brief Sorts integer points for the Monotone Chain, by radix above RADIX_SORT_THRESHOLD.
+ */
+template <typename T>
+static void sort_points(std::vector<BasicPoint<T>>& points) {
+    if (points.size() < RADIX_SORT_THRESHOLD) std::sort(points.begin(), points.end());
+    else radix_sort(points);
 }
 
 /**
  * @brief Computes the convex hull of a set of 2D points using the Monotone Chain algorithm.
  * 
- * @param points The input vector of points.
+ * @param points The input vector of points (Point, Point32 or Point64).
  * @return A vector of points representing the convex hull in counter-clockwise order.
  */
-std::vector<Point> compute_convex_hull(std::vector<Point> points) {
+template <typename P>
+static std::vector<P> monotone_chain(std::vector<P> points) {
     int n = points.size(), k = 0;
     if (n <= 1) return points;
 
-    std::sort(points.begin(), points.end());
-    std::vector<Point> hull(2 * n);
+    sort_points(points);
+    std::vector<P> hull(2 * n);
 
     for (int i = 0; i < n; ++i) {
         while (k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) <= 0) k--;
@@ -53,6 +118,282 @@ std::vector<Point> compute_convex_hull(std::vector<Point> points) {
     return hull;
 }
 
+std::vector<Point> compute_convex_hull(std::vector<Point> points) {
+    return monotone_chain(std::move(points));
+}
+
+std::vector<Point32> compute_convex_hull(std::vector<Point32> points) {
+    return monotone_chain(std::move(points));
+}
+
+std::vector<Point64> compute_convex_hull(std::vector<Point64> points) {
+    return monotone_chain(std::move(points));
+}
+
+/**
+ * @brief Finds the Akl-Toussaint octagon of a point set.
+ * 
+ * The octagon joins the extreme points in the x, y, x + y and x - y directions.
+ * It lies inside the convex hull, so no point strictly inside it can be a hull
+ * vertex.
+ * 
+ * @param points A non-empty indexable point range (size() and operator[]).
+ * @param octagon Receives the distinct extremes in counter-clockwise order.
+ * @return The number of octagon vertices; below 3 if it is degenerate.
+ */
+template <typename Points>
+static int find_octagon(const Points& points, Point octagon[8]) {
+    // Extremes in counter-clockwise order of direction: E, NE, N, NW, W, SW, S, SE
+    Point ext[8];
+    for (int k = 0; k < 8; ++k) ext[k] = points[0];
+    for (size_t i = 1, n = points.size(); i < n; ++i) {
+        Point p = points[i];
+        if (p.x > ext[0].x) ext[0] = p;
+        if (p.x + p.y > ext[1].x + ext[1].y) ext[1] = p;
+        if (p.y > ext[2].y) ext[2] = p;
+        if (p.y - p.x > ext[3].y - ext[3].x) ext[3] = p;
+        if (p.x < ext[4].x) ext[4] = p;
+        if (p.x + p.y < ext[5].x + ext[5].y) ext[5] = p;
+        if (p.y < ext[6].y) ext[6] = p;
+        if (p.x - p.y > ext[7].x - ext[7].y) ext[7] = p;
+    }
+
+    int m = 0;
+    for (int k = 0; k < 8; ++k) {
+        if (m > 0 && octagon[m - 1].x == ext[k].x && octagon[m - 1].y == ext[k].y) continue;
+        octagon[m++] = ext[k];
+    }
+    while (m > 1 && octagon[m - 1].x == octagon[0].x && octagon[m - 1].y == octagon[0].y) --m;
+    return m;
+}
+
+/**
+ * @brief Discards points strictly inside the Akl-Toussaint octagon.
+ * 
+ * Removing those points does not change the hull (see find_octagon()).
+ * 
+ * @param points The points to filter, in place. The relative order of survivors is kept.
+ */
+template <typename Container>
+static void discard_interior_points(Container& points) {
+    if (points.size() < PREFILTER_THRESHOLD) return;
+
+    Point octagon[8];
+    int m = find_octagon(points, octagon);
+    if (m < 3) return;
+
+    // Classify in SoA blocks so the orientation tests run on vector lanes
+    double x[SIMD_BLOCK], y[SIMD_BLOCK];
+    unsigned char inside[SIMD_BLOCK];
+    size_t n = points.size(), kept = 0;
+    for (size_t first = 0; first < n; first += SIMD_BLOCK) {
+        size_t len = std::min(SIMD_BLOCK, n - first);
+        for (size_t i = 0; i < len; ++i) {
+            x[i] = points[first + i].x;
+            y[i] = points[first + i].y;
+        }
+        classify_inside(x, y, len, octagon, m, inside);
+        for (size_t i = 0; i < len; ++i)
+            if (!inside[i]) points[kept++] = points[first + i];
+    }
+    points.resize(kept);
+}
+
+/**
+ * @brief Copies the points of read-only columns that may lie on the hull.
+ * 
+ * Applies the same octagon filter as discard_interior_points(), reading the
+ * columns in place: column data (stride 1) goes to classify_inside() without
+ * being gathered, so only the surviving candidates are ever copied.
+ * 
+ * Every coordinate is checked for NaN and infinity while its block is in
+ * cache: x - x is 0 for a finite x and NaN otherwise, so one running sum
+ * flags them without a branch or a separate pass.
+ * 
+ * @param points The input columns.
+ * @param prefilter false to copy every point.
+ * @param out Receives the candidates in input order.
+ * @return false if a coordinate is NaN or infinite.
+ */
+template <typename Container>
+static bool copy_hull_candidates(const PointColumns& points, bool prefilter, Container& out) {
+    size_t n = points.size();
+    Point octagon[8];
+    int m = 0;
+    double check = 0; // Stays 0 while every coordinate is finite
+    if (prefilter && n >= PREFILTER_THRESHOLD) m = find_octagon(points, octagon);
+    if (m < 3) {
+        for (size_t i = 0; i < n; ++i) {
+            Point p = points[i];
+            check += (p.x - p.x) + (p.y - p.y);
+            out.push_back(p);
+        }
+        return check == 0;
+    }
+
+    double x[SIMD_BLOCK], y[SIMD_BLOCK];
+    unsigned char inside[SIMD_BLOCK];
+    for (size_t first = 0; first < n; first += SIMD_BLOCK) {
+        size_t len = std::min(SIMD_BLOCK, n - first);
+        const double* bx = points.x + first;
+        const double* by = points.y + first;
+        if (points.stride != 1) { // Interleaved pairs: gather one SoA block
+            for (size_t i = 0; i < len; ++i) {
+                x[i] = points.x[(first + i) * points.stride];
+                y[i] = points.y[(first + i) * points.stride];
+            }
+            bx = x;
+            by = y;
+        }
+        for (size_t i = 0; i < len; ++i) check += (bx[i] - bx[i]) + (by[i] - by[i]);
+        classify_inside(bx, by, len, octagon, m, inside);
+        for (size_t i = 0; i < len; ++i)
+            if (!inside[i]) out.push_back(Point{bx[i], by[i]});
+    }
+    return check == 0;
+}
+
+/**
+ * @brief Builds one strictly convex monotone chain over a sorted range of points.
+ * 
+ * @param first Start of the sorted range.
+ * @param last End of the sorted range.
+ * @param side -1 for the lower chain, 1 for the upper chain (both left to right).
+ * @param chain Output vector receiving the chain vertices.
+ */
+static void build_chain(const Point* first, const Point* last, int side, std::vector<Point>& chain) {
+    chain.clear();
+    for (const Point* p = first; p != last; ++p) {
+        while (chain.size() >= 2 && side * cross(chain[chain.size() - 2], chain.back(), *p) >= 0)
+            chain.pop_back();
+        chain.push_back(*p);
+    }
+}
+
+/**
+ * @brief Sorts points lexicographically using several threads.
+ * 
+ * Each thread sorts one contiguous chunk, then neighbouring chunks are merged
+ * pairwise in parallel until a single sorted run remains.
+ * 
+ * @param points The points to sort.
+ * @param bounds Chunk boundaries: chunk i is [bounds[i], bounds[i + 1]).
+ */
+static void parallel_sort(std::vector<Point>& points, const std::vector<size_t>& bounds) {
+    size_t chunks = bounds.size() - 1;
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < chunks; ++i) {
+        workers.emplace_back([&points, &bounds, i]() {
+            std::sort(points.begin() + bounds[i], points.begin() + bounds[i + 1]);
+        });
+    }
+    for (auto& t : workers) t.join();
+
+    for (size_t width = 1; width < chunks; width *= 2) {
+        workers.clear();
+        for (size_t i = 0; i + width < chunks; i += 2 * width) {
+            size_t lo = bounds[i], mid = bounds[i + width], hi = bounds[std::min(i + 2 * width, chunks)];
+            workers.emplace_back([&points, lo, mid, hi]() {
+                std::inplace_merge(points.begin() + lo, points.begin() + mid, points.begin() + hi);
+            });
+        }
+        for (auto& t : workers) t.join();
+    }
+}
+
+/**
+ * @brief Computes the convex hull of a set of 2D points with the given options.
+ * 
+ * The hull of the whole set only uses vertices of the chunk hulls, so after a
+ * parallel sort every thread builds the chains of its own x-range and one final
+ * Monotone Chain pass over the concatenated chunk chains yields the full hull.
+ * 
+ * @param points The input vector of points.
+ * @param options Thread count and other settings.
+ * @return A vector of points representing the convex hull in counter-clockwise order.
+ */
+std::vector<Point> compute_convex_hull(std::vector<Point> points, const HullOptions& options) {
+    if (options.prefilter) discard_interior_points(points);
+
+    size_t n = points.size();
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    size_t threads = options.threads ? std::min<size_t>(options.threads, hardware) : hardware;
+    threads = std::min(threads, std::max<size_t>(1, n / PARALLEL_MIN_CHUNK)); // Never more threads than cores or chunks
+    if (threads <= 1 || n < PARALLEL_HULL_THRESHOLD) return compute_convex_hull(std::move(points));
+
+    std::vector<size_t> bounds(threads + 1);
+    for (size_t i = 0; i <= threads; ++i) bounds[i] = n * i / threads;
+    parallel_sort(points, bounds);
+
+    std::vector<std::vector<Point>> lower(threads), upper(threads);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([&, i]() {
+            build_chain(points.data() + bounds[i], points.data() + bounds[i + 1], -1, lower[i]);
+            build_chain(points.data() + bounds[i], points.data() + bounds[i + 1], 1, upper[i]);
+        });
+    }
+    for (auto& t : workers) t.join();
+
+    std::vector<Point> candidates, lower_chain, upper_chain;
+    for (const auto& c : lower) candidates.insert(candidates.end(), c.begin(), c.end());
+    build_chain(candidates.data(), candidates.data() + candidates.size(), -1, lower_chain);
+    candidates.clear();
+    for (const auto& c : upper) candidates.insert(candidates.end(), c.begin(), c.end());
+    build_chain(candidates.data(), candidates.data() + candidates.size(), 1, upper_chain);
+
+    std::vector<Point> hull(lower_chain);
+    if (upper_chain.size() > 2) hull.insert(hull.end(), upper_chain.rbegin() + 1, upper_chain.rend() - 1);
+    return hull;
+}
+
+bool compute_convex_hull(const PointColumns& points, const HullOptions& options, std::vector<Point>& hull) {
+    std::vector<Point> candidates;
+    if (!copy_hull_candidates(points, options.prefilter, candidates)) {
+        hull.clear();
+        return false;
+    }
+    HullOptions rest = options;
+    rest.prefilter = false; // Already filtered
+    hull = compute_convex_hull(std::move(candidates), rest);
+    return true;
+}
+
+StreamingHull::StreamingHull(size_t chunk_size, const HullOptions& options)
+    : options(options), chunk_size(std::max<size_t>(chunk_size, 1)), added(0) {}
+
+void StreamingHull::add(const Point& p) {
+    buffer.push_back(p);
+    ++added;
+    if (buffer.size() >= chunk_size) merge();
+}
+
+bool StreamingHull::add(const PointColumns& points) {
+    for (size_t i = 0; i < points.size(); ++i) {
+        Point p = points[i];
+        if (!std::isfinite(p.x) || !std::isfinite(p.y)) return false;
+        add(p);
+    }
+    return true;
+}
+
+const std::vector<Point>& StreamingHull::hull() {
+    merge();
+    return current;
+}
+
+unsigned long long StreamingHull::count() const {
+    return added;
+}
+
+void StreamingHull::merge() {
+    if (buffer.empty()) return;
+    buffer.insert(buffer.end(), current.begin(), current.end());
+    current = compute_convex_hull(std::move(buffer), options);
+    buffer.clear(); // Moved from
+    buffer.reserve(chunk_size + current.size());
+}
+
 /**
  * @brief Computes the area of a polygon given its vertices in order.
  * 
@@ -62,12 +403,42 @@ std::vector<Point> compute_convex_hull(std::vector<Point> points) {
  * @return The absolute area of the polygon.
  */
 double compute_area(const std::vector<Point>& polygon) {
+    size_t n = polygon.size();
+    if (n == 0) return 0;
+
+    // Gather the closed polygon into SoA blocks for the vectorized shoelace sum
+    double x[SIMD_BLOCK + 1], y[SIMD_BLOCK + 1];
     double area = 0;
-    int n = polygon.size();
-    for (int i = 0; i < n; ++i) {
-        const Point& p1 = polygon[i];
-        const Point& p2 = polygon[(i + 1) % n];
-        area += (p1.x * p2.y - p2.x * p1.y);
+    for (size_t first = 0; first < n; first += SIMD_BLOCK) {
+        size_t len = std::min(SIMD_BLOCK, n - first);
+        for (size_t i = 0; i <= len; ++i) {
+            const Point& p = polygon[(first + i) % n];
+            x[i] = p.x;
+            y[i] = p.y;
+        }
+        area += shoelace_sum(x, y, len);
     }
     return std::abs(area) / 2.0;
 }
+
+double compute_area(const std::vector<Point32>& polygon) {
+    size_t n = polygon.size();
+    __int128 twice_area = 0; // Each term fits in int64_t, the sum of up to 2^64 of them in __int128
+    for (size_t i = 0; i < n; ++i) {
+        const Point32& p = polygon[i];
+        const Point32& q = polygon[(i + 1) % n];
+        twice_area += int64_t(p.x) * q.y - int64_t(q.x) * p.y;
+    }
+    if (twice_area < 0) twice_area = -twice_area;
+    return static_cast<double>(twice_area) / 2.0;
+}
+
+double compute_area(const std::vector<Point64>& polygon) {
+    size_t n = polygon.size();
+    if (n < 3) return 0;
+
+    long double twice_area = 0;
+    for (size_t i = 1; i + 1 < n; ++i)
+        twice_area += static_cast<long double>(cross(polygon[0], polygon[i], polygon[i + 1]));
+    return static_cast<double>(std::abs(twice_area) / 2.0L);
+}
@@ -0,0 +1,165 @@
+#include "../include/SimdKernels.hpp"
+
+#if !defined(HULL_NO_SIMD) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_AVX2 1
+#include <immintrin.h>
+#elif !defined(HULL_NO_SIMD) && defined(__aarch64__)
+#define SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+/**
+ * @brief Signature of the inside-polygon kernels.
+ */
+typedef void (*ClassifyFn)(const double*, const double*, size_t, const Point*, int, unsigned char*);
+
+/**
+ * @brief Signature of the shoelace kernels: sums 4 * blocks terms into four lanes.
+ */
+typedef void (*ShoelaceFn)(const double*, const double*, size_t, double*);
+
+/**
+ * @brief Scalar inside-polygon test for points [first, n).
+ */
+static void classify_scalar(const double* x, const double* y, size_t first, size_t n, const Point* polygon,
+                            int m, unsigned char* inside) {
+    for (size_t i = first; i < n; ++i) {
+        unsigned char in = 1;
+        for (int k = 0; k < m && in; ++k) {
+            const Point& o = polygon[k];
+            const Point& a = polygon[(k + 1) % m];
+            if ((a.x - o.x) * (y[i] - o.y) - (a.y - o.y) * (x[i] - o.x) <= 0) in = 0;
+        }
+        inside[i] = in;
+    }
+}
+
+static void classify_inside_scalar(const double* x, const double* y, size_t n, const Point* polygon, int m,
+                                   unsigned char* inside) {
+    classify_scalar(x, y, 0, n, polygon, m, inside);
+}
+
+/**
+ * @brief Scalar shoelace terms, accumulated in the same four lanes as the vector kernels.
+ */
+static void shoelace_lanes_scalar(const double* x, const double* y, size_t blocks, double* lanes) {
+    for (size_t b = 0; b < blocks; ++b)
+        for (int l = 0; l < 4; ++l) {
+            size_t i = 4 * b + l;
+            lanes[l] += x[i] * y[i + 1] - x[i + 1] * y[i];
+        }
+}
+
+#ifdef SIMD_AVX2
+__attribute__((target("avx2")))
+static void classify_inside_avx2(const double* x, const double* y, size_t n, const Point* polygon, int m,
+                                 unsigned char* inside) {
+    const __m256d zero = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d px = _mm256_loadu_pd(x + i), py = _mm256_loadu_pd(y + i);
+        __m256d in = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+        for (int k = 0; k < m; ++k) {
+            const Point& o = polygon[k];
+            const Point& a = polygon[(k + 1) % m];
+            __m256d c = _mm256_sub_pd(_mm256_mul_pd(_mm256_set1_pd(a.x - o.x), _mm256_sub_pd(py, _mm256_set1_pd(o.y))),
+                                      _mm256_mul_pd(_mm256_set1_pd(a.y - o.y), _mm256_sub_pd(px, _mm256_set1_pd(o.x))));
+            in = _mm256_and_pd(in, _mm256_cmp_pd(c, zero, _CMP_GT_OQ));
+        }
+        int mask = _mm256_movemask_pd(in);
+        for (int l = 0; l < 4; ++l) inside[i + l] = (mask >> l) & 1;
+    }
+    classify_scalar(x, y, i, n, polygon, m, inside);
+}
+
+__attribute__((target("avx2")))
+static void shoelace_lanes_avx2(const double* x, const double* y, size_t blocks, double* lanes) {
+    __m256d acc = _mm256_loadu_pd(lanes);
+    for (size_t b = 0; b < blocks; ++b) {
+        const double* px = x + 4 * b;
+        const double* py = y + 4 * b;
+        __m256d t = _mm256_sub_pd(_mm256_mul_pd(_mm256_loadu_pd(px), _mm256_loadu_pd(py + 1)),
+                                  _mm256_mul_pd(_mm256_loadu_pd(px + 1), _mm256_loadu_pd(py)));
+        acc = _mm256_add_pd(acc, t);
+    }
+    _mm256_storeu_pd(lanes, acc);
+}
+#endif
+
+#ifdef SIMD_NEON
+static void classify_inside_neon(const double* x, const double* y, size_t n, const Point* polygon, int m,
+                                 unsigned char* inside) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t px = vld1q_f64(x + i), py = vld1q_f64(y + i);
+        uint64x2_t in = vdupq_n_u64(~0ULL);
+        for (int k = 0; k < m; ++k) {
+            const Point& o = polygon[k];
+            const Point& a = polygon[(k + 1) % m];
+            float64x2_t c = vsubq_f64(vmulq_f64(vdupq_n_f64(a.x - o.x), vsubq_f64(py, vdupq_n_f64(o.y))),
+                                      vmulq_f64(vdupq_n_f64(a.y - o.y), vsubq_f64(px, vdupq_n_f64(o.x))));
+            in = vandq_u64(in, vcgtq_f64(c, vdupq_n_f64(0)));
+        }
+        inside[i] = vgetq_lane_u64(in, 0) != 0;
+        inside[i + 1] = vgetq_lane_u64(in, 1) != 0;
+    }
+    classify_scalar(x, y, i, n, polygon, m, inside);
+}
+
+static void shoelace_lanes_neon(const double* x, const double* y, size_t blocks, double* lanes) {
+    float64x2_t lo = vld1q_f64(lanes), hi = vld1q_f64(lanes + 2);
+    for (size_t b = 0; b < blocks; ++b) {
+        const double* px = x + 4 * b;
+        const double* py = y + 4 * b;
+        lo = vaddq_f64(lo, vsubq_f64(vmulq_f64(vld1q_f64(px), vld1q_f64(py + 1)),
+                                     vmulq_f64(vld1q_f64(px + 1), vld1q_f64(py))));
+        hi = vaddq_f64(hi, vsubq_f64(vmulq_f64(vld1q_f64(px + 2), vld1q_f64(py + 3)),
+                                     vmulq_f64(vld1q_f64(px + 3), vld1q_f64(py + 2))));
+    }
+    vst1q_f64(lanes, lo);
+    vst1q_f64(lanes + 2, hi);
+}
+#endif
+
+/**
+ * @struct KernelSet
+ * @brief The kernels chosen for the running CPU.
+ */
+struct KernelSet {
+    const char* name;
+    ClassifyFn classify;
+    ShoelaceFn shoelace;
+};
+
+/**
+ * @brief Picks the fastest kernel set the CPU supports, once.
+ */
+static const KernelSet& kernels() {
+    static const KernelSet selected = []() -> KernelSet {
+#if defined(SIMD_AVX2)
+        if (__builtin_cpu_supports("avx2")) return KernelSet{"avx2", classify_inside_avx2, shoelace_lanes_avx2};
+#elif defined(SIMD_NEON)
+        return KernelSet{"neon", classify_inside_neon, shoelace_lanes_neon};
+#endif
+        return KernelSet{"scalar", classify_inside_scalar, shoelace_lanes_scalar};
+    }();
+    return selected;
+}
+
+void classify_inside(const double* x, const double* y, size_t n, const Point* polygon, int m,
+                     unsigned char* inside) {
+    kernels().classify(x, y, n, polygon, m, inside);
+}
+
+double shoelace_sum(const double* x, const double* y, size_t n) {
+    double lanes[4] = {0, 0, 0, 0};
+    size_t blocks = n / 4;
+    kernels().shoelace(x, y, blocks, lanes);
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (size_t i = 4 * blocks; i < n; ++i) sum += x[i] * y[i + 1] - x[i + 1] * y[i];
+    return sum;
+}
+
+const char* simd_kernel_name() {
+    return kernels().name;
+}
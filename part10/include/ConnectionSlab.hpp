@@ -0,0 +1,157 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <sys/resource.h>
+#include <vector>
+
+/**
+ * @file
+ * @brief Per-connection objects indexed by socket descriptor and recycled through per-thread arenas.
+ */
+
+#define CONNECTION_SLOTS_MAX (1 << 20) // Most descriptors a slab indexes, whatever RLIMIT_NOFILE allows
+#define CONNECTION_ARENA_BLOCK 64      // Objects an arena allocates at once when its free list runs dry
+
+/**
+ * @class ConnectionSlab
+ * @brief Maps socket descriptors to connection objects without a shared map or lock.
+ *
+ * The slot table is a flat array indexed by descriptor, sized once from
+ * RLIMIT_NOFILE, so lookups are a single atomic load and never rehash.
+ *
+ * Objects come from the arena of the thread that calls open() (the accepting
+ * thread) and go back to that same arena on close(), from whichever thread
+ * closes them: a lock-free stack takes the returns, and the owner moves them
+ * to its private free list the next time it runs dry. A closed object is
+ * handed out again as it was left, so buffers it owns keep their capacity
+ * and a new connection reuses them; callers reset what must not carry over
+ * before close(). After warm-up, open() and close() do not call the
+ * allocator. Arenas live as long as the process.
+ *
+ * open() and close() of one descriptor must not race; get() may run
+ * concurrently with both.
+ *
+ * @tparam T Default-constructible connection state.
+ */
+template <class T>
+class ConnectionSlab {
+public:
+    /**
+     * @brief Creates an empty slab for every descriptor the process may open.
+     */
+    ConnectionSlab() {
+        rlimit limit;
+        size_t slots = CONNECTION_SLOTS_MAX;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < slots)
+            slots = static_cast<size_t>(limit.rlim_cur);
+        table = std::vector<std::atomic<Slot*>>(slots);
+        for (std::atomic<Slot*>& entry : table) entry.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ConnectionSlab(const ConnectionSlab&) = delete;
+    ConnectionSlab& operator=(const ConnectionSlab&) = delete;
+
+    /**
+     * @brief Attaches an object from the calling thread's arena to a descriptor.
+     *
+     * @param fd The new connection's socket.
+     * @return The object, as the last connection that used it left it, or
+     *         nullptr if fd is beyond the slot table.
+     */
+    T* open(int fd) {
+        if (fd < 0 || static_cast<size_t>(fd) >= table.size()) return nullptr;
+        Slot* slot = local_arena().take();
+        table[fd].store(slot, std::memory_order_release);
+        return &slot->value;
+    }
+
+    /**
+     * @brief Looks up the object attached to a descriptor.
+     *
+     * @param fd A socket descriptor.
+     * @return The object, or nullptr if none is attached.
+     */
+    T* get(int fd) const {
+        if (fd < 0 || static_cast<size_t>(fd) >= table.size()) return nullptr;
+        Slot* slot = table[fd].load(std::memory_order_acquire);
+        return slot ? &slot->value : nullptr;
+    }
+
+    /**
+     * @brief Detaches a descriptor's object and returns it to the arena it came from.
+     *
+     * @param fd A socket descriptor; nothing happens if no object is attached.
+     */
+    void close(int fd) {
+        if (fd < 0 || static_cast<size_t>(fd) >= table.size()) return;
+        Slot* slot = table[fd].exchange(nullptr, std::memory_order_acq_rel);
+        if (slot) slot->owner->give_back(slot);
+    }
+
+private:
+    struct Arena;
+
+    /**
+     * @struct Slot
+     * @brief A connection object with the links the arenas keep it by.
+     */
+    struct Slot {
+        T value;
+        Arena* owner = nullptr; // Arena the slot was allocated from
+        Slot* next = nullptr;   // Next slot in a free list or the returned stack
+    };
+
+    /**
+     * @struct Arena
+     * @brief The slots one thread allocated, and those of them not in use.
+     */
+    struct Arena {
+        std::vector<std::unique_ptr<Slot[]>> blocks; // Every slot the arena allocated
+        Slot* free_list = nullptr;                   // Slots ready for take(), owner thread only
+        std::atomic<Slot*> returned{nullptr};        // Slots closed by any thread, pushed lock-free
+
+        /**
+         * @brief Pops a free slot, collecting returned ones or allocating a block if there is none.
+         */
+        Slot* take() {
+            if (!free_list) free_list = returned.exchange(nullptr, std::memory_order_acquire);
+            if (!free_list) {
+                blocks.emplace_back(new Slot[CONNECTION_ARENA_BLOCK]);
+                Slot* block = blocks.back().get();
+                for (size_t i = 0; i < CONNECTION_ARENA_BLOCK; ++i) {
+                    block[i].owner = this;
+                    block[i].next = i + 1 < CONNECTION_ARENA_BLOCK ? &block[i + 1] : nullptr;
+                }
+                free_list = block;
+            }
+            Slot* slot = free_list;
+            free_list = slot->next;
+            return slot;
+        }
+
+        /**
+         * @brief Pushes a closed slot for the owner to reuse; safe from any thread.
+         */
+        void give_back(Slot* slot) {
+            Slot* head = returned.load(std::memory_order_relaxed);
+            do {
+                slot->next = head;
+            } while (!returned.compare_exchange_weak(head, slot, std::memory_order_release, std::memory_order_relaxed));
+        }
+    };
+
+    /**
+     * @brief The calling thread's arena for this slab, created on its first open().
+     */
+    Arena& local_arena() {
+        thread_local std::vector<std::pair<const ConnectionSlab*, Arena*>> arenas; // Per slab, never freed
+        for (auto& entry : arenas)
+            if (entry.first == this) return *entry.second;
+        Arena* arena = new Arena;
+        arenas.emplace_back(this, arena);
+        return *arena;
+    }
+
+    std::vector<std::atomic<Slot*>> table; // Object attached to each descriptor, nullptr if none
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <iostream>
+
+/**
+ * @file
+ * @brief Compile-time log levels for the server's console output.
+ *
+ * Build with LOG_LEVEL set (e.g. `make LOG_LEVEL=2`) to choose how much is
+ * printed. Statements above the chosen level compile to nothing, so the
+ * per-line trace costs no stream formatting on the request path.
+ */
+
+#define LOG_LEVEL_QUIET 0 // Startup messages only
+#define LOG_LEVEL_INFO 1  // Connections and graph events (default)
+#define LOG_LEVEL_TRACE 2 // Every received buffer and processed line
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+/**
+ * @brief Prints a streamed message followed by a newline if level is enabled.
+ *
+ * @param level One of the LOG_LEVEL_* values.
+ * @param message Stream expression, e.g. "fd " << fd.
+ */
+#define LOG_AT(level, message) \
+    do { \
+        if ((level) <= LOG_LEVEL) std::cout << message << std::endl; \
+    } while (0)
+
+#define LOG_INFO(message) LOG_AT(LOG_LEVEL_INFO, message)
+#define LOG_TRACE(message) LOG_AT(LOG_LEVEL_TRACE, message)
@@ -0,0 +1,74 @@
+#ifndef POINT_QUEUE_HPP
+#define POINT_QUEUE_HPP
+
+#include "GeometryUtils.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * @class PointQueue
+ * @brief Bounded lock-free ring that many threads push points into and one thread drains.
+ *
+ * Producers claim a slot with a compare-and-swap on the tail and publish the
+ * point through the slot's sequence number, so push() never blocks. The
+ * consumer side is not thread-safe: callers serialize pop_until() themselves
+ * (the server does it under graph_mutex).
+ */
+class PointQueue {
+public:
+    /**
+     * @brief Creates an empty queue.
+     *
+     * @param capacity Number of slots, rounded up to a power of two.
+     */
+    explicit PointQueue(size_t capacity);
+
+    /**
+     * @brief Appends a point; safe to call from any number of threads.
+     *
+     * @param p The point to append.
+     * @return false if the queue is full.
+     */
+    bool push(const Point& p);
+
+    /**
+     * @brief Position after the last claimed slot, i.e. the total number of pushes so far.
+     */
+    size_t tail() const;
+
+    /**
+     * @brief Approximate number of queued points.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Moves every point pushed before position end into out, in push order.
+     *
+     * Waits for producers that claimed a slot before end but have not
+     * published their point yet. Only one thread may call this at a time.
+     *
+     * @param end A value previously returned by tail().
+     * @param out Receives the points (appended).
+     * @return The number of points moved.
+     */
+    size_t pop_until(size_t end, std::vector<Point>& out);
+
+private:
+    /**
+     * @struct Cell
+     * @brief One slot; sequence tells producers and the consumer whose turn it is.
+     */
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Point point;
+    };
+
+    std::unique_ptr<Cell[]> cells; // Ring storage
+    size_t mask;                   // Capacity - 1
+    alignas(64) std::atomic<size_t> tail_pos; // Next slot to claim (producers)
+    alignas(64) std::atomic<size_t> head_pos; // Next slot to read (written by the consumer only)
+};
+
+#endif // POINT_QUEUE_HPP
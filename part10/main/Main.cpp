@@ -1,287 +1,1259 @@
 #include "../include/GeometryUtils.hpp"
+#include "../include/CommandParser.hpp"
+#include "../include/InputBuffer.hpp"
+#include "../include/StateStore.hpp"
+#include "../include/Metrics.hpp"
+#include "../include/Log.hpp"
 #include "../include/Reactor.hpp"
 #include "../include/Proactor.hpp"
+#include "../include/PointQueue.hpp"
+#include "../include/ConnectionSlab.hpp"
 #include <iostream>
 #include <sstream>
 #include <string>
-#include <deque>
+#include <string_view>
 #include <unordered_map>
 #include <algorithm>
 #include <cctype>
 #include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <cstring>
+#include <cmath>
+#include <cstdio>
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <cstdint>
+#include <memory>
+#include <future>
+#include <vector>
 
 #define PORT 9034
 #define MAX_CLIENTS 10
+#define POINT_WIRE_SIZE 16 // NewgraphBin point: x then y as little-endian IEEE-754 doubles
+#define DEFAULT_GRAPH "default" // Graph of a client that has not sent Use
 
-// Mutex used to protect the condition variable during wait/signal operations
-pthread_mutex_t cond_mutex = PTHREAD_MUTEX_INITIALIZER;
-// Condition variable used to notify the monitoring thread about CH area changes
-pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
-// Flag indicating whether the CH area is currently at least 100 square units
-bool at_least_100 = false;
-// Thread that continuously monitors the CH area and prints messages accordingly
-pthread_t monitor_thread;
-// Flag to control the running state of the monitoring thread
-std::atomic<bool> monitor_running = true;
-
-
-// Shared graph data
-std::deque<Point> point_set;
-std::deque<Point> temp_points;
-bool waiting_for_graph = false;
-int points_to_read = 0;
-int newgraph_owner_fd = -1;
-std::mutex graph_mutex;
-
-// Per-client input buffer state
+#define SEND_LOCKS 64 // Stripes of send_locks
+#define DEFERRED_CH_MAX 1024 // Tagged CH requests queued on the proactor pool at once; more are answered in line
+#define OUTPUT_HIGH_WATERMARK (1 << 20)  // Unsent output bytes that park a client's input
+#define OUTPUT_LOW_WATERMARK (256 << 10) // Unsent output bytes below which its input resumes
+#define PUSH_QUEUE_MAX (4 << 20)         // Unsent output bytes beyond which an event disconnects the client instead
+
+#define INGEST_QUEUE_SIZE 65536 // Newpoint slots between two drains
+#define INGEST_BATCH 256        // Queued points that make a Newpoint try to drain
+
+/**
+ * @struct HullSnapshot
+ * @brief Immutable convex hull of one graph generation, shared by CH readers.
+ *
+ * Published RCU-style: readers load the current snapshot without taking the
+ * graph's mutex and writers only advance its generation. The first CH that
+ * finds an older snapshot copies the hull vertices under the lock, computes
+ * the area outside it and publishes the result; retired snapshots are freed
+ * when their last reader drops them.
+ */
+struct HullSnapshot {
+    uint64_t generation = 0;
+    size_t queued = 0;       // ingest_queue.tail() the snapshot includes
+    std::vector<Point> hull; // Hull vertices in counter-clockwise order
+    double area = 0;
+};
+
+/**
+ * @struct Subscription
+ * @brief A client waiting for its graph's hull area to cross a threshold (via Subscribe).
+ */
+struct Subscription {
+    int fd;              // The subscribed client
+    uint64_t connection; // Its ClientState::connection, so a reused fd is not taken for it
+    double threshold;    // Area the client watches
+    bool above;          // Side last reported: area >= threshold
+};
+
+/**
+ * @struct Graph
+ * @brief One named point set with its hull, its log and its Newpoint queue.
+ *
+ * mutex protects every member except the atomics and ingest_queue, so
+ * commands on different graphs never wait for each other.
+ */
+struct Graph {
+    PointCloud point_set;
+    std::mutex mutex;
+    // Convex hull of point_set, updated in place by every Newpoint/Removepoint
+    DynamicHull hull_engine;
+    // Incremented under mutex every time point_set changes
+    std::atomic<uint64_t> generation{0};
+    // Points accepted by Newpoint but not yet applied; drained under mutex
+    PointQueue ingest_queue{INGEST_QUEUE_SIZE};
+    // Drain buffer reused across batches
+    std::vector<Point> ingest_batch;
+    // Latest published snapshot, only accessed through std::atomic_load/std::atomic_store
+    std::shared_ptr<const HullSnapshot> hull_snapshot = std::make_shared<HullSnapshot>();
+    // Protects the hull_flight members
+    std::mutex hull_flight_mutex;
+    // Snapshot being computed, shared by the CH requests that need the same state meanwhile
+    std::shared_future<std::shared_ptr<const HullSnapshot>> hull_flight;
+    // generation and ingest_queue.tail() hull_flight was started for
+    uint64_t hull_flight_generation = 0;
+    size_t hull_flight_queued = 0;
+    // Snapshot and change log of point_set, idle unless --state is given
+    StateStore state_store;
+    // Protects the members below
+    std::mutex subscriptions_mutex;
+    // Clients told when the area crosses their threshold
+    std::vector<Subscription> subscriptions;
+    // Generation and area the subscribers were last checked against
+    uint64_t notified_generation = 0;
+    double notified_area = 0;
+};
+
+// Per-client input buffer state, recycled across connections by ConnectionSlab
 struct ClientState {
-    std::string inbuf;
+    int fd = -1;             // The client's socket
+    uint64_t connection = 0; // Serial of the connection, 0 once released; written under the fd's send lock
+    InputBuffer input;      // Received bytes not consumed yet
+    std::string outbuf;     // Responses of the current read, handed to send_output() at once
+    // Guarded by the fd's send lock, like connection
+    std::string pending;         // Output the socket did not take yet, flushed when it becomes writable
+    bool watching_write = false; // The listener reactor watches the socket for writability
+    bool paused = false;         // Input parked in the proactor pool until pending drains
+    Graph* graph = nullptr; // Graph the client's commands apply to, DEFAULT_GRAPH until Use
+    // Pending Newgraph, staged here so the graph stays usable until the last point arrives
+    PointCloud temp_points;            // Points received so far
+    int points_to_read = 0;            // Points still expected, 0 when no Newgraph is pending
+    bool binary_graph = false;         // True while the client sends a NewgraphBin payload
+    bool binary_graph_invalid = false; // Set if that payload held a coordinate PointCloud cannot store
+    std::string upload_id;             // Request ID of a NewgraphBin, echoed with its final answer
+    Graph* changed_graph = nullptr;    // Graph changed by the current read, whose subscribers are told after it
+    Graph* subscribed_graph = nullptr; // Graph of the client's Subscribe, nullptr if none
 };
 
-// Map of file descriptors to client states
-std::unordered_map<int, ClientState> clients;
+// Scratch for hull walks, one per worker thread
+thread_local HullWorkspace hull_workspace;
+// Points of the Newpoints/Removepoints being run, one buffer per thread
+thread_local std::vector<Point> command_points;
+// Client states by socket descriptor, allocated from the accepting thread's arena
+ConnectionSlab<ClientState> clients;
+// Protects graphs
+std::mutex graphs_mutex;
+// Graphs by name, created by their first Use
+std::unordered_map<std::string, std::unique_ptr<Graph>> graphs;
+// DEFAULT_GRAPH, opened before the first client is accepted
+Graph* default_graph = nullptr;
+// --state directory, empty if graphs are not persisted
+std::string state_root;
+// Proactor pool whose workers serve the client sockets
+void* proactor_pool = nullptr;
+// io_uring proactor serving the listener and the clients instead, nullptr if unused
+void* uring_proactor = nullptr;
+// Reactor accepting the pool's clients, which also flushes the sockets with pending output; nullptr with --uring
+void* listener_reactor = nullptr;
+// Guard each pool client's pending output, appended by its worker and by pushes, and flushed by listener_reactor
+std::mutex send_locks[SEND_LOCKS];
+// Serial of the last connection opened
+std::atomic<uint64_t> last_connection{0};
+// Tagged CH requests posted to proactor_pool and not answered yet
+std::atomic<int> deferred_ch{0};
 
 /**
- * @brief Trims trailing newline and carriage return characters, and leading spaces.
- * @param s The input string to trim.
+ * @brief Starts a background snapshot once enough changes were logged since the last one.
+ *
+ * Must be called with the graph's mutex held.
+ * @param graph The graph that changed.
  */
-void trim_crlf(std::string &s) {
-    while (!s.empty() && (s.back() == '\n' || s.back() == '\r')) s.pop_back();
-    while (!s.empty() && std::isspace((unsigned char)s.front())) s.erase(s.begin());
+void snapshot_if_due(Graph& graph) {
+    if (graph.state_store.snapshot_due()) graph.state_store.snapshot(graph.point_set, graph.hull_engine.vertices(hull_workspace));
 }
 
 /**
- * @brief Checks if the given string represents a valid number.
- * @param s The string to check.
- * @return True if the string is a number, false otherwise.
+ * @brief Applies every Newpoint queued before position end to point_set and the hull.
+ *
+ * Must be called with the graph's mutex held, which makes the caller the queue's only consumer.
+ * @param graph The graph to update.
+ * @param end A value of ingest_queue.tail().
  */
-bool is_number(const std::string& s) {
-    std::istringstream iss(s);
-    double d;
-    return (iss >> d) && iss.eof();
+void apply_queued_points(Graph& graph, size_t end) {
+    if (graph.ingest_queue.pop_until(end, graph.ingest_batch) == 0) return;
+    for (const Point& p : graph.ingest_batch) graph.point_set.push_back(p);
+    graph.hull_engine.insert_batch(graph.ingest_batch);
+    graph.state_store.log_inserts(graph.ingest_batch); // One write() for the whole batch
+    graph.ingest_batch.clear();
+    ++graph.generation;
+    snapshot_if_due(graph);
 }
 
 /**
- * @brief Handles a line containing a point during the construction of a new graph.
- * @param line The line containing the point coordinates.
- * @return Response message indicating success or error.
+ * @brief Replaces a graph with the points a client staged for it.
+ *
+ * The hull of the new points is built before the graph's mutex is taken, so
+ * other clients of the graph only wait for the swap, and the replaced points
+ * and hull are freed after the mutex is released.
+ *
+ * @param graph The graph being replaced.
+ * @param state The client that sent the points; its staging buffer is emptied.
  */
-std::string handle_point_line(const std::string& line) {
-    std::lock_guard<std::mutex> lock(graph_mutex);
-    size_t comma = line.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid point format.";
-    std::string x_str = line.substr(0, comma);
-    std::string y_str = line.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid point values.";
-    Point p{std::stod(x_str), std::stod(y_str)};
-    temp_points.push_back(p);
-    points_to_read--;
-    if (points_to_read == 0) {
-        point_set = temp_points;
-        temp_points.clear();
-        waiting_for_graph = false;
-        newgraph_owner_fd = -1;
-        return "GRAPH_LOADED";
+void install_new_graph(Graph& graph, ClientState& state) {
+    DynamicHull hull;
+    uint64_t start = metrics_clock();
+    hull.assign(state.temp_points);
+    metrics_record(Latency::HullBuild, start);
+    {
+        TimedLock lock(graph.mutex);
+        apply_queued_points(graph, graph.ingest_queue.tail()); // Earlier Newpoints belong to the replaced graph
+        graph.point_set.swap(state.temp_points);
+        graph.hull_engine.swap(hull);
+        ++graph.generation;
+        graph.state_store.snapshot(graph.point_set, graph.hull_engine.vertices(hull_workspace)); // The old log no longer applies
     }
-    return "OK";
+    PointCloud().swap(state.temp_points); // Releases the replaced points instead of keeping them per client
+    state.changed_graph = &graph;
+}
+
+/**
+ * @brief Stages a point line received during a client's Newgraph.
+ *
+ * Only touches the client's own state; the graph is locked once, when the
+ * last point arrives.
+ *
+ * @param state The uploading client.
+ * @param line Input in the form "x,y".
+ * @return "OK", "GRAPH_LOADED", or an error message.
+ */
+std::string handle_point_line(ClientState& state, std::string_view line) {
+    Point p;
+    ParseStatus status = parse_point(line, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid point format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid point values.";
+
+    state.temp_points.push_back(p);
+    if (--state.points_to_read > 0) return "OK";
+    install_new_graph(*state.graph, state);
+    return "GRAPH_LOADED";
+}
+
+/**
+ * @brief Decodes a little-endian IEEE-754 double, whatever the host byte order.
+ *
+ * @param bytes Eight bytes, least significant first.
+ * @return The decoded value.
+ */
+double read_le_double(const char* bytes) {
+    uint64_t bits = 0;
+    for (int i = 7; i >= 0; --i) bits = (bits << 8) | static_cast<unsigned char>(bytes[i]);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Prefixes a response with the request ID of the command it answers.
+ *
+ * @param id The ID without '#', empty for an untagged command.
+ * @param response The response; an empty one (no answer) stays empty.
+ * @return "#ID response", or response itself when there is nothing to tag.
+ */
+std::string tag_response(std::string_view id, std::string response) {
+    if (id.empty() || response.empty()) return response;
+    std::string tagged;
+    tagged.reserve(id.size() + 2 + response.size());
+    tagged += '#';
+    tagged.append(id.data(), id.size());
+    tagged += ' ';
+    tagged += response;
+    return tagged;
+}
+
+/**
+ * @brief Moves the NewgraphBin points buffered so far straight into the client's staging buffer.
+ *
+ * Consumes whole points from the front of the client's unread input without
+ * any text parsing. A trailing partial point stays buffered for the next read.
+ *
+ * @param state The uploading client; consumed points are removed from its input.
+ * @return "GRAPH_LOADED" or an error once the payload is complete, "" while points are missing.
+ */
+std::string handle_binary_points(ClientState& state) {
+    InputBuffer& input = state.input;
+    std::string_view unread = input.unread();
+    size_t count = std::min(unread.size() / POINT_WIRE_SIZE, static_cast<size_t>(state.points_to_read));
+    const char* data = unread.data();
+    for (size_t i = 0; i < count; ++i, data += POINT_WIRE_SIZE) {
+        Point p{read_le_double(data), read_le_double(data + 8)};
+        if (!coord_fits(p.x) || !coord_fits(p.y)) state.binary_graph_invalid = true;
+        else state.temp_points.push_back(p);
+    }
+    input.consume(count * POINT_WIRE_SIZE);
+    state.points_to_read -= static_cast<int>(count);
+    if (state.points_to_read > 0) return "";
+
+    state.binary_graph = false;
+    if (state.binary_graph_invalid) {
+        PointCloud().swap(state.temp_points);
+        return tag_response(state.upload_id, "ERROR: Invalid point values.");
+    }
+    install_new_graph(*state.graph, state);
+    return tag_response(state.upload_id, "GRAPH_LOADED");
 }
 
 /**
  * @brief Adds a new point to the shared point set.
+ *
+ * The point goes through ingest_queue without taking the graph's mutex; once a
+ * batch has piled up, whichever Newpoint finds the lock free applies it.
+ * Removepoint, Newgraph and CH drain the queue first, so every command sees
+ * the points acknowledged before it. With a state directory the point skips
+ * the queue and is logged under the mutex, so OK is only sent once the point
+ * is in the change log.
+ * @param graph The client's graph.
  * @param args A string with comma-separated x,y coordinates.
  * @return Response message indicating success or error.
  */
-std::string handle_newpoint(const std::string& args) {
-    std::lock_guard<std::mutex> lock(graph_mutex);
-    size_t comma = args.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid format.";
-    std::string x_str = args.substr(0, comma);
-    std::string y_str = args.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid values.";
-    Point p{std::stod(x_str), std::stod(y_str)};
-    point_set.push_back(p);
+std::string handle_newpoint(Graph& graph, std::string_view args) {
+    Point p;
+    ParseStatus status = parse_point(args, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+
+    // is_open() is fixed when the graph is created, so it is safe to read unlocked
+    if (graph.state_store.is_open() || !graph.ingest_queue.push(p)) {
+        // Persistent, or queue full: drain it and apply this point directly
+        TimedLock lock(graph.mutex);
+        apply_queued_points(graph, graph.ingest_queue.tail());
+        graph.point_set.push_back(p);
+        graph.hull_engine.insert(p);
+        ++graph.generation;
+        graph.state_store.log_insert(p);
+        snapshot_if_due(graph);
+        return "OK";
+    }
+    if (graph.ingest_queue.size() >= INGEST_BATCH) {
+        std::unique_lock<std::mutex> lock(graph.mutex, std::try_to_lock);
+        if (lock) apply_queued_points(graph, graph.ingest_queue.tail());
+    }
     return "OK";
 }
 
 /**
  * @brief Removes a point from the shared point set.
+ * @param graph The client's graph.
  * @param args A string with comma-separated x,y coordinates.
  * @return Response message indicating success or error.
  */
-std::string handle_removepoint(const std::string& args) {
-    std::lock_guard<std::mutex> lock(graph_mutex);
-    size_t comma = args.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid format.";
-    std::string x_str = args.substr(0, comma);
-    std::string y_str = args.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid values.";
-    Point p{std::stod(x_str), std::stod(y_str)};
-    auto it = std::remove_if(point_set.begin(), point_set.end(),
-                             [&](const Point& q) { return q.x == p.x && q.y == p.y; });
-    if (it != point_set.end()) point_set.erase(it, point_set.end());
+std::string handle_removepoint(Graph& graph, std::string_view args) {
+    TimedLock lock(graph.mutex);
+    Point p;
+    ParseStatus status = parse_point(args, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    apply_queued_points(graph, graph.ingest_queue.tail());
+    if (graph.point_set.remove_all(p) > 0) {
+        graph.hull_engine.erase(p);
+        ++graph.generation;
+        graph.state_store.log_remove(p);
+        snapshot_if_due(graph);
+    }
+    return "OK";
+}
+
+/**
+ * @brief Parses the "k x1,y1;...;xk,yk" arguments of Newpoints and Removepoints.
+ *
+ * @param args Arguments after the command.
+ * @param points Receives the k points.
+ * @return An empty string on success, else the error message.
+ */
+std::string parse_point_batch(std::string_view args, std::vector<Point>& points) {
+    int n;
+    if (!parse_count(args, n) || n <= 0) return "ERROR: Invalid number.";
+    size_t space = args.find_first_of(" \t");
+    ParseStatus status = parse_point_list(space == std::string_view::npos ? std::string_view() : args.substr(space + 1), points);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    if (points.size() != static_cast<size_t>(n)) return "ERROR: Point count mismatch.";
+    return "";
+}
+
+/**
+ * @brief Adds a batch of points to the graph (via Newpoints).
+ *
+ * Either every point is added or, if any of them is invalid, none. The
+ * points are parsed before the graph's mutex is taken, which is then held once
+ * for the whole batch. The hull takes the batch in one insert_batch() call and
+ * the log in one write().
+ *
+ * @param graph The client's graph.
+ * @param args Arguments after the command (k x1,y1;...;xk,yk).
+ * @return Response message.
+ */
+std::string handle_newpoints(Graph& graph, std::string_view args) {
+    std::string error = parse_point_batch(args, command_points);
+    if (!error.empty()) return error;
+    TimedLock lock(graph.mutex);
+    apply_queued_points(graph, graph.ingest_queue.tail());
+    for (const Point& p : command_points) graph.point_set.push_back(p);
+    graph.hull_engine.insert_batch(command_points);
+    ++graph.generation;
+    graph.state_store.log_inserts(command_points);
+    snapshot_if_due(graph);
+    return "OK";
+}
+
+/**
+ * @brief Removes every copy of each point of a batch from the graph (via Removepoints).
+ *
+ * Validated and applied like Newpoints; points not in the graph are ignored.
+ *
+ * @param graph The client's graph.
+ * @param args Arguments after the command (k x1,y1;...;xk,yk).
+ * @return Response message.
+ */
+std::string handle_removepoints(Graph& graph, std::string_view args) {
+    std::string error = parse_point_batch(args, command_points);
+    if (!error.empty()) return error;
+    TimedLock lock(graph.mutex);
+    apply_queued_points(graph, graph.ingest_queue.tail());
+    // Keep only the points that were present, which are the ones the hull and the log need
+    size_t removed = 0;
+    for (const Point& p : command_points) {
+        if (graph.point_set.remove_all(p) > 0) command_points[removed++] = p;
+    }
+    command_points.resize(removed);
+    if (removed > 0) {
+        graph.hull_engine.erase_batch(command_points);
+        ++graph.generation;
+        graph.state_store.log_removes(command_points);
+        snapshot_if_due(graph);
+    }
     return "OK";
 }
 
 /**
- * @brief Computes the convex hull and its area, and returns the area.
+ * @brief Returns the hull snapshot of the current graph generation.
+ *
+ * Lock-free while the graph is unchanged and no Newpoint is queued; otherwise
+ * holds the graph's mutex to apply the queued points and copy the O(h) hull vertices.
+ *
+ * Single flight: requests that find the same stale state while a snapshot of
+ * it is being computed wait for that computation and share its result, so a
+ * burst of CH requests and subscriber checks after a write builds one snapshot.
+ *
+ * @param graph The graph to read.
+ * @return The snapshot, valid for as long as the caller keeps it.
+ */
+std::shared_ptr<const HullSnapshot> current_hull_snapshot(Graph& graph) {
+    std::shared_ptr<const HullSnapshot> snapshot = std::atomic_load(&graph.hull_snapshot);
+    uint64_t generation = graph.generation;
+    size_t queued = graph.ingest_queue.tail();
+    if (snapshot->generation == generation && snapshot->queued == queued) return snapshot;
+
+    // Join the computation of this state if one is running, otherwise lead one
+    std::promise<std::shared_ptr<const HullSnapshot>> result;
+    std::shared_future<std::shared_ptr<const HullSnapshot>> flight;
+    {
+        std::lock_guard<std::mutex> lock(graph.hull_flight_mutex);
+        if (graph.hull_flight.valid() && graph.hull_flight_generation == generation &&
+            graph.hull_flight_queued == queued) {
+            flight = graph.hull_flight;
+        } else {
+            graph.hull_flight = result.get_future().share();
+            graph.hull_flight_generation = generation;
+            graph.hull_flight_queued = queued;
+        }
+    }
+    if (flight.valid()) {
+        metrics_count(Counter::HullJoins);
+        return flight.get(); // The leader read the state after this request saw it, so it is at least as new
+    }
+
+    std::shared_ptr<HullSnapshot> fresh = std::make_shared<HullSnapshot>();
+    uint64_t start;
+    {
+        TimedLock lock(graph.mutex);
+        start = metrics_clock();
+        fresh->queued = graph.ingest_queue.tail();
+        apply_queued_points(graph, fresh->queued);
+        fresh->generation = graph.generation;
+        fresh->hull = graph.hull_engine.vertices(hull_workspace);
+    }
+    fresh->area = compute_area(fresh->hull);
+    metrics_record(Latency::HullRead, start);
+
+    // Publish unless a concurrent CH already published a newer generation
+    std::shared_ptr<const HullSnapshot> published = fresh;
+    while (snapshot->generation < fresh->generation &&
+           !std::atomic_compare_exchange_weak(&graph.hull_snapshot, &snapshot, published)) {
+    }
+    result.set_value(fresh);
+    std::lock_guard<std::mutex> lock(graph.hull_flight_mutex);
+    if (graph.hull_flight_generation == generation && graph.hull_flight_queued == queued)
+        graph.hull_flight = {}; // Still ours: later requests read the published snapshot instead
+    return fresh;
+}
+
+/**
+ * @brief Tells whether the published hull snapshot already reflects every change to a graph.
+ * @param graph The graph to check.
+ * @return true if a CH would be answered from the snapshot without computing anything.
+ */
+bool hull_snapshot_current(Graph& graph) {
+    std::shared_ptr<const HullSnapshot> snapshot = std::atomic_load(&graph.hull_snapshot);
+    return snapshot->generation == graph.generation && snapshot->queued == graph.ingest_queue.tail();
+}
+
+/**
+ * @brief Returns the convex hull area of the current graph snapshot.
+ * @param graph The client's graph.
  * @return The area of the convex hull as a string.
  */
-std::string handle_ch() {
-    std::lock_guard<std::mutex> lock(graph_mutex);
-    auto hull = compute_convex_hull_deque(point_set);
-    double area = compute_area(hull);
+std::string handle_ch(Graph& graph) {
+    double area = current_hull_snapshot(graph)->area;
+    char text[32];
+    int len = std::snprintf(text, sizeof(text), "%g", area); // Same text as operator<<, without a stream
+    return std::string(text, static_cast<size_t>(len));
+}
 
-    pthread_cond_signal(&cond);
+/**
+ * @brief Answers the queries computed from the hull alone.
+ *
+ * Reads the published hull snapshot like CH, so the graph's mutex is only taken
+ * when the graph changed since the last query, and then just for the O(h) copy.
+ * - CHPoints: "h x1,y1;...;xh,yh", the vertices counter-clockwise.
+ * - Perimeter, Diameter: a number.
+ * - Contains x,y: "YES" if the point is inside or on the hull, else "NO", in O(log h).
+ * - MinBoundingRect: "area x1,y1;...;x4,y4", the corners counter-clockwise, or
+ *   "0" for an empty graph.
+ *
+ * @param graph The client's graph.
+ * @param command CHPoints, Perimeter, Contains, Diameter or MinBoundingRect.
+ * @param args Arguments after the command (x,y for Contains).
+ * @return Response message.
+ */
+std::string handle_hull_query(Graph& graph, CommandType command, std::string_view args) {
+    Point p{0, 0};
+    if (command == CommandType::Contains) {
+        ParseStatus status = parse_point(args, p);
+        if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+        if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    }
+    std::shared_ptr<const HullSnapshot> snapshot = current_hull_snapshot(graph);
+    const std::vector<Point>& hull = snapshot->hull;
 
     std::ostringstream oss;
-    oss << area;
-    return oss.str();
+    switch (command) {
+    case CommandType::CHPoints: {
+        std::string response = std::to_string(hull.size());
+        if (!hull.empty()) response += ' ';
+        format_point_list(hull.data(), hull.size(), response);
+        return response;
+    }
+    case CommandType::Perimeter:
+        oss << compute_perimeter(hull);
+        return oss.str();
+    case CommandType::Contains:
+        return hull_contains(hull, p) ? "YES" : "NO";
+    case CommandType::Diameter:
+        oss << hull_diameter(hull);
+        return oss.str();
+    default: {
+        if (hull.empty()) return "0";
+        BoundingRect rect = min_bounding_rect(hull);
+        oss << rect.area << ' ';
+        std::string response = oss.str();
+        format_point_list(rect.corners, 4, response);
+        return response;
+    }
+    }
+}
+
+/**
+ * @brief Handles the Snapshot command: writes the graph to the state directory now.
+ *
+ * Newpoints still queued are applied first, so the snapshot holds every acknowledged point.
+ * @param graph The client's graph.
+ * @return "OK" once the background write has started, or an error message.
+ */
+std::string handle_snapshot(Graph& graph) {
+    TimedLock lock(graph.mutex);
+    if (!graph.state_store.is_open()) return "ERROR: No state directory.";
+    apply_queued_points(graph, graph.ingest_queue.tail());
+    if (!graph.state_store.snapshot(graph.point_set, graph.hull_engine.vertices(hull_workspace))) return "ERROR: Snapshot failed.";
+    return "OK";
+}
+
+/**
+ * @brief Returns the graph with the given name, creating it on first use.
+ *
+ * With a state directory a new graph is restored from its own directory
+ * (the state directory itself for DEFAULT_GRAPH, graph.NAME inside it for
+ * the others). A snapshot without later changes also holds the hull, which
+ * is published right away so the first CH does not have to walk the rebuilt
+ * tree.
+ *
+ * @param name A name accepted by valid_graph_name().
+ * @param error Receives a message if the graph cannot be restored.
+ * @return The graph, or nullptr on failure. Graphs are never freed.
+ */
+Graph* open_graph(const std::string& name, std::string& error) {
+    std::lock_guard<std::mutex> lock(graphs_mutex);
+    auto it = graphs.find(name);
+    if (it != graphs.end()) return it->second.get();
+
+    std::unique_ptr<Graph> graph(new Graph);
+    if (!state_root.empty()) {
+        std::string dir = name == DEFAULT_GRAPH ? state_root : state_root + "/graph." + name;
+        std::vector<Point> saved_hull;
+        if (!graph->state_store.open(dir, graph->point_set, saved_hull, error)) return nullptr;
+        uint64_t start = metrics_clock();
+        graph->hull_engine.assign(graph->point_set);
+        metrics_record(Latency::HullBuild, start);
+        ++graph->generation;
+        if (!saved_hull.empty()) {
+            std::shared_ptr<HullSnapshot> restored = std::make_shared<HullSnapshot>();
+            restored->generation = graph->generation;
+            restored->queued = graph->ingest_queue.tail();
+            restored->area = compute_area(saved_hull);
+            restored->hull = std::move(saved_hull);
+            graph->hull_snapshot = restored; // Not shared with any reader yet
+        }
+        if (!graph->point_set.empty())
+            std::cout << "Restored " << graph->point_set.size() << " point(s) of " << name << " from " << dir << std::endl;
+    }
+    return graphs.emplace(name, std::move(graph)).first->second.get();
+}
+
+/**
+ * @brief Sends as much of a pool client's pending output as its socket takes without blocking.
+ *
+ * Must be called with the fd's send lock held.
+ * @param fd The client's non-blocking socket.
+ * @param state The client's state; sent bytes are removed from its pending output.
+ * @return false if the connection broke.
+ */
+bool flush_output(int fd, ClientState& state) {
+    size_t sent = 0;
+    while (sent < state.pending.size()) {
+        ssize_t n = send(fd, state.pending.data() + sent, state.pending.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) return false;
+            break; // Socket buffer full; the rest goes out when it becomes writable
+        }
+    }
+    state.pending.erase(0, sent); // Keeps its capacity for the next output
+    return true;
+}
+
+void flush_client(int fd);
+
+/**
+ * @brief Watches a pool client's socket for writability while it has pending output.
+ *
+ * Also resumes the client's input once a backlog that parked it drained below
+ * OUTPUT_LOW_WATERMARK. Must be called with the fd's send lock held.
+ * @param fd The client's socket.
+ * @param state The client's state.
+ */
+void update_write_interest(int fd, ClientState& state) {
+    bool want = !state.pending.empty();
+    if (want != state.watching_write) {
+        if (want) addFdToReactor(listener_reactor, fd, flush_client, REACTOR_WRITE);
+        else removeFdFromReactor(listener_reactor, fd);
+        state.watching_write = want;
+    }
+    if (state.paused && state.pending.size() <= OUTPUT_LOW_WATERMARK) {
+        state.paused = false;
+        resumeProactorPoolSocket(proactor_pool, fd);
+    }
+}
+
+/**
+ * @brief Appends output behind a pool client's pending output and sends what its socket takes.
+ *
+ * Never blocks. A connection that broke is shut down, so its worker sees the
+ * end of the stream and releases it. Must be called with the fd's send lock held.
+ * @param fd The client's non-blocking socket.
+ * @param state The client's state.
+ * @param data The output.
+ */
+void send_output(int fd, ClientState& state, std::string_view data) {
+    if (!data.empty()) state.pending.append(data.data(), data.size());
+    if (!flush_output(fd, state)) {
+        LOG_INFO("Client " << fd << " stopped accepting data. Closing fd.");
+        state.pending.clear();
+        shutdown(fd, SHUT_RDWR);
+    }
+    update_write_interest(fd, state);
+}
+
+/**
+ * @brief Listener reactor callback: flushes a pool client's pending output once its socket is writable.
+ * @param fd The client's socket.
+ */
+void flush_client(int fd) {
+    std::lock_guard<std::mutex> lock(send_locks[fd % SEND_LOCKS]);
+    ClientState* state = clients.get(fd);
+    if (!state || !state->watching_write) return; // Released since the socket became writable
+    send_output(fd, *state, std::string_view()); // Nothing new, just flush
 }
 
 /**
- * @brief Processes a complete command line from a client.
+ * @brief Sends a line to a client outside of its request/response flow: an event or a deferred answer.
+ *
+ * Nothing is sent if the connection was released since the line was due. The
+ * line is queued behind the client's pending output and never blocks the
+ * caller, which may be notifying every subscriber. A deferred answer is always
+ * queued, since the client asked for it; an event that would leave more than
+ * PUSH_QUEUE_MAX bytes unsent disconnects the client instead, as it has
+ * stopped reading. With --uring this must run on the proactor thread, as every
+ * callback and posted task does; with the pool it takes the socket's send lock.
  * @param fd The client's socket file descriptor.
- * @param rawline The raw input line from the client.
+ * @param connection The client's ClientState::connection when the line became due.
+ * @param line The line, ending in '\n'.
+ * @param event true for an event, false for a deferred answer.
+ */
+void push_line(int fd, uint64_t connection, const std::string& line, bool event) {
+    if (uring_proactor) {
+        ClientState* state = clients.get(fd);
+        if (!state || state->connection != connection) return;
+        if (event && proactorPending(uring_proactor, fd) + line.size() > PUSH_QUEUE_MAX) {
+            LOG_INFO("Client " << fd << " is not reading what is pushed to it. Disconnecting it.");
+            shutdown(fd, SHUT_RDWR); // Ends its receive, so the proactor closes it
+            return;
+        }
+        proactorSend(uring_proactor, fd, line.data(), line.size());
+        return;
+    }
+    std::lock_guard<std::mutex> lock(send_locks[fd % SEND_LOCKS]);
+    ClientState* state = clients.get(fd);
+    if (!state || state->connection != connection) return; // Gone, and the fd may belong to someone else now
+    if (event && state->pending.size() + line.size() > PUSH_QUEUE_MAX) {
+        LOG_INFO("Client " << fd << " is not reading what is pushed to it. Disconnecting it.");
+        shutdown(fd, SHUT_RDWR); // Its worker sees the end of the stream and releases it
+        return;
+    }
+    send_output(fd, *state, line);
+}
+
+/**
+ * @brief Pushes "EVENT ABOVE area" or "EVENT BELOW area" to the subscribers whose threshold the area crossed.
+ *
+ * The area comes from the graph's hull snapshot, which CH readers share, and
+ * each event line is formatted once for all subscribers. Does nothing for a
+ * graph without subscribers.
+ * @param graph A graph that changed.
+ */
+void notify_subscribers(Graph& graph) {
+    {
+        std::lock_guard<std::mutex> lock(graph.subscriptions_mutex);
+        if (graph.subscriptions.empty()) return;
+    }
+    std::shared_ptr<const HullSnapshot> snapshot = current_hull_snapshot(graph);
+
+    std::string above, below;
+    std::vector<Subscription> crossed; // Copied so the events are sent without the mutex
+    {
+        std::lock_guard<std::mutex> lock(graph.subscriptions_mutex);
+        if (snapshot->generation <= graph.notified_generation) return; // Already checked, possibly by a concurrent change
+        graph.notified_generation = snapshot->generation;
+        graph.notified_area = snapshot->area;
+        for (Subscription& subscription : graph.subscriptions) {
+            bool now_above = snapshot->area >= subscription.threshold;
+            if (now_above == subscription.above) continue;
+            subscription.above = now_above;
+            std::string& event = now_above ? above : below;
+            if (event.empty()) {
+                std::ostringstream oss;
+                oss << (now_above ? "EVENT ABOVE " : "EVENT BELOW ") << snapshot->area << '\n';
+                event = oss.str();
+            }
+            crossed.push_back(subscription);
+        }
+    }
+    for (const Subscription& subscription : crossed)
+        push_line(subscription.fd, subscription.connection, subscription.above ? above : below, true);
+}
+
+/**
+ * @brief Tells the subscribers of the graph a client's last read changed, once for the whole read.
+ * @param state The client's state.
+ */
+void notify_changed_graph(ClientState& state) {
+    if (!state.changed_graph) return;
+    notify_subscribers(*state.changed_graph);
+    state.changed_graph = nullptr;
+}
+
+/**
+ * @brief Drops a client's subscription, if it has one.
+ * @param state The client's state.
+ */
+void unsubscribe(ClientState& state) {
+    if (!state.subscribed_graph) return;
+    Graph& graph = *state.subscribed_graph;
+    std::lock_guard<std::mutex> lock(graph.subscriptions_mutex);
+    std::vector<Subscription>& subscriptions = graph.subscriptions;
+    subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(),
+                                       [&](const Subscription& s) { return s.fd == state.fd; }),
+                        subscriptions.end());
+    state.subscribed_graph = nullptr;
+}
+
+/**
+ * @brief Handles Subscribe: pushes an event each time the area of the client's graph crosses a threshold.
+ *
+ * The side of the threshold is taken from the current area, so every event
+ * is a real crossing. A client has one subscription: a new Subscribe
+ * replaces it, and it stays on the graph it was made on, even after Use.
+ *
+ * @param state The client's state.
+ * @param args The threshold area.
+ * @return "OK" or an error message.
+ */
+std::string handle_subscribe(ClientState& state, std::string_view args) {
+    double threshold;
+    if (!parse_number(args, threshold)) return "ERROR: Invalid threshold.";
+    unsubscribe(state);
+    Graph& graph = *state.graph;
+    std::shared_ptr<const HullSnapshot> snapshot = current_hull_snapshot(graph);
+
+    std::lock_guard<std::mutex> lock(graph.subscriptions_mutex);
+    // A newer generation may have been checked since the snapshot was taken
+    double area = snapshot->generation >= graph.notified_generation ? snapshot->area : graph.notified_area;
+    graph.subscriptions.push_back(Subscription{state.fd, state.connection, threshold, area >= threshold});
+    state.subscribed_graph = &graph;
+    return "OK";
+}
+
+/**
+ * @brief Handles the Use command: switches the client to another graph.
+ *
+ * @param state The client's state.
+ * @param args The graph name.
+ * @return "OK" or an error message.
+ */
+std::string handle_use(ClientState& state, std::string_view args) {
+    if (!valid_graph_name(args)) return "ERROR: Invalid graph name.";
+    std::string error;
+    Graph* graph = open_graph(std::string(args), error);
+    if (!graph) {
+        std::cerr << "Cannot restore graph " << args << ": " << error << std::endl;
+        return "ERROR: Cannot open graph.";
+    }
+    notify_changed_graph(state); // Changes made before the switch
+    state.graph = graph;
+    return "OK";
+}
+
+/**
+ * @brief Handles the Stats command: reports the server's counters and latencies.
+ *
+ * Appends the number of graphs and their total point count to metrics_report().
+ *
+ * @return The report, or an error if the server was built with METRICS=0.
+ */
+std::string handle_stats() {
+#if METRICS
+    size_t graph_count, points = 0;
+    {
+        std::lock_guard<std::mutex> lock(graphs_mutex);
+        graph_count = graphs.size();
+        for (auto& entry : graphs) {
+            std::lock_guard<std::mutex> graph_lock(entry.second->mutex);
+            points += entry.second->point_set.size();
+        }
+    }
+    return metrics_report() + " graphs=" + std::to_string(graph_count) + " points=" + std::to_string(points);
+#else
+    return "ERROR: Metrics are disabled.";
+#endif
+}
+
+/**
+ * @brief Executes one command line, once its request ID is split off.
+ * @param state The client\'s state, which selects its graph.
+ * @param line The trimmed command or point line.
+ * @param command Receives the parsed command; left unchanged for a point line.
  * @return Response string to send back to the client.
  */
-std::string process_line(int fd, const std::string& rawline) {
-    std::string line = rawline;
-    trim_crlf(line);
-    if (line.empty()) return "";
-
-    if (waiting_for_graph && fd != newgraph_owner_fd) return "BUSY";
-    if (waiting_for_graph && fd == newgraph_owner_fd) return handle_point_line(line);
-
-    std::istringstream iss(line);
-    std::string command;
-    iss >> command;
-    std::string args;
-    std::getline(iss, args);
-    size_t pos = args.find_first_not_of(" ");
-    if (pos != std::string::npos) args.erase(0, pos);
-    else args.clear();
-
-    if (command == "Newgraph") {
-        std::lock_guard<std::mutex> lock(graph_mutex);
-        std::istringstream a(args);
+std::string run_command(ClientState& state, std::string_view line, CommandType& command) {
+    Graph& graph = *state.graph;
+
+    if (state.points_to_read > 0) return handle_point_line(state, line);
+
+    std::string_view args;
+    command = parse_command(line, args);
+
+    if (command == CommandType::Newgraph) {
         int n;
-        if (!(a >> n) || n <= 0) return "ERROR: Invalid number.";
-        waiting_for_graph = true;
-        newgraph_owner_fd = fd;
-        points_to_read = n;
-        temp_points.clear();
+        if (!parse_count(args, n) || n <= 0) return "ERROR: Invalid number.";
+        state.binary_graph = false;
+        state.points_to_read = n;
+        state.temp_points.clear();
+        state.temp_points.reserve(std::min(n, 1 << 20)); // Cap what an untrusted count can preallocate
+        return "OK";
+    }
+    if (command == CommandType::NewgraphBin) {
+        int n;
+        if (!parse_count(args, n) || n <= 0) return "ERROR: Invalid number.";
+        state.binary_graph = true;
+        state.binary_graph_invalid = false;
+        state.points_to_read = n;
+        state.temp_points.clear();
+        state.temp_points.reserve(std::min(n, 1 << 20)); // Cap what an untrusted count can preallocate
+        return ""; // Acknowledged once, after the payload
+    }
+    if (command == CommandType::Newpoint || command == CommandType::Removepoint || command == CommandType::Newpoints ||
+        command == CommandType::Removepoints)
+        state.changed_graph = &graph;
+    if (command == CommandType::Newpoint) return handle_newpoint(graph, args);
+    if (command == CommandType::Removepoint) return handle_removepoint(graph, args);
+    if (command == CommandType::Newpoints) return handle_newpoints(graph, args);
+    if (command == CommandType::Removepoints) return handle_removepoints(graph, args);
+    if (command == CommandType::CH) return handle_ch(graph);
+    if (command == CommandType::CHPoints || command == CommandType::Perimeter || command == CommandType::Contains ||
+        command == CommandType::Diameter || command == CommandType::MinBoundingRect)
+        return handle_hull_query(graph, command, args);
+    if (command == CommandType::Snapshot) return handle_snapshot(graph);
+    if (command == CommandType::Use) return handle_use(state, args);
+    if (command == CommandType::Stats) return handle_stats();
+    if (command == CommandType::Subscribe) return handle_subscribe(state, args);
+    if (command == CommandType::Unsubscribe) {
+        unsubscribe(state);
         return "OK";
     }
-    if (command == "Newpoint") return handle_newpoint(args);
-    if (command == "Removepoint") return handle_removepoint(args);
-    if (command == "CH") return handle_ch();
 
     return "ERROR: Unknown command.";
 }
 
 /**
- * @brief Handles communication with a single client in a separate thread.
+ * @brief Appends a response line to a client's output, prefixed with the request ID it answers.
+ *
+ * @param output The client's output buffer.
+ * @param id The ID without '#', empty for an untagged command.
+ * @param response The response; an empty one (no answer) appends nothing.
+ */
+void append_response(std::string& output, std::string_view id, std::string_view response) {
+    if (response.empty()) return;
+    if (!id.empty()) {
+        output += '#';
+        output.append(id.data(), id.size());
+        output += ' ';
+    }
+    output.append(response.data(), response.size());
+    output += '\n';
+}
+
+/**
+ * @brief Hands a tagged CH to a proactor pool worker, so the connection's next commands are answered meanwhile.
+ *
+ * Only CH requests with a request ID are deferred, since the client can
+ * only match an answer that arrives out of order by its ID, and only when
+ * the hull snapshot is stale: a current one is answered in line at no cost.
+ * The answer reflects every command the client sent before the CH, and
+ * possibly some sent after it, like a CH from another connection would.
+ * With --uring the pool only runs such tasks, and the answer is posted back
+ * to the proactor thread, which alone sends. Requests beyond DEFERRED_CH_MAX
+ * are answered in line.
+ *
+ * @param state The client's state.
+ * @param line The command, after its request ID.
+ * @param id The request ID, not empty.
+ * @return true if the CH was posted and a worker will answer it.
+ */
+bool defer_ch(ClientState& state, std::string_view line, std::string_view id) {
+    std::string_view args;
+    if (parse_command(line, args) != CommandType::CH || hull_snapshot_current(*state.graph)) return false;
+    if (deferred_ch.fetch_add(1) >= DEFERRED_CH_MAX) {
+        --deferred_ch;
+        return false;
+    }
+    Graph* graph = state.graph;
+    int fd = state.fd;
+    uint64_t connection = state.connection;
+    std::string tag(id);
+    int posted = postToProactorPool(proactor_pool, [graph, fd, connection, tag]() {
+        uint64_t start = metrics_clock();
+        std::string answer;
+        append_response(answer, tag, handle_ch(*graph));
+        metrics_record_command(CommandType::CH, start);
+        --deferred_ch;
+        if (!uring_proactor) return push_line(fd, connection, answer, false);
+        proactorPost(uring_proactor, [fd, connection, answer]() { push_line(fd, connection, answer, false); });
+    });
+    if (posted != 0) --deferred_ch;
+    return posted == 0;
+}
+
+/**
+ * @brief Answers a line received from a client, echoing its request ID if it has one.
+ *
+ * @param state The client's state, which selects its graph.
+ * @param rawline The raw input line.
+ * @param output Receives the response line, nothing if the line needs no answer yet.
+ */
+void process_line(ClientState& state, std::string_view rawline, std::string& output) {
+    std::string_view line = trim_line(rawline);
+    if (line.empty()) return;
+    std::string_view id;
+    if (!split_request_id(line, id)) return append_response(output, std::string_view(), "ERROR: Invalid request ID.");
+    if (!id.empty() && state.points_to_read == 0 && defer_ch(state, line, id)) return; // Answered by a pool worker
+    CommandType command = CommandType::Unknown;
+    bool timed = state.points_to_read == 0; // Lines of a Newgraph upload are not commands
+    uint64_t start = metrics_clock();
+    std::string response = run_command(state, line, command);
+    if (timed) metrics_record_command(command, start);
+    if (state.binary_graph && response.empty()) state.upload_id.assign(id.data(), id.size()); // Answered after the payload
+    append_response(output, id, response);
+}
+
+/**
+ * @brief Looks up a client's state.
+ * @param fd The client's socket file descriptor, registered by open_client().
+ * @return The state; it stays attached to fd until release_client().
+ */
+ClientState& client_state(int fd) {
+    return *clients.get(fd);
+}
+
+/**
+ * @brief Attaches a state to a newly accepted client, reusing a released one when possible.
+ * @param fd The new client socket.
+ * @return The state, or nullptr if fd is beyond what the slab indexes.
+ */
+ClientState* open_client(int fd) {
+    ClientState* state = clients.open(fd);
+    if (!state) return nullptr;
+    state->fd = fd;
+    state->graph = default_graph;
+    std::lock_guard<std::mutex> lock(send_locks[fd % SEND_LOCKS]);
+    state->connection = ++last_connection;
+    return state;
+}
+
+/**
+ * @brief Releases a disconnected client's state, including any Newgraph it staged.
+ *
+ * The state goes back to its arena with its input and output buffers, which
+ * keep their capacity for the next connection.
  * @param fd The client's socket file descriptor.
- * @return nullptr when the thread exits.
  */
-void* client_thread_handler(int fd) {
-    char buffer[1024];
-    clients[fd] = ClientState{};
+void release_client(int fd) {
+    ClientState* state = clients.get(fd);
+    if (!state) return;
+    unsubscribe(*state); // Before the socket is closed and its number reused
+    {
+        // An event copied before the unsubscribe is then either sent first or dropped
+        std::lock_guard<std::mutex> lock(send_locks[fd % SEND_LOCKS]);
+        state->connection = 0;
+        if (state->watching_write) removeFdFromReactor(listener_reactor, fd); // Before the fd is closed
+        state->watching_write = false;
+        state->paused = false;
+        if (state->pending.capacity() > OUTPUT_HIGH_WATERMARK) std::string().swap(state->pending);
+        else state->pending.clear();
+    }
+    state->fd = -1;
+    state->input.reset();
+    if (state->outbuf.capacity() > INPUT_READ_MAX) std::string().swap(state->outbuf); // Left by a huge CHPoints
+    else state->outbuf.clear();
+    state->graph = nullptr;
+    PointCloud().swap(state->temp_points); // Staged points are not worth keeping per pooled state
+    state->points_to_read = 0;
+    state->binary_graph = false;
+    state->binary_graph_invalid = false;
+    state->upload_id.clear();
+    state->changed_graph = nullptr;
+    clients.close(fd);
+}
 
+/**
+ * @brief Answers every complete line buffered for a client.
+ * @param state The client's state, with the newly received bytes committed.
+ * @return The client's output buffer holding one response per line; the caller
+ *         queues it and clears it.
+ */
+std::string& answer_client_input(ClientState& state) {
+    InputBuffer& input = state.input;
+    std::string& output = state.outbuf;
     while (true) {
-        int bytes = recv(fd, buffer, sizeof(buffer), 0);
-        if (bytes <= 0) {
-            std::cout << "Client " << fd << " disconnected or error occurred (recv=" << bytes << "). Closing fd." << std::endl;
-            break;
+        std::string_view line;
+        size_t answered = output.size();
+        if (state.binary_graph) {
+            std::string response = handle_binary_points(state);
+            if (response.empty()) break; // Rest of the payload is still in flight
+            append_response(output, std::string_view(), response);
+        } else {
+            if (!input.next_line(line)) break; // Slice of the buffer, no copy
+            process_line(state, line, output); // Answered straight into the output buffer
         }
+        LOG_TRACE("Processing line: " << line << " → Response: " << std::string_view(output).substr(answered));
+    }
+    return output;
+}
 
-        std::string& inbuf = clients[fd].inbuf;
-        inbuf.append(buffer, bytes);
-        std::cout << "Received from fd " << fd << ": " << std::string(buffer, bytes) << std::endl;
-
-        size_t pos;
-        while ((pos = inbuf.find('\n')) != std::string::npos) {
-            std::string line = inbuf.substr(0, pos + 1);
-            inbuf.erase(0, pos + 1);
-            std::string response = process_line(fd, line);
-            std::cout << "Processing line: " << line << " → Response: " << response << "\n" << std::endl;
+/**
+ * @brief Appends bytes received by the io_uring proactor and answers every complete line.
+ * @param fd The client's socket file descriptor.
+ * @param data The received bytes.
+ * @param len Number of received bytes.
+ * @return The client's output buffer (see answer_client_input()).
+ */
+std::string& consume_client_input(int fd, const char* data, size_t len) {
+    ClientState& state = client_state(fd);
+    state.input.append(data, len);
+    LOG_TRACE("Received from fd " << fd << ": " << std::string_view(data, len));
+    return answer_client_input(state);
+}
 
-            if (!response.empty()) {
-                response += "\n";
-                send(fd, response.c_str(), response.size(), 0);
-            }
+/**
+ * @brief Reads what a client sent and answers every complete line.
+ *
+ * Run by a proactor pool worker each time the socket becomes readable; the
+ * pool never hands the same socket to two workers at once. The responses are
+ * queued with send_output(), so a client that does not read them never blocks
+ * the worker; once more than OUTPUT_HIGH_WATERMARK bytes are pending its input
+ * is parked, and TCP flow control throttles it until the output drains.
+ * @param fd The client's non-blocking socket.
+ * @return PROACTOR_CLOSE if the client disconnected, PROACTOR_PARK while its
+ *         output drains, PROACTOR_KEEP otherwise.
+ */
+int handle_client_data(int fd) {
+    ClientState& state = client_state(fd);
+    {
+        std::lock_guard<std::mutex> lock(send_locks[fd % SEND_LOCKS]);
+        if (state.pending.size() > OUTPUT_HIGH_WATERMARK) {
+            LOG_INFO("Client " << fd << " is not reading its responses. Pausing input.");
+            state.paused = true; // flush_client() resumes it, possibly before this returns
+            return PROACTOR_PARK;
         }
     }
+    char* buffer = state.input.write_area();
+    int bytes = recv(fd, buffer, state.input.write_size(), 0); // Receive straight into the buffer
+    if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return PROACTOR_KEEP;
+    if (bytes <= 0) {
+        LOG_INFO("Client " << fd << " disconnected or error occurred (recv=" << bytes << "). Closing fd.");
+        release_client(fd);
+        return PROACTOR_CLOSE;
+    }
+    LOG_TRACE("Received from fd " << fd << ": " << std::string_view(buffer, bytes));
+    state.input.commit(bytes);
 
-    close(fd);
-    std::lock_guard<std::mutex> lock(graph_mutex);
-    clients.erase(fd);
-    if (waiting_for_graph && fd == newgraph_owner_fd) {
-        std::cout << "Graph construction aborted (owner disconnected)." << std::endl;
-        waiting_for_graph = false;
-        newgraph_owner_fd = -1;
-        temp_points.clear();
+    std::string& output = answer_client_input(state);
+    if (!output.empty()) {
+        std::lock_guard<std::mutex> lock(send_locks[fd % SEND_LOCKS]);
+        send_output(fd, state, output);
+        output.clear(); // Keeps its capacity for the next read
     }
-    return nullptr;
+    notify_changed_graph(state); // After the responses, so a subscriber sees its own OK first
+    return PROACTOR_KEEP;
 }
 
 /**
- * @brief Handles a new incoming client connection.
- * @param listener_fd The file descriptor of the listening socket.
+ * @brief Registers a client accepted by the io_uring proactor.
+ * @param fd The new client socket.
+ * @return false if the client cannot be given a state, so the proactor closes it.
  */
-void handle_new_connection(int listener_fd) {
-    int client_fd = accept(listener_fd, nullptr, nullptr);
-    if (client_fd >= 0) {
-        std::cout << "New client accepted: " << client_fd << std::endl;
-        startProactor(client_fd, client_thread_handler);
+bool accept_uring_client(int fd) {
+    LOG_INFO("New client accepted: " << fd);
+    return open_client(fd) != nullptr;
+}
+
+/**
+ * @brief Completion callback of the io_uring proactor.
+ * @param proactor The proactor, used to queue the responses.
+ * @param fd The client's socket file descriptor.
+ * @param data The received bytes, or nullptr once the connection ended.
+ * @param len Number of received bytes (0 once the connection ended).
+ * @return Always true; clients close their own connections.
+ */
+bool handle_uring_data(void* proactor, int fd, const char* data, size_t len) {
+    if (len == 0) {
+        LOG_INFO("Client " << fd << " disconnected. Closing fd.");
+        release_client(fd);
+        return true;
+    }
+    std::string& output = consume_client_input(fd, data, len);
+    if (!output.empty()) {
+        proactorSend(proactor, fd, output.data(), output.size()); // Copies the bytes
+        output.clear();
     }
+    notify_changed_graph(client_state(fd));
+    return true;
 }
 
 /**
- * @brief Thread function that monitors the area of the convex hull and prints updates.
- * @param Unused
- * @return nullptr when the thread exits.
+ * @brief Handles a new incoming client connection.
+ * @param listener_fd The file descriptor of the listening socket.
  */
-void* area_monitor_thread(void*) {
-    while (true) {
-        // Wait for a signal indicating a CH computation was requested
-        pthread_mutex_lock(&cond_mutex);
-        pthread_cond_wait(&cond, &cond_mutex);
-        pthread_mutex_unlock(&cond_mutex);
-
-        double area = 0;
-        {
-            // Lock the graph before computing CH to avoid data races
-            std::lock_guard<std::mutex> lock(graph_mutex);
-            auto hull = compute_convex_hull_deque(point_set);
-            area = compute_area(hull);
+void handle_new_connection(int listener_fd) {
+    int client_fd = accept(listener_fd, nullptr, nullptr);
+    if (client_fd >= 0) {
+        LOG_INFO("New client accepted: " << client_fd);
+        fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL) | O_NONBLOCK); // Output is queued, never waited for
+        if (!open_client(client_fd)) {
+            std::cerr << "No client slot for fd " << client_fd << ", closing it." << std::endl;
+            close(client_fd);
+            return;
         }
-
-        // Print a message if CH area crosses 100 threshold in either direction
-        if (area >= 100.0 && !at_least_100) {
-            at_least_100 = true;
-            std::cout << "At Least 100 units belongs to CH" << std::endl;
-        } else if (area < 100.0 && at_least_100) {
-            at_least_100 = false;
-            std::cout << "At Least 100 units no longer belongs to CH" << std::endl;
+        if (addSocketToProactorPool(proactor_pool, client_fd) != 0) {
+            perror("proactor registration failed");
+            release_client(client_fd);
+            close(client_fd);
         }
     }
-    return nullptr;
 }
 
 /**
  * @brief Main entry point of the server program.
  *        Sets up networking, launches threads, and starts the reactor.
+ *
+ * Options:
+ * - -w N: serve clients with N proactor worker threads (0 = one per hardware
+ *   thread, the default). Connections never create threads of their own.
+ *   The same workers compute the tagged CH requests that are answered out of
+ *   order (see defer_ch()).
+ * - --uring: serve the listener and all clients from one io_uring completion
+ *   loop instead (Linux only; falls back to the worker pool if unavailable).
+ *   The N workers then only compute deferred CH requests.
+ * - --state DIR: restore the graphs saved in DIR when they are first used,
+ *   then keep DIR up to date with change logs and snapshots (every Newgraph,
+ *   every SNAPSHOT_LOG_RECORDS changes and on the Snapshot command).
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments (see the options above).
  * @return Exit status code.
  */
-int main() {
+int main(int argc, char* argv[]) {
+    int workers = 0;
+    bool use_uring = false;
+    const char* state_dir = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-w") == 0 && i + 1 < argc && parse_count(argv[i + 1], workers)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--uring") == 0) {
+            use_uring = true;
+        } else if (std::strcmp(argv[i], "--state") == 0 && i + 1 < argc) {
+            state_dir = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [-w workers] [--uring] [--state DIR]" << std::endl;
+            return 1;
+        }
+    }
+    if (state_dir) state_root = state_dir;
+    std::string error;
+    default_graph = open_graph(DEFAULT_GRAPH, error);
+    if (!default_graph) {
+        std::cerr << "Cannot restore the graph: " << error << std::endl;
+        return 1;
+    }
+
     int listener = socket(AF_INET, SOCK_STREAM, 0);
     if (listener < 0) {
         perror("socket failed");
@@ -303,18 +1275,26 @@ int main() {
         return 1;
     }
 
-    void* reactor = startReactor();
-    addFdToReactor(reactor, listener, handle_new_connection);
+    if (use_uring) {
+        uring_proactor = startUringProactor(listener, accept_uring_client, handle_uring_data);
+        if (!uring_proactor) std::cerr << "io_uring unavailable, using the proactor pool." << std::endl;
+    }
 
-    pthread_create(&monitor_thread, nullptr, area_monitor_thread, nullptr);
+    proactor_pool = startProactorPool(workers, handle_client_data); // Holds no sockets with --uring
+    if (!proactor_pool) {
+        std::cerr << "Failed to start the proactor pool." << std::endl;
+        return 1;
+    }
+    if (!uring_proactor) {
+        listener_reactor = startReactor();
+        addFdToReactor(listener_reactor, listener, handle_new_connection);
+    }
 
     std::cout << "Server running on port " << PORT << ". Press Ctrl+C to exit.\n" << std::endl;
     while (true) std::this_thread::sleep_for(std::chrono::seconds(1));
 
-    stopReactor(reactor);
-    monitor_running = false;
-    pthread_cond_signal(&cond);
-    pthread_join(monitor_thread, nullptr);
-
+    if (listener_reactor) stopReactor(listener_reactor);
+    stopProactorPool(proactor_pool); // Before the proactor its deferred CH tasks post to
+    if (uring_proactor) stopUringProactor(uring_proactor);
     return 0;
 }
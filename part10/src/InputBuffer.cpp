@@ -0,0 +1,62 @@
+#include "../include/InputBuffer.hpp"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @brief Moves the unread bytes to the front if that frees enough space, else grows.
+ */
+void InputBuffer::reserve(size_t n) {
+    if (storage.size() - tail >= n) return;
+    size_t unread_size = tail - head;
+    if (head > 0) {
+        std::memmove(storage.data(), storage.data() + head, unread_size);
+        head = 0;
+        tail = unread_size;
+    }
+    if (storage.size() - tail < n) storage.resize(std::max(storage.size() * 2, tail + n));
+}
+
+char* InputBuffer::write_area() {
+    reserve(read_size);
+    return storage.data() + tail;
+}
+
+void InputBuffer::commit(size_t n) {
+    tail += n;
+    if (n == read_size && read_size < INPUT_READ_MAX) {
+        read_size *= 2; // The socket had more to give
+    } else if (n < read_size / 4 && read_size > INPUT_READ_MIN) {
+        read_size /= 2;
+    }
+}
+
+void InputBuffer::append(const char* data, size_t len) {
+    reserve(len);
+    std::memcpy(storage.data() + tail, data, len);
+    tail += len;
+}
+
+bool InputBuffer::next_line(std::string_view& line) {
+    const char* start = storage.data() + head;
+    const char* newline = static_cast<const char*>(std::memchr(start + scanned, '\n', tail - head - scanned));
+    if (!newline) {
+        scanned = tail - head;
+        return false;
+    }
+    size_t length = newline - start + 1;
+    line = std::string_view(start, length);
+    consume(length);
+    return true;
+}
+
+void InputBuffer::consume(size_t n) {
+    head += n;
+    scanned = 0;
+    if (head == tail) head = tail = 0; // Everything consumed: the next read starts at the front
+}
+
+void InputBuffer::reset() {
+    if (storage.size() > 2 * INPUT_READ_MAX) std::vector<char>().swap(storage);
+    head = tail = scanned = 0;
+    read_size = INPUT_READ_MIN;
+}
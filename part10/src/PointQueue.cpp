@@ -0,0 +1,58 @@
+#include "../include/PointQueue.hpp"
+#include <thread>
+
+PointQueue::PointQueue(size_t capacity) : tail_pos(0), head_pos(0) {
+    size_t slots = 1;
+    while (slots < capacity) slots <<= 1;
+    cells.reset(new Cell[slots]);
+    for (size_t i = 0; i < slots; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    mask = slots - 1;
+}
+
+/**
+ * @brief Claims the tail slot if it is free and publishes the point into it.
+ */
+bool PointQueue::push(const Point& p) {
+    size_t pos = tail_pos.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = cells[pos & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence == pos) {
+            if (tail_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.point = p;
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (sequence < pos) {
+            return false; // The slot still holds a point from one lap ago
+        } else {
+            pos = tail_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+size_t PointQueue::tail() const {
+    return tail_pos.load(std::memory_order_acquire);
+}
+
+size_t PointQueue::size() const {
+    size_t tail = tail_pos.load(std::memory_order_relaxed);
+    size_t head = head_pos.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+}
+
+/**
+ * @brief Reads slots in order up to end, yielding while a claimed slot is still unpublished.
+ */
+size_t PointQueue::pop_until(size_t end, std::vector<Point>& out) {
+    size_t head = head_pos.load(std::memory_order_relaxed);
+    size_t start = head;
+    for (; head < end; ++head) {
+        Cell& cell = cells[head & mask];
+        while (cell.sequence.load(std::memory_order_acquire) != head + 1) std::this_thread::yield();
+        out.push_back(cell.point);
+        cell.sequence.store(head + mask + 1, std::memory_order_release);
+        head_pos.store(head + 1, std::memory_order_relaxed);
+    }
+    return head - start;
+}
@@ -1,7 +1,40 @@
 #include "../include/Proactor.hpp"
+#include "../include/Metrics.hpp"
 #include <pthread.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <iostream>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#if defined(__linux__)
+#define PROACTOR_EPOLL 1
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#define PROACTOR_KQUEUE 1
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define PROACTOR_URING 1
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#endif
+#endif
 
 /**
  * @struct ThreadArgs
@@ -22,11 +55,13 @@ struct ThreadArgs {
  */
 void* threadWrapper(void* arg) {
     ThreadArgs* args = static_cast<ThreadArgs*>(arg);
+    metrics_gauge_add(Gauge::ProactorThreads, 1);
     if (args->func) {
         args->func(args->sockfd);  // Execute user-defined function
     }
     close(args->sockfd);  // Close socket when done
     delete args;
+    metrics_gauge_add(Gauge::ProactorThreads, -1);
     return nullptr;
 }
 
@@ -68,3 +103,748 @@ int stopProactor(pthread_t tid) {
     }
     return 0;
 }
+
+/**
+ * @struct ProactorPool
+ * @brief Fixed set of worker threads sharing one kernel event queue.
+ */
+struct ProactorPool {
+    int pollFd;                     // epoll or kqueue descriptor shared by the workers
+    proactorReadyFunc func;         // Callback for ready sockets
+    std::atomic<bool> running;      // Cleared to stop the workers
+    std::vector<pthread_t> workers; // Worker thread IDs
+    std::unordered_set<int> sockets; // Sockets currently owned by the pool
+    std::mutex lock;                // Guards `sockets` and `tasks`
+    std::deque<proactorTask> tasks; // Posted by postToProactorPool(), taken in order
+    int wakeFd = -1;                // Eventfd (read end of a pipe outside Linux), readable while tasks are queued
+    int wakeWriteFd = -1;           // Write end, the same descriptor for an eventfd
+};
+
+/**
+ * @brief Arms a socket for one readiness notification.
+ *
+ * One-shot registration guarantees that a single worker handles a socket until it re-arms it.
+ *
+ * @param pool Pointer to the pool instance.
+ * @param sockfd The socket to arm.
+ * @param add true for a new socket, false to re-arm a registered one.
+ * @return 0 on success, -1 on failure.
+ */
+static int armSocket(ProactorPool* pool, int sockfd, bool add) {
+#if defined(PROACTOR_EPOLL)
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.fd = sockfd;
+    return epoll_ctl(pool->pollFd, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, sockfd, &ev) == 0 ? 0 : -1;
+#elif defined(PROACTOR_KQUEUE)
+    struct kevent ev;
+    EV_SET(&ev, sockfd, EVFILT_READ, (add ? EV_ADD : EV_ENABLE) | EV_DISPATCH, 0, 0, nullptr);
+    return kevent(pool->pollFd, &ev, 1, nullptr, 0, nullptr) == 0 ? 0 : -1;
+#else
+    (void)pool;
+    (void)sockfd;
+    (void)add;
+    return -1;
+#endif
+}
+
+/**
+ * @brief Opens the descriptor that is readable while tasks are queued: an eventfd on Linux, a pipe elsewhere.
+ *
+ * @param pool Pointer to the pool instance.
+ * @return true on success.
+ */
+static bool openTaskWakeup(ProactorPool* pool) {
+#if defined(PROACTOR_EPOLL)
+    pool->wakeFd = pool->wakeWriteFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return pool->wakeFd >= 0;
+#else
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    pool->wakeFd = fds[0];
+    pool->wakeWriteFd = fds[1];
+    return true;
+#endif
+}
+
+/**
+ * @brief Takes the oldest posted task and runs it.
+ *
+ * The wakeup descriptor is armed one-shot like a socket and re-armed before
+ * the task runs, so another worker takes the next task meanwhile. It is
+ * drained with the last task, under the lock posters write to it with.
+ *
+ * @param pool Pointer to the pool instance.
+ */
+static void runPostedTask(ProactorPool* pool) {
+    proactorTask task;
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        if (!pool->tasks.empty()) {
+            task = std::move(pool->tasks.front());
+            pool->tasks.pop_front();
+        }
+        if (pool->tasks.empty()) {
+            char buffer[64];
+            while (read(pool->wakeFd, buffer, sizeof(buffer)) > 0) {
+            }
+        }
+        armSocket(pool, pool->wakeFd, false);
+    }
+    if (task) task();
+}
+
+/**
+ * @brief Waits up to one second for a ready socket.
+ *
+ * @param pool Pointer to the pool instance.
+ * @return The ready socket, or -1 on timeout.
+ */
+static int waitReadySocket(ProactorPool* pool) {
+#if defined(PROACTOR_EPOLL)
+    epoll_event ev;
+    return epoll_wait(pool->pollFd, &ev, 1, 1000) == 1 ? ev.data.fd : -1;
+#elif defined(PROACTOR_KQUEUE)
+    struct kevent ev;
+    struct timespec timeout = {1, 0};
+    return kevent(pool->pollFd, nullptr, 0, &ev, 1, &timeout) == 1 ? static_cast<int>(ev.ident) : -1;
+#else
+    (void)pool;
+    return -1;
+#endif
+}
+
+/**
+ * @brief Worker loop: handles ready sockets until the pool stops.
+ *
+ * @param arg Pointer to the ProactorPool.
+ * @return Always returns nullptr.
+ */
+static void* poolWorker(void* arg) {
+    ProactorPool* pool = static_cast<ProactorPool*>(arg);
+    metrics_gauge_add(Gauge::ProactorThreads, 1);
+    while (pool->running) {
+        int sockfd = waitReadySocket(pool);
+        if (sockfd < 0) continue;
+        if (sockfd == pool->wakeFd) {
+            runPostedTask(pool);
+            continue;
+        }
+        int result = pool->func(sockfd);
+        if (result == PROACTOR_PARK) continue; // The callback resumes it; the socket may already be in use again
+        if (result == PROACTOR_KEEP && armSocket(pool, sockfd, false) == 0) continue;
+
+        std::lock_guard<std::mutex> guard(pool->lock);
+        pool->sockets.erase(sockfd);
+        close(sockfd); // Closing also drops the kernel registration
+    }
+    metrics_gauge_add(Gauge::ProactorThreads, -1);
+    return nullptr;
+}
+
+/**
+ * @brief Opens the shared event queue and starts the worker threads.
+ *
+ * @param workers Number of worker threads; 0 or less uses one per hardware thread.
+ * @param func The callback invoked for every ready socket.
+ * @return Pointer to the pool, or nullptr on failure.
+ */
+void* startProactorPool(int workers, proactorReadyFunc func) {
+    if (workers <= 0) workers = static_cast<int>(std::thread::hardware_concurrency());
+    if (workers <= 0) workers = 1;
+
+    ProactorPool* pool = new ProactorPool;
+#if defined(PROACTOR_EPOLL)
+    pool->pollFd = epoll_create1(EPOLL_CLOEXEC);
+#elif defined(PROACTOR_KQUEUE)
+    pool->pollFd = kqueue();
+#else
+    pool->pollFd = -1;
+#endif
+    if (pool->pollFd < 0) {
+        std::cerr << "Failed to create proactor event queue" << std::endl;
+        delete pool;
+        return nullptr;
+    }
+    if (!openTaskWakeup(pool) || armSocket(pool, pool->wakeFd, true) != 0) {
+        std::cerr << "Failed to create proactor task wakeup" << std::endl;
+        if (pool->wakeWriteFd != pool->wakeFd) close(pool->wakeWriteFd);
+        if (pool->wakeFd >= 0) close(pool->wakeFd);
+        close(pool->pollFd);
+        delete pool;
+        return nullptr;
+    }
+    pool->func = func;
+    pool->running = true;
+
+    for (int i = 0; i < workers; ++i) {
+        pthread_t tid;
+        if (pthread_create(&tid, nullptr, poolWorker, pool) != 0) {
+            std::cerr << "Failed to create proactor worker thread" << std::endl;
+            stopProactorPool(pool);
+            return nullptr;
+        }
+        pool->workers.push_back(tid);
+    }
+    return pool;
+}
+
+/**
+ * @brief Registers a connected socket with the pool.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @param sockfd The socket to watch.
+ * @return 0 on success, -1 on failure.
+ */
+int addSocketToProactorPool(void* poolPtr, int sockfd) {
+    ProactorPool* pool = static_cast<ProactorPool*>(poolPtr);
+    std::lock_guard<std::mutex> guard(pool->lock);
+    if (armSocket(pool, sockfd, true) != 0) return -1;
+    pool->sockets.insert(sockfd);
+    return 0;
+}
+
+/**
+ * @brief Re-arms a socket its callback parked.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @param sockfd The parked socket.
+ * @return 0 on success, -1 on failure.
+ */
+int resumeProactorPoolSocket(void* poolPtr, int sockfd) {
+    return armSocket(static_cast<ProactorPool*>(poolPtr), sockfd, false);
+}
+
+/**
+ * @brief Queues a task and makes the wakeup descriptor readable if the queue was empty.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @param task The task to run.
+ * @return 0 on success, -1 if the wakeup could not be written.
+ */
+int postToProactorPool(void* poolPtr, proactorTask task) {
+    ProactorPool* pool = static_cast<ProactorPool*>(poolPtr);
+    std::lock_guard<std::mutex> guard(pool->lock);
+    if (pool->tasks.empty()) {
+        uint64_t one = 1;
+        if (write(pool->wakeWriteFd, &one, sizeof(one)) != sizeof(one)) return -1;
+    }
+    pool->tasks.push_back(std::move(task));
+    return 0;
+}
+
+/**
+ * @brief Stops and joins the workers, then closes the remaining sockets and the queue.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @return 0 on success, -1 on failure.
+ */
+int stopProactorPool(void* poolPtr) {
+    ProactorPool* pool = static_cast<ProactorPool*>(poolPtr);
+    pool->running = false;
+    int result = 0;
+    for (pthread_t tid : pool->workers) {
+        if (pthread_join(tid, nullptr) != 0) result = -1;
+    }
+    for (int sockfd : pool->sockets) close(sockfd);
+    if (pool->wakeWriteFd != pool->wakeFd) close(pool->wakeWriteFd);
+    close(pool->wakeFd); // Tasks still queued are dropped
+    close(pool->pollFd);
+    delete pool;
+    return result;
+}
+
+#if defined(PROACTOR_URING)
+
+#define URING_ENTRIES 256       // Submission queue size
+#define URING_BUFFER_COUNT 256  // Provided receive buffers shared by all clients
+#define URING_BUFFER_SIZE 4096  // Size of each provided buffer
+#define URING_BUFFER_GROUP 1    // Buffer group ID used for receives
+
+// Older kernel headers lack the multishot flags; single-shot requests are used instead
+#ifndef IORING_ACCEPT_MULTISHOT
+#define IORING_ACCEPT_MULTISHOT 0
+#endif
+#ifndef IORING_RECV_MULTISHOT
+#define IORING_RECV_MULTISHOT 0
+#endif
+#ifndef IORING_CQE_F_MORE
+#define IORING_CQE_F_MORE 0
+#endif
+
+/**
+ * @enum UringOp
+ * @brief Operation kind stored in the upper half of a request's user_data.
+ */
+enum UringOp : uint64_t { URING_ACCEPT = 1, URING_RECV, URING_SEND, URING_PROVIDE, URING_WAKE };
+
+/**
+ * @struct UringConnection
+ * @brief Output and lifetime state of one io_uring client.
+ */
+struct UringConnection {
+    std::string outbox;   // Output queued while a send is in flight
+    std::string inflight; // Bytes owned by the in-flight send
+    bool sending = false; // A send request is in flight
+    bool receiving = false; // A receive request is armed
+    bool closing = false; // Close once the receive has ended and output is flushed
+};
+
+/**
+ * @struct UringProactor
+ * @brief A mapped io_uring instance with its listener, buffers and clients.
+ */
+struct UringProactor {
+    int ringFd;
+    unsigned sqEntries;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    io_uring_sqe* sqes;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    io_uring_cqe* cqes;
+    void* sqRing;
+    size_t sqRingSize;
+    void* cqRing;
+    size_t cqRingSize;
+    size_t sqesSize;
+    unsigned localTail; // Tail including prepared but unpublished entries
+    unsigned toSubmit;  // Entries prepared since the last io_uring_enter
+
+    int listener;
+    int wakeFd;           // eventfd that interrupts the loop on stop or for posted tasks
+    uint64_t wakeValue;   // Read target for wakeFd
+    std::mutex postLock;  // Guards `posted`
+    std::vector<proactorTask> posted; // Posted by proactorPost(), run in order on the wake completion
+    bool multishotAccept; // Cleared if the kernel rejects multishot accept
+    bool multishotRecv;   // Cleared if the kernel rejects multishot receive
+    proactorAcceptFunc onAccept;
+    proactorRecvFunc onRecv;
+    std::vector<char> buffers; // URING_BUFFER_COUNT buffers of URING_BUFFER_SIZE bytes
+    std::unordered_map<int, UringConnection> connections;
+    std::atomic<bool> running;
+    pthread_t thread;
+};
+
+/**
+ * @brief Encodes an operation and socket into a request's user_data.
+ */
+static uint64_t uringTag(UringOp op, int fd) {
+    return (static_cast<uint64_t>(op) << 32) | static_cast<uint32_t>(fd);
+}
+
+/**
+ * @brief Submits prepared entries and optionally waits for completions.
+ *
+ * @param ring Pointer to the proactor.
+ * @param waitFor Minimum number of completions to wait for.
+ * @return 0 on success, -1 on failure.
+ */
+static int uringSubmit(UringProactor* ring, unsigned waitFor) {
+    __atomic_store_n(ring->sqTail, ring->localTail, __ATOMIC_RELEASE);
+    while (true) {
+        long done = syscall(__NR_io_uring_enter, ring->ringFd, ring->toSubmit, waitFor,
+                            waitFor ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        if (done >= 0) {
+            ring->toSubmit -= static_cast<unsigned>(done) < ring->toSubmit ? static_cast<unsigned>(done) : ring->toSubmit;
+            return 0;
+        }
+        if (errno != EINTR) return -1;
+    }
+}
+
+/**
+ * @brief Returns a cleared submission entry, submitting first if the queue is full.
+ *
+ * @param ring Pointer to the proactor.
+ * @return The entry, or nullptr if the queue stays full.
+ */
+static io_uring_sqe* uringEntry(UringProactor* ring) {
+    unsigned head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+    if (ring->localTail - head == ring->sqEntries) {
+        if (uringSubmit(ring, 0) != 0) return nullptr;
+        head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+        if (ring->localTail - head == ring->sqEntries) return nullptr;
+    }
+    unsigned index = ring->localTail & *ring->sqMask;
+    io_uring_sqe* sqe = &ring->sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    ring->sqArray[index] = index;
+    ++ring->localTail;
+    ++ring->toSubmit;
+    return sqe;
+}
+
+/**
+ * @brief Hands provided buffers [first, first + count) back to the kernel.
+ */
+static void uringProvideBuffers(UringProactor* ring, unsigned first, unsigned count) {
+    io_uring_sqe* sqe = uringEntry(ring);
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = static_cast<int>(count);
+    sqe->addr = reinterpret_cast<uint64_t>(ring->buffers.data() + static_cast<size_t>(first) * URING_BUFFER_SIZE);
+    sqe->len = URING_BUFFER_SIZE;
+    sqe->off = first;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    sqe->user_data = uringTag(URING_PROVIDE, 0);
+}
+
+/**
+ * @brief Arms the (multishot) accept on the listener.
+ */
+static void uringArmAccept(UringProactor* ring) {
+    io_uring_sqe* sqe = uringEntry(ring);
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = ring->listener;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    if (ring->multishotAccept) sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = uringTag(URING_ACCEPT, ring->listener);
+}
+
+/**
+ * @brief Arms a (multishot) receive that lets the kernel pick a provided buffer.
+ */
+static void uringArmRecv(UringProactor* ring, int fd) {
+    io_uring_sqe* sqe = uringEntry(ring);
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    if (ring->multishotRecv) sqe->ioprio = IORING_RECV_MULTISHOT; // Length comes from the buffer
+    else sqe->len = URING_BUFFER_SIZE;
+    sqe->user_data = uringTag(URING_RECV, fd);
+    ring->connections[fd].receiving = true;
+}
+
+/**
+ * @brief Arms a read on the wake-up eventfd.
+ */
+static void uringArmWake(UringProactor* ring) {
+    io_uring_sqe* sqe = uringEntry(ring);
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = ring->wakeFd;
+    sqe->addr = reinterpret_cast<uint64_t>(&ring->wakeValue);
+    sqe->len = sizeof(ring->wakeValue);
+    sqe->user_data = uringTag(URING_WAKE, ring->wakeFd);
+}
+
+/**
+ * @brief Starts a send of the connection's queued output if none is in flight.
+ *
+ * All output is coalesced into one request per round trip, which keeps it in
+ * order and makes a short send simply resume from where it stopped.
+ */
+static void uringFlush(UringProactor* ring, int fd, UringConnection& conn) {
+    if (conn.sending) return;
+    if (conn.inflight.empty()) conn.inflight.swap(conn.outbox);
+    if (conn.inflight.empty()) return;
+    io_uring_sqe* sqe = uringEntry(ring);
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(conn.inflight.data());
+    sqe->len = static_cast<unsigned>(conn.inflight.size());
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = uringTag(URING_SEND, fd);
+    conn.sending = true;
+}
+
+/**
+ * @brief Closes a connection once neither a receive nor a send is in flight.
+ */
+static void uringMaybeClose(UringProactor* ring, int fd) {
+    auto it = ring->connections.find(fd);
+    if (it == ring->connections.end()) return;
+    UringConnection& conn = it->second;
+    if (!conn.closing || conn.receiving || conn.sending) return;
+    close(fd);
+    ring->connections.erase(it);
+}
+
+/**
+ * @brief Starts closing a connection: the receive ends with EOF, then the socket is closed.
+ */
+static void uringBeginClose(int fd, UringConnection& conn) {
+    if (conn.closing) return;
+    conn.closing = true;
+    conn.outbox.clear();
+    shutdown(fd, SHUT_RDWR); // Completes the armed receive and any blocked send
+}
+
+/**
+ * @brief Dispatches one completion.
+ */
+static void uringComplete(UringProactor* ring, const io_uring_cqe& cqe) {
+    UringOp op = static_cast<UringOp>(cqe.user_data >> 32);
+    int fd = static_cast<int>(cqe.user_data & 0xffffffffu);
+    bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+
+    switch (op) {
+    case URING_ACCEPT:
+        if (cqe.res == -EINVAL && ring->multishotAccept) {
+            ring->multishotAccept = false; // Kernel without multishot accept
+        } else if (cqe.res >= 0) {
+            if (ring->onAccept && !ring->onAccept(cqe.res)) {
+                close(cqe.res);
+            } else {
+                ring->connections[cqe.res] = UringConnection{};
+                uringArmRecv(ring, cqe.res);
+            }
+        }
+        if (!more && ring->running) uringArmAccept(ring);
+        break;
+
+    case URING_RECV: {
+        auto it = ring->connections.find(fd);
+        if (it == ring->connections.end()) break;
+        UringConnection& conn = it->second;
+        if (cqe.flags & IORING_CQE_F_BUFFER) {
+            unsigned bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+            if (cqe.res > 0 && !conn.closing) {
+                const char* data = ring->buffers.data() + static_cast<size_t>(bid) * URING_BUFFER_SIZE;
+                if (!ring->onRecv(ring, fd, data, static_cast<size_t>(cqe.res))) uringBeginClose(fd, conn);
+            }
+            uringProvideBuffers(ring, bid, 1);
+        }
+        if (more) break;
+        conn.receiving = false;
+        if (cqe.res == -EINVAL && ring->multishotRecv) {
+            ring->multishotRecv = false; // Kernel without multishot receive
+            uringArmRecv(ring, fd);
+        } else if (cqe.res > 0 || cqe.res == -ENOBUFS) {
+            uringArmRecv(ring, fd); // Multishot ended early or single-shot mode; keep reading until EOF
+        } else {
+            ring->onRecv(ring, fd, nullptr, 0); // Disconnected, failed or shut down by uringBeginClose
+            conn.closing = true;
+            if (cqe.res < 0) conn.outbox.clear(); // On EOF the peer may still read what was queued
+            uringMaybeClose(ring, fd);
+        }
+        break;
+    }
+
+    case URING_SEND: {
+        auto it = ring->connections.find(fd);
+        if (it == ring->connections.end()) break;
+        UringConnection& conn = it->second;
+        conn.sending = false;
+        if (cqe.res < 0) {
+            conn.inflight.clear();
+            uringBeginClose(fd, conn);
+        } else {
+            conn.inflight.erase(0, static_cast<size_t>(cqe.res));
+            uringFlush(ring, fd, conn); // Also drains what was queued before a closing EOF
+        }
+        uringMaybeClose(ring, fd);
+        break;
+    }
+
+    case URING_WAKE: {
+        std::vector<proactorTask> tasks;
+        {
+            std::lock_guard<std::mutex> guard(ring->postLock);
+            tasks.swap(ring->posted);
+        }
+        for (proactorTask& task : tasks) task(); // A task posted meanwhile re-signals the eventfd
+        if (ring->running) uringArmWake(ring);
+        break;
+    }
+
+    case URING_PROVIDE:
+        break;
+    }
+}
+
+/**
+ * @brief Proactor thread: submits requests and dispatches completions until stopped.
+ *
+ * @param arg Pointer to the UringProactor.
+ * @return Always returns nullptr.
+ */
+static void* uringLoop(void* arg) {
+    UringProactor* ring = static_cast<UringProactor*>(arg);
+    uringProvideBuffers(ring, 0, URING_BUFFER_COUNT);
+    uringArmWake(ring);
+    uringArmAccept(ring);
+    metrics_gauge_add(Gauge::ProactorThreads, 1);
+
+    while (ring->running) {
+        if (uringSubmit(ring, 1) != 0) {
+            perror("io_uring_enter failed");
+            break;
+        }
+        unsigned head = *ring->cqHead, completions = 0;
+        while (head != __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE)) {
+            io_uring_cqe cqe = ring->cqes[head & *ring->cqMask];
+            __atomic_store_n(ring->cqHead, ++head, __ATOMIC_RELEASE);
+            uringComplete(ring, cqe);
+            ++completions;
+        }
+        metrics_count(Counter::LoopIterations);
+        metrics_count(Counter::LoopReadyFds, completions);
+    }
+    metrics_gauge_add(Gauge::ProactorThreads, -1);
+    return nullptr;
+}
+
+/**
+ * @brief Sets up and maps the ring, then starts the proactor thread.
+ */
+void* startUringProactor(int listener, proactorAcceptFunc onAccept, proactorRecvFunc onRecv) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int ringFd = static_cast<int>(syscall(__NR_io_uring_setup, URING_ENTRIES, &params));
+    if (ringFd < 0) {
+        perror("io_uring_setup failed");
+        return nullptr;
+    }
+
+    UringProactor* ring = new UringProactor;
+    ring->ringFd = ringFd;
+    ring->sqEntries = params.sq_entries;
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap) ring->sqRingSize = ring->cqRingSize = std::max(ring->sqRingSize, ring->cqRingSize);
+    ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+    ring->sqRing = mmap(nullptr, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                        IORING_OFF_SQ_RING);
+    ring->cqRing = singleMap ? ring->sqRing
+                             : mmap(nullptr, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                    ringFd, IORING_OFF_CQ_RING);
+    void* sqes = mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd,
+                      IORING_OFF_SQES);
+    ring->wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (ring->sqRing == MAP_FAILED || ring->cqRing == MAP_FAILED || sqes == MAP_FAILED || ring->wakeFd < 0) {
+        perror("io_uring mapping failed");
+        if (sqes != MAP_FAILED) munmap(sqes, ring->sqesSize);
+        if (!singleMap && ring->cqRing != MAP_FAILED) munmap(ring->cqRing, ring->cqRingSize);
+        if (ring->sqRing != MAP_FAILED) munmap(ring->sqRing, ring->sqRingSize);
+        if (ring->wakeFd >= 0) close(ring->wakeFd);
+        close(ringFd);
+        delete ring;
+        return nullptr;
+    }
+
+    char* sq = static_cast<char*>(ring->sqRing);
+    char* cq = static_cast<char*>(ring->cqRing);
+    ring->sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    ring->sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring->sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring->sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    ring->sqes = static_cast<io_uring_sqe*>(sqes);
+    ring->cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring->cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring->cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    ring->localTail = *ring->sqTail;
+    ring->toSubmit = 0;
+
+    ring->listener = listener;
+    ring->wakeValue = 0;
+    ring->multishotAccept = IORING_ACCEPT_MULTISHOT != 0;
+    ring->multishotRecv = IORING_RECV_MULTISHOT != 0;
+    ring->onAccept = onAccept;
+    ring->onRecv = onRecv;
+    ring->buffers.resize(static_cast<size_t>(URING_BUFFER_COUNT) * URING_BUFFER_SIZE);
+    ring->running = true;
+
+    if (pthread_create(&ring->thread, nullptr, uringLoop, ring) != 0) {
+        std::cerr << "Failed to create io_uring proactor thread" << std::endl;
+        ring->running = false;
+        ring->thread = pthread_self();
+        stopUringProactor(ring);
+        return nullptr;
+    }
+    return ring;
+}
+
+/**
+ * @brief Appends output for a client and starts sending it if the socket is idle.
+ */
+int proactorSend(void* proactor, int sockfd, const char* data, size_t len) {
+    UringProactor* ring = static_cast<UringProactor*>(proactor);
+    auto it = ring->connections.find(sockfd);
+    if (it == ring->connections.end() || it->second.closing) return -1;
+    it->second.outbox.append(data, len);
+    uringFlush(ring, sockfd, it->second);
+    return 0;
+}
+
+/**
+ * @brief Sums the connection's queued and in-flight output.
+ */
+size_t proactorPending(void* proactor, int sockfd) {
+    UringProactor* ring = static_cast<UringProactor*>(proactor);
+    auto it = ring->connections.find(sockfd);
+    if (it == ring->connections.end()) return 0;
+    return it->second.outbox.size() + it->second.inflight.size();
+}
+
+/**
+ * @brief Queues a task for the proactor thread and signals its wake eventfd.
+ */
+int proactorPost(void* proactor, proactorTask task) {
+    UringProactor* ring = static_cast<UringProactor*>(proactor);
+    {
+        std::lock_guard<std::mutex> guard(ring->postLock);
+        ring->posted.push_back(std::move(task));
+    }
+    uint64_t one = 1;
+    return write(ring->wakeFd, &one, sizeof(one)) == sizeof(one) ? 0 : -1;
+}
+
+/**
+ * @brief Wakes and joins the proactor thread, then releases the ring and client sockets.
+ */
+int stopUringProactor(void* proactor) {
+    UringProactor* ring = static_cast<UringProactor*>(proactor);
+    int result = 0;
+    if (!pthread_equal(ring->thread, pthread_self())) {
+        ring->running = false;
+        uint64_t one = 1;
+        if (write(ring->wakeFd, &one, sizeof(one)) != sizeof(one) || pthread_join(ring->thread, nullptr) != 0)
+            result = -1;
+    }
+    close(ring->ringFd); // Cancels every request still in flight
+    for (auto& entry : ring->connections) close(entry.first);
+    munmap(ring->sqes, ring->sqesSize);
+    if (ring->cqRing != ring->sqRing) munmap(ring->cqRing, ring->cqRingSize);
+    munmap(ring->sqRing, ring->sqRingSize);
+    close(ring->wakeFd);
+    delete ring;
+    return result;
+}
+
+#else
+
+void* startUringProactor(int, proactorAcceptFunc, proactorRecvFunc) {
+    std::cerr << "io_uring is not available on this platform" << std::endl;
+    return nullptr;
+}
+
+int proactorSend(void*, int, const char*, size_t) {
+    return -1;
+}
+
+size_t proactorPending(void*, int) {
+    return 0;
+}
+
+int proactorPost(void*, proactorTask) {
+    return -1;
+}
+
+int stopUringProactor(void*) {
+    return -1;
+}
+
+#endif
@@ -0,0 +1,256 @@
+#include "../include/GeometryUtils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+/**
+ * @file
+ * @brief Benchmark harness for the vector (Stage 1), deque and list hull engines.
+ *
+ * For every engine, distribution and size (powers of ten from 10 up to
+ * --max-size) the harness repeats the hull computation until --min-time
+ * seconds have passed (at least three runs) and reports the median time per
+ * input point, heap allocations and bytes per run, the peak resident set of
+ * the case and the hull size. A peak marked with * could not be reset and is
+ * the peak of the whole process so far.
+ *
+ * Options:
+ * - --max-size N: largest input size (default 1000000, up to 100000000).
+ * - --min-time S: minimum measured time per case in seconds (default 0.2).
+ * - --engine NAME: only run one engine (vector, deque, deque-opt, deque-chan, list, list-pool).
+ *   deque-chan forces Chan's algorithm without the pre-filter. list-pool is
+ *   the list engine on NodePool nodes, which a warm run neither allocates nor frees.
+ * - --dist NAME: only run one distribution (square, disk, circle, gaussian, collinear, duplicate).
+ *
+ * Every engine must return a hull of the same size for the same input; a
+ * case where one does not is reported on stderr and makes the exit status 1.
+ */
+
+// === Allocation accounting ===
+
+static bool count_allocations = false; // True while a measured run is in progress
+static size_t allocation_count = 0;    // Number of operator new calls while counting
+static size_t allocation_bytes = 0;    // Bytes requested while counting
+
+void* operator new(std::size_t size) {
+    if (count_allocations) {
+        ++allocation_count;
+        allocation_bytes += size;
+    }
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+/**
+ * @brief Resets the kernel's peak RSS counter so each case is measured on its own.
+ *
+ * @return true if the reset is supported (Linux 4.0 and later).
+ */
+static bool reset_peak_rss() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    return clear_refs && (clear_refs << "5").flush();
+}
+
+/**
+ * @brief Returns the peak resident set size in MiB.
+ *
+ * Reads VmHWM, falling back to getrusage() where /proc is not available.
+ */
+static double peak_rss_mib() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::atof(line.c_str() + 6) / 1024.0;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+// === Input generation ===
+
+/**
+ * @brief Generates n points from a named distribution with a fixed seed.
+ *
+ * @param dist One of square, disk, circle, gaussian, collinear or duplicate.
+ * @param n Number of points.
+ * @return The generated points.
+ */
+static std::vector<Point> generate(const std::string& dist, size_t n) {
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<Point> points(n);
+    for (Point& p : points) {
+        if (dist == "square") {
+            p = Point{uniform(rng), uniform(rng)};
+        } else if (dist == "disk") {
+            do p = Point{uniform(rng), uniform(rng)}; while (p.x * p.x + p.y * p.y > 1);
+        } else if (dist == "circle") {
+            double angle = M_PI * uniform(rng);
+            p = Point{std::cos(angle), std::sin(angle)};
+        } else if (dist == "gaussian") {
+            p = Point{normal(rng), normal(rng)};
+        } else if (dist == "duplicate") {
+            p = Point{0.25, -0.5}; // Every point identical
+        } else {
+            double t = std::ldexp(double(rng() % (1u << 20)), -10); // Exact, so the points stay collinear
+            p = Point{t, 0.5 * t + 1.0};
+        }
+    }
+    return points;
+}
+
+// === Engines ===
+
+/**
+ * @struct Engine
+ * @brief One hull implementation under test.
+ *
+ * prepare() builds the engine's input container outside the timed region;
+ * run() moves it into the engine and returns the hull size.
+ */
+struct Engine {
+    const char* name;
+    void (*prepare)(const std::vector<Point>& input);
+    size_t (*run)();
+};
+
+static std::vector<Point> vector_input;
+static std::deque<Point> deque_input;
+static std::list<Point> list_input;
+static PooledPointList pooled_list_input;
+
+static void prepare_vector(const std::vector<Point>& input) { vector_input = input; }
+static void prepare_deque(const std::vector<Point>& input) { deque_input.assign(input.begin(), input.end()); }
+static void prepare_list(const std::vector<Point>& input) { list_input.assign(input.begin(), input.end()); }
+static void prepare_pooled_list(const std::vector<Point>& input) { pooled_list_input.assign(input.begin(), input.end()); }
+
+static size_t run_vector() { return compute_convex_hull_vector(std::move(vector_input)).size(); }
+static size_t run_deque() { return compute_convex_hull_deque(std::move(deque_input)).size(); }
+static size_t run_list() { return compute_convex_hull_list(std::move(list_input)).size(); }
+static size_t run_pooled_list() { return compute_convex_hull_list(std::move(pooled_list_input)).size(); }
+
+static size_t run_deque_opt() {
+    HullOptions options; // Pre-filter and automatic engine choice, one thread
+    return compute_convex_hull_deque(std::move(deque_input), options).size();
+}
+
+static size_t run_deque_chan() {
+    HullOptions options;
+    options.prefilter = false;
+    options.engine = HullEngine::Chan;
+    return compute_convex_hull_deque(std::move(deque_input), options).size();
+}
+
+static const Engine ENGINES[] = {
+    {"vector", prepare_vector, run_vector},
+    {"deque", prepare_deque, run_deque},
+    {"deque-opt", prepare_deque, run_deque_opt},
+    {"deque-chan", prepare_deque, run_deque_chan},
+    {"list", prepare_list, run_list},
+    {"list-pool", prepare_pooled_list, run_pooled_list},
+};
+
+static const char* DISTRIBUTIONS[] = {"square", "disk", "circle", "gaussian", "collinear", "duplicate"};
+
+/**
+ * @brief Runs one engine on one input until min_time has passed and prints a result row.
+ *
+ * @return The size of the hull the engine returned.
+ */
+static size_t bench_case(const Engine& engine, const char* dist, const std::vector<Point>& input,
+                       double min_time) {
+    std::vector<double> samples;
+    size_t hull_size = 0, allocs = 0, bytes = 0;
+    double total = 0;
+    bool rss_reset = reset_peak_rss();
+    while (samples.size() < 3 || (total < min_time && samples.size() < 100000)) {
+        engine.prepare(input);
+        allocation_count = allocation_bytes = 0;
+        count_allocations = true;
+        auto start = std::chrono::steady_clock::now();
+        hull_size = engine.run();
+        auto end = std::chrono::steady_clock::now();
+        count_allocations = false;
+        allocs = allocation_count;
+        bytes = allocation_bytes;
+        double seconds = std::chrono::duration<double>(end - start).count();
+        samples.push_back(seconds);
+        total += seconds;
+    }
+    std::sort(samples.begin(), samples.end());
+    double median = samples[samples.size() / 2];
+    std::printf("%-10s %-10s %10zu %7zu %12.2f %10zu %14zu %10.1f%s %8zu\n", engine.name, dist, input.size(),
+                samples.size(), median * 1e9 / input.size(), allocs, bytes, peak_rss_mib(), rss_reset ? " " : "*",
+                hull_size);
+    std::fflush(stdout);
+    return hull_size;
+}
+
+/**
+ * @brief Parses the options, then benchmarks every selected engine, distribution and size.
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments (see the options above).
+ * @return 0 on success, 1 on invalid arguments or if the engines disagree.
+ */
+int main(int argc, char* argv[]) {
+    size_t max_size = 1000000;
+    double min_time = 0.2;
+    std::string only_engine, only_dist;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            max_size = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            min_time = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            only_engine = argv[++i];
+        } else if (std::strcmp(argv[i], "--dist") == 0 && i + 1 < argc) {
+            only_dist = argv[++i];
+        } else {
+            std::fprintf(stderr, "Usage: %s [--max-size N] [--min-time S] [--engine NAME] [--dist NAME]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::printf("%-10s %-10s %10s %7s %12s %10s %14s %11s %8s\n", "engine", "dist", "n", "runs", "ns/point",
+                "allocs", "bytes", "peakMiB", "hull");
+    bool agree = true;
+    for (const char* dist : DISTRIBUTIONS) {
+        if (!only_dist.empty() && only_dist != dist) continue;
+        for (size_t n = 10; n <= max_size; n *= 10) {
+            std::vector<Point> input = generate(dist, n);
+            const Engine* reference = nullptr; // First engine run on this input
+            size_t reference_hull = 0;
+            for (const Engine& engine : ENGINES) {
+                if (!only_engine.empty() && only_engine != engine.name) continue;
+                size_t hull = bench_case(engine, dist, input, min_time);
+                if (!reference) {
+                    reference = &engine;
+                    reference_hull = hull;
+                } else if (hull != reference_hull) {
+                    std::fprintf(stderr, "MISMATCH %s %s n=%zu: %zu hull points, %s returned %zu\n", engine.name, dist,
+                                 n, hull, reference->name, reference_hull);
+                    agree = false;
+                }
+            }
+        }
+    }
+    return agree ? 0 : 1;
+}
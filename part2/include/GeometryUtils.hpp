@@ -1,6 +1,9 @@
 #pragma once
+#include <cstddef>
 #include <deque>
 #include <list>
+#include <new>
+#include <vector>
 
 /**
  * @brief Struct representing a 2D point with x and y coordinates.
@@ -16,7 +19,9 @@ struct Point {
      * @param other The point to compare against.
      * @return true if this point is less than the other, false otherwise.
      */
-    bool operator<(const Point& other) const;
+    bool operator<(const Point& other) const {
+        return x < other.x || (x == other.x && y < other.y);
+    }
 };
 
 /**
@@ -29,16 +34,286 @@ struct Point {
  */
 std::deque<Point> compute_convex_hull_deque(std::deque<Point> points);
 
+/**
+ * @brief Computes the convex hull of a set of 2D points using a std::vector.
+ *
+ * The Stage 1 engine (part1's compute_convex_hull() on doubles), built from
+ * this part's own Point so the benchmark can run it next to the deque and
+ * list engines.
+ * 
+ * @param points A vector of input points.
+ * @return A vector of points forming the convex hull in counter-clockwise order.
+ */
+std::vector<Point> compute_convex_hull_vector(std::vector<Point> points);
+
+/**
+ * @brief Inputs smaller than this are always processed on a single thread.
+ */
+const size_t PARALLEL_HULL_THRESHOLD = 100000;
+
+/**
+ * @brief Fewest points a parallel hull hands each thread; fewer threads are used otherwise.
+ */
+const size_t PARALLEL_MIN_CHUNK = 16384;
+
+/**
+ * @brief Inputs smaller than this skip the interior-point pre-filter.
+ */
+const size_t PREFILTER_THRESHOLD = 1000;
+
+/**
+ * @brief Inputs smaller than this are sorted with std::sort instead of a radix sort.
+ */
+const size_t RADIX_SORT_THRESHOLD = 4096;
+
+/**
+ * @brief Inputs smaller than this always use the Monotone Chain engine under HullEngine::Auto.
+ */
+const size_t CHAN_THRESHOLD = 50000;
+
+/**
+ * @enum HullEngine
+ * @brief Algorithm used by compute_convex_hull_deque() to build the hull.
+ */
+enum class HullEngine {
+    MonotoneChain, // Sort everything, then scan: O(n log n)
+    Chan,          // Chan's output-sensitive algorithm: O(n log h)
+    Auto           // Chan when a sample predicts a small hull, Monotone Chain otherwise
+};
+
+/**
+ * @struct HullOptions
+ * @brief Runtime settings for compute_convex_hull_deque().
+ */
+struct HullOptions {
+    unsigned threads = 1;   // Worker threads; 0 uses every hardware thread
+    bool prefilter = true;  // Drop points inside the Akl-Toussaint octagon before sorting
+    HullEngine engine = HullEngine::Auto; // Hull algorithm; threads only apply to Monotone Chain
+};
+
+/**
+ * @brief Computes the convex hull of a set of 2D points using a std::deque, with the given options.
+ *
+ * With more than one thread and at least PARALLEL_HULL_THRESHOLD points, the points
+ * are sorted in parallel chunks, each chunk builds its own lower and upper chains,
+ * and a final Monotone Chain pass over the chunk chains merges them. Otherwise it
+ * falls back to the serial algorithm. With prefilter enabled, points strictly
+ * inside the octagon of the eight extreme points are discarded first, so only
+ * candidates that may lie on the hull are sorted. The engine option switches to
+ * Chan's O(n log h) algorithm, which wins when the hull has few vertices.
+ * The result is identical in all cases.
+ *
+ * @param points A deque of input points.
+ * @param options Engine, thread count and other settings.
+ * @return A deque of points forming the convex hull in counter-clockwise order.
+ */
+std::deque<Point> compute_convex_hull_deque(std::deque<Point> points, const HullOptions& options);
+
+/**
+ * @struct PointColumns
+ * @brief Read-only view of points stored as x and y coordinate arrays.
+ *
+ * Point i is (x[i * stride], y[i * stride]): separate columns have stride 1,
+ * interleaved x,y pairs have stride 2 with y == x + 1. Used to run the hull on
+ * memory-mapped point files without copying them first.
+ */
+struct PointColumns {
+    const double* x; // First x coordinate
+    const double* y; // First y coordinate
+    size_t stride;   // Distance in doubles between consecutive points
+    size_t count;    // Number of points
+
+    size_t size() const { return count; }
+    Point operator[](size_t i) const { return Point{x[i * stride], y[i * stride]}; }
+};
+
+/**
+ * @brief Computes the convex hull of read-only point columns with std::deque output.
+ *
+ * Only the points that survive the prefilter are copied out of the columns,
+ * so a memory-mapped input is never duplicated as a whole. Same result as
+ * the deque overload.
+ *
+ * Coordinates are checked for NaN and infinity in the same pass, block by
+ * block as the prefilter reads them, since those values would break the
+ * sort order.
+ *
+ * @param points The input points.
+ * @param options Engine, thread count and other settings.
+ * @param hull Receives the points of the convex hull in counter-clockwise order.
+ * @return false if a coordinate is NaN or infinite; hull is then left empty.
+ */
+bool compute_convex_hull_deque(const PointColumns& points, const HullOptions& options, std::deque<Point>& hull);
+
+/**
+ * @brief Default number of points StreamingHullDeque buffers before each merge.
+ */
+const size_t STREAM_CHUNK_SIZE = 1 << 20;
+
+/**
+ * @class StreamingHullDeque
+ * @brief Convex hull of a point stream too large to hold in memory.
+ *
+ * Points are buffered in fixed-size chunks. Each full chunk is merged into
+ * the running hull by taking the hull of both together with
+ * compute_convex_hull_deque(), which is the hull of everything seen so far
+ * since hull(A + B) = hull(hull(A) + B). Memory stays O(chunk + h) however
+ * long the stream is.
+ */
+class StreamingHullDeque {
+public:
+    /**
+     * @brief Creates an empty stream.
+     *
+     * @param chunk_size Points buffered per merge (at least 1).
+     * @param options Settings used for every merge.
+     */
+    explicit StreamingHullDeque(size_t chunk_size = STREAM_CHUNK_SIZE, const HullOptions& options = HullOptions());
+
+    /**
+     * @brief Adds one point, merging the chunk once it is full.
+     *
+     * @param p The point to add.
+     */
+    void add(const Point& p);
+
+    /**
+     * @brief Adds every point of a column view, e.g. a mapped point file.
+     *
+     * @param points The points to add.
+     * @return false if a coordinate is NaN or infinite; the points before it were added.
+     */
+    bool add(const PointColumns& points);
+
+    /**
+     * @brief Merges the buffered points and returns the hull of everything added.
+     *
+     * @return The hull in counter-clockwise order, valid until the next add().
+     */
+    const std::deque<Point>& hull();
+
+    /**
+     * @brief Number of points added so far.
+     */
+    unsigned long long count() const;
+
+private:
+    /**
+     * @brief Replaces the running hull with the hull of itself and the buffer.
+     */
+    void merge();
+
+    HullOptions options;          // Settings for each merge
+    size_t chunk_size;            // Buffer size that triggers a merge
+    std::deque<Point> buffer;     // Points added since the last merge
+    std::deque<Point> current;    // Hull of every point merged so far
+    unsigned long long added;     // Points added so far
+};
+
+/**
+ * @brief Nodes NodePool carves out of each block it requests from the heap.
+ */
+const size_t NODE_POOL_BLOCK = 4096;
+
+/**
+ * @brief Largest node size NodePool serves; bigger requests go to operator new.
+ */
+const size_t NODE_POOL_MAX_SIZE = 64;
+
+/**
+ * @class NodePool
+ * @brief Per-thread free lists of fixed-size nodes, one per 16-byte size class.
+ *
+ * Nodes are cut from NODE_POOL_BLOCK-node blocks, and freed nodes go back on
+ * the thread's free list instead of to the heap, so once a thread's pool has
+ * grown to its working size, allocating and freeing list nodes never calls
+ * new or delete. Whenever all of a thread's nodes of a class are free, the
+ * class starts over at the front of its first block, so a list built then
+ * has its nodes adjacent in memory, in list order, however scattered the
+ * previous ones were. The blocks are kept for the life of the process.
+ *
+ * Not shared between threads: a node must be freed on the thread that
+ * allocated it.
+ */
+class NodePool {
+public:
+    /**
+     * @brief Returns a node of at least size bytes, aligned like a double or a pointer.
+     *
+     * @param size Node size, at most NODE_POOL_MAX_SIZE.
+     */
+    static void* allocate(size_t size);
+
+    /**
+     * @brief Puts a node back on the calling thread's free list.
+     *
+     * @param node A node from allocate() with the same size.
+     * @param size The size it was allocated with.
+     */
+    static void deallocate(void* node, size_t size);
+};
+
+/**
+ * @class PoolAllocator
+ * @brief Stateless allocator that takes single list nodes from NodePool.
+ *
+ * All instances compare equal, so pooled lists splice into each other freely.
+ */
+template <class T>
+class PoolAllocator {
+public:
+    typedef T value_type;
+
+    PoolAllocator() {}
+    template <class U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        if (n == 1 && sizeof(T) <= NODE_POOL_MAX_SIZE) return static_cast<T*>(NodePool::allocate(sizeof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        if (n == 1 && sizeof(T) <= NODE_POOL_MAX_SIZE) NodePool::deallocate(p, sizeof(T));
+        else ::operator delete(p);
+    }
+};
+
+template <class T, class U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) { return true; }
+
+template <class T, class U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) { return false; }
+
+/**
+ * @brief A std::list whose nodes come from NodePool.
+ */
+typedef std::list<Point, PoolAllocator<Point> > PooledPointList;
+
 /**
  * @brief Computes the convex hull of a set of 2D points using a std::list.
  *
- * Converts the list to a sorted vector internally, then builds the hull.
+ * Sorts the points in place through a per-thread buffer that is reused
+ * across calls, then builds the lower and upper chains by splicing the
+ * input's own nodes between lists: the returned hull is made of input nodes
+ * and the rest are freed on return. No node is allocated.
  * 
  * @param points A list of input points.
  * @return A list of points forming the convex hull in counter-clockwise order.
  */
 std::list<Point> compute_convex_hull_list(std::list<Point> points);
 
+/**
+ * @brief Computes the convex hull of a node-pooled list; same algorithm as the std::list overload.
+ *
+ * With the nodes drawn from and returned to NodePool, a warm run makes no
+ * heap calls at all.
+ *
+ * @param points A pooled list of input points.
+ * @return A pooled list of points forming the convex hull in counter-clockwise order.
+ */
+PooledPointList compute_convex_hull_list(PooledPointList points);
+
 /**
  * @brief Calculates the area of a polygon represented as a list of points.
  *
@@ -49,6 +324,14 @@ std::list<Point> compute_convex_hull_list(std::list<Point> points);
  */
 double compute_area(const std::list<Point>& polygon);
 
+/**
+ * @brief Calculates the area of a polygon represented as a pooled list of points.
+ *
+ * @param polygon A pooled list of ordered points forming a simple polygon.
+ * @return The absolute area of the polygon.
+ */
+double compute_area(const PooledPointList& polygon);
+
 /**
  * @brief Calculates the area of a polygon represented as a deque of points.
  *
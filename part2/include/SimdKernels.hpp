@@ -0,0 +1,51 @@
+#pragma once
+#include "GeometryUtils.hpp"
+#include <cstddef>
+
+/**
+ * @file
+ * @brief Batched geometry kernels over structure-of-arrays coordinate buffers.
+ *
+ * Each kernel has AVX2 (x86-64) and NEON (AArch64) versions plus a scalar
+ * fallback. The best version supported by the running CPU is chosen once at
+ * first use, so the same binary runs on every host. Results are bit-identical
+ * across versions. Building with -DHULL_NO_SIMD keeps only the scalar kernels.
+ */
+
+/**
+ * @brief Number of points the callers gather into one SoA block.
+ */
+const size_t SIMD_BLOCK = 1024;
+
+/**
+ * @brief Tests which points lie strictly inside a convex polygon.
+ *
+ * A point is inside when cross(polygon[k], polygon[k + 1], p) > 0 for every
+ * edge, with the same rounding as the scalar cross product.
+ *
+ * @param x X coordinates of the points.
+ * @param y Y coordinates of the points.
+ * @param n Number of points.
+ * @param polygon Vertices of the polygon in counter-clockwise order.
+ * @param m Number of polygon vertices.
+ * @param inside Receives 1 for points strictly inside, 0 otherwise.
+ */
+void classify_inside(const double* x, const double* y, size_t n, const Point* polygon, int m,
+                     unsigned char* inside);
+
+/**
+ * @brief Sums the shoelace terms x[i] * y[i + 1] - x[i + 1] * y[i] for i < n.
+ *
+ * @param x X coordinates; n + 1 entries are read.
+ * @param y Y coordinates; n + 1 entries are read.
+ * @param n Number of terms.
+ * @return Twice the signed area contribution of the n edges.
+ */
+double shoelace_sum(const double* x, const double* y, size_t n);
+
+/**
+ * @brief Names the kernel set selected for this CPU.
+ *
+ * @return "avx2", "neon" or "scalar".
+ */
+const char* simd_kernel_name();
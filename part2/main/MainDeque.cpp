@@ -1,9 +1,13 @@
 #include "../include/GeometryUtils.hpp"
+#include "../include/PointFile.hpp"
 #include <iostream>
 #include <string>
 #include <sstream>
 #include <deque>
 #include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
 
 /**
  * @file
@@ -21,6 +25,17 @@
  * Output:
  * - Area of the convex hull.
  * - Time in milliseconds taken to compute the convex hull.
+ *
+ * Options:
+ * - -j N: compute the hull with N threads (0 = all hardware threads). Inputs below
+ *   PARALLEL_HULL_THRESHOLD points are always processed serially.
+ * - --no-prefilter: sort every point instead of discarding interior ones first.
+ * - --engine chain|chan|auto: force Monotone Chain or Chan's algorithm (default auto).
+ * - --input FILE: map a binary point file (written by part1's ConvertPoints)
+ *   instead of reading text from stdin. The hull is computed on the mapped data.
+ * - --stream N: merge the points into a running hull every N points
+ *   (StreamingHullDeque), so memory stays O(N + h) for inputs larger than
+ *   RAM. The merges run while the input is read, so the time includes reading.
  */
 
 /**
@@ -35,17 +50,103 @@ bool is_number(const std::string& s) {
     return (iss >> d) && iss.eof();
 }
 
+/**
+ * @brief Parses a string of decimal digits as an unsigned integer.
+ * 
+ * @param s The input string to parse.
+ * @param max Largest accepted value.
+ * @param value Receives the number.
+ * @return true if s is only digits and its value is at most max.
+ */
+bool parse_unsigned(const std::string& s, unsigned long long max, unsigned long long& value) {
+    if (s.empty() || s.size() > 19) return false; // 19 digits cannot overflow
+    value = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + static_cast<unsigned long long>(c - '0');
+    }
+    return value <= max;
+}
+
 /**
  * @brief Main function to read points, compute convex hull, and display results.
  * 
  * Reads input from stdin, collects N valid points, computes the convex hull using a deque-based method,
  * calculates the area of the hull, measures computation time, and prints both the area and duration.
  * 
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments (see the options above).
  * @return 0 on success, 1 on failure due to invalid or missing input.
  */
-int main() {
+int main(int argc, char* argv[]) {
+    HullOptions options;
+    const char* input_path = nullptr;
+    size_t stream_chunk = 0; // 0 keeps every point in memory
+    unsigned long long number; // Value of a numeric option
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc && parse_unsigned(argv[i + 1], UINT_MAX, number)) {
+            options.threads = static_cast<unsigned>(number); // Clamped to the cores by the hull
+            ++i;
+        } else if (std::strcmp(argv[i], "--no-prefilter") == 0) {
+            options.prefilter = false;
+        } else if (std::strcmp(argv[i], "--engine") == 0 && i + 1 < argc &&
+                   (std::strcmp(argv[i + 1], "chain") == 0 || std::strcmp(argv[i + 1], "chan") == 0 ||
+                    std::strcmp(argv[i + 1], "auto") == 0)) {
+            ++i;
+            if (std::strcmp(argv[i], "chain") == 0) options.engine = HullEngine::MonotoneChain;
+            else if (std::strcmp(argv[i], "chan") == 0) options.engine = HullEngine::Chan;
+            else options.engine = HullEngine::Auto;
+        } else if (std::strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            input_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--stream") == 0 && i + 1 < argc &&
+                   parse_unsigned(argv[i + 1], SIZE_MAX, number) && number > 0) {
+            stream_chunk = static_cast<size_t>(number);
+            ++i;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [-j threads] [--no-prefilter] [--engine chain|chan|auto]"
+                      << " [--input points.bin] [--stream N]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (input_path) {
+        MappedPointFile file;
+        std::string error;
+        if (!map_point_file(input_path, file, error)) {
+            std::cerr << "ERROR: " << error << std::endl;
+            return 1;
+        }
+        if (file.points.size() == 0) {
+            std::cerr << "ERROR: Missing number of points." << std::endl;
+            unmap_point_file(file);
+            return 1;
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        std::deque<Point> hull;
+        bool finite; // Checked while the hull reads the mapping
+        if (stream_chunk) {
+            StreamingHullDeque stream(stream_chunk, options);
+            finite = stream.add(file.points);
+            if (finite) hull = stream.hull();
+        } else {
+            finite = compute_convex_hull_deque(file.points, options, hull);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        unmap_point_file(file);
+        if (!finite) {
+            std::cerr << "ERROR: " << input_path << ": holds a NaN or infinite coordinate" << std::endl;
+            return 1;
+        }
+
+        std::cout << "Area: " << compute_area(hull) << std::endl;
+        std::cout << "Time (deque): "
+                  << std::chrono::duration<double, std::milli>(end - start).count()
+                  << " ms" << std::endl;
+        return 0;
+    }
+
     std::string line;
-    int n = 0;
+    long long n = 0;
 
     // Read number of points
     while (true) {
@@ -60,9 +161,12 @@ int main() {
     }
 
     std::deque<Point> points;
+    StreamingHullDeque stream(stream_chunk ? stream_chunk : STREAM_CHUNK_SIZE, options); // Used with --stream
+    long long collected = 0;
+    auto start = std::chrono::high_resolution_clock::now();
 
     // Read exactly n valid points
-    while ((int)points.size() < n) {
+    while (collected < n) {
         if (!std::getline(std::cin, line)) {
             std::cerr << "ERROR: Unexpected end of input." << std::endl;
             return 1;
@@ -85,11 +189,13 @@ int main() {
         }
 
         Point p{std::stod(x_str), std::stod(y_str)};
-        points.push_back(p);
+        if (stream_chunk) stream.add(p);
+        else points.push_back(p);
+        ++collected;
     }
 
-    auto start = std::chrono::high_resolution_clock::now();
-    auto hull = compute_convex_hull_deque(points);
+    if (!stream_chunk) start = std::chrono::high_resolution_clock::now();
+    std::deque<Point> hull = stream_chunk ? stream.hull() : compute_convex_hull_deque(points, options);
     auto end = std::chrono::high_resolution_clock::now();
 
     double area = compute_area(hull);
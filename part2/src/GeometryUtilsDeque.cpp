@@ -1,18 +1,11 @@
 #include "../include/GeometryUtils.hpp"
+#include "../include/SimdKernels.hpp"
 #include <algorithm>
 #include <cmath>
-
-/**
- * @brief Lexicographic comparison operator for sorting points.
- *
- * Compares points first by x, then by y if x values are equal.
- * 
- * @param other The point to compare against.
- * @return true if this point is less than the other, false otherwise.
- */
-bool Point::operator<(const Point& other) const {
-    return x < other.x || (x == other.x && y < other.y);
-}
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
 
 /**
  * @brief Computes the cross product of vectors OA and OB.
@@ -26,19 +19,89 @@ static double cross(const Point& O, const Point& A, const Point& B) {
     return (A.x - O.x) * (B.y - O.y) - (A.y - O.y) * (B.x - O.x);
 }
 
+#define SIGN_BIT (uint64_t(1) << 63)
+#define RADIX_LEAF_SIZE 64 // Buckets smaller than this are finished with std::sort
+
 /**
- * @brief Computes the convex hull using the Monotone Chain algorithm with std::deque.
+ * @brief Maps a finite double to an unsigned key with the same order.
  *
- * Builds the upper and lower hulls by maintaining a deque and removing non-convex points.
- * 
- * @param points The input deque of 2D points.
+ * Positive values get the sign bit set and negative values have every bit
+ * flipped, so larger magnitudes of negatives sort first. -0.0 gets the key
+ * of +0.0, as operator< treats them as equal.
+ */
+static uint64_t radix_key(double value) {
+    value += 0.0; // -0.0 becomes +0.0
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & SIGN_BIT) ? ~bits : bits | SIGN_BIT;
+}
+
+/**
+ * @brief Sorts points lexicographically with an MSD radix sort on the x key.
+ *
+ * Each level distributes the points by one byte of radix_key(x), from the
+ * highest, into the same range of the other buffer and recurses into every
+ * bucket. A byte shared by every point, such as an exponent byte of
+ * coordinates from a narrow range, costs one counting read and no move.
+ * Buckets below RADIX_LEAF_SIZE points, and points with equal x, are finished
+ * with std::sort, which also orders them by y.
+ *
+ * @param data The points to sort.
+ * @param other The same range in the other buffer.
+ * @param n Number of points.
+ * @param shift Position of the byte to distribute by; below 0 once x is exhausted.
+ * @param in_scratch True when data is the scratch buffer, so the sorted
+ *                   points must be copied to other.
+ */
+static void radix_sort(Point* data, Point* other, size_t n, int shift, bool in_scratch) {
+    if (n < RADIX_LEAF_SIZE || shift < 0) {
+        std::sort(data, data + n);
+        if (in_scratch) std::copy(data, data + n, other);
+        return;
+    }
+
+    size_t offsets[257] = {0};
+    for (size_t i = 0; i < n; ++i) ++offsets[((radix_key(data[i].x) >> shift) & 0xff) + 1];
+    if (offsets[((radix_key(data[0].x) >> shift) & 0xff) + 1] == n) {
+        radix_sort(data, other, n, shift - 8, in_scratch);
+        return;
+    }
+    for (unsigned digit = 1; digit <= 256; ++digit) offsets[digit] += offsets[digit - 1];
+
+    size_t next[256];
+    std::copy(offsets, offsets + 256, next);
+    for (size_t i = 0; i < n; ++i) other[next[(radix_key(data[i].x) >> shift) & 0xff]++] = data[i];
+    for (unsigned digit = 0; digit < 256; ++digit) {
+        size_t first = offsets[digit], count = offsets[digit + 1] - first;
+        if (count > 0) radix_sort(other + first, data + first, count, shift - 8, !in_scratch);
+    }
+}
+
+/**
+ * @brief Sorts points lexicographically, by radix from RADIX_SORT_THRESHOLD points on.
+ *
+ * @param first Start of the points to sort.
+ * @param last End of the points to sort.
+ */
+static void sort_points(Point* first, Point* last) {
+    size_t n = static_cast<size_t>(last - first);
+    if (n < RADIX_SORT_THRESHOLD) {
+        std::sort(first, last);
+        return;
+    }
+    std::vector<Point> scratch(n);
+    radix_sort(first, scratch.data(), n, 56, false);
+}
+
+/**
+ * @brief Runs the Monotone Chain over sorted points.
+ *
+ * @param points The points, sorted lexicographically.
  * @return A deque of points forming the convex hull in counter-clockwise order.
  */
-std::deque<Point> compute_convex_hull_deque(std::deque<Point> points) {
+template <typename Points>
+static std::deque<Point> monotone_chain(const Points& points) {
     size_t n = points.size();
-    if (n <= 1) return points;
-
-    std::sort(points.begin(), points.end());
     std::deque<Point> hull;
 
     for (size_t i = 0; i < n; ++i) {
@@ -59,6 +122,420 @@ std::deque<Point> compute_convex_hull_deque(std::deque<Point> points) {
     return hull;
 }
 
+/**
+ * @brief Computes the convex hull using the Monotone Chain algorithm with std::deque.
+ *
+ * Builds the upper and lower hulls by maintaining a deque and removing non-convex points.
+ * From RADIX_SORT_THRESHOLD points on, the points are radix sorted in a
+ * contiguous copy instead of with std::sort on the deque.
+ * 
+ * @param points The input deque of 2D points.
+ * @return A deque of points forming the convex hull in counter-clockwise order.
+ */
+std::deque<Point> compute_convex_hull_deque(std::deque<Point> points) {
+    size_t n = points.size();
+    if (n <= 1) return points;
+
+    if (n < RADIX_SORT_THRESHOLD) {
+        std::sort(points.begin(), points.end());
+        return monotone_chain(points);
+    }
+    std::vector<Point> sorted(points.begin(), points.end());
+    sort_points(sorted.data(), sorted.data() + n);
+    return monotone_chain(sorted);
+}
+
+/**
+ * @brief Finds the Akl-Toussaint octagon of a point set.
+ *
+ * The octagon joins the extreme points in the x, y, x + y and x - y directions.
+ * It lies inside the convex hull, so no point strictly inside it can be a hull
+ * vertex.
+ *
+ * @param points A non-empty indexable point range (size() and operator[]).
+ * @param octagon Receives the distinct extremes in counter-clockwise order.
+ * @return The number of octagon vertices; below 3 if it is degenerate.
+ */
+template <typename Points>
+static int find_octagon(const Points& points, Point octagon[8]) {
+    // Extremes in counter-clockwise order of direction: E, NE, N, NW, W, SW, S, SE
+    Point ext[8];
+    for (int k = 0; k < 8; ++k) ext[k] = points[0];
+    for (size_t i = 1, n = points.size(); i < n; ++i) {
+        Point p = points[i];
+        if (p.x > ext[0].x) ext[0] = p;
+        if (p.x + p.y > ext[1].x + ext[1].y) ext[1] = p;
+        if (p.y > ext[2].y) ext[2] = p;
+        if (p.y - p.x > ext[3].y - ext[3].x) ext[3] = p;
+        if (p.x < ext[4].x) ext[4] = p;
+        if (p.x + p.y < ext[5].x + ext[5].y) ext[5] = p;
+        if (p.y < ext[6].y) ext[6] = p;
+        if (p.x - p.y > ext[7].x - ext[7].y) ext[7] = p;
+    }
+
+    int m = 0;
+    for (int k = 0; k < 8; ++k) {
+        if (m > 0 && octagon[m - 1].x == ext[k].x && octagon[m - 1].y == ext[k].y) continue;
+        octagon[m++] = ext[k];
+    }
+    while (m > 1 && octagon[m - 1].x == octagon[0].x && octagon[m - 1].y == octagon[0].y) --m;
+    return m;
+}
+
+/**
+ * @brief Discards points strictly inside the Akl-Toussaint octagon.
+ *
+ * Removing those points does not change the hull (see find_octagon()).
+ *
+ * @param points The points to filter, in place. The relative order of survivors is kept.
+ */
+template <typename Container>
+static void discard_interior_points(Container& points) {
+    if (points.size() < PREFILTER_THRESHOLD) return;
+
+    Point octagon[8];
+    int m = find_octagon(points, octagon);
+    if (m < 3) return;
+
+    // Classify in SoA blocks so the orientation tests run on vector lanes
+    double x[SIMD_BLOCK], y[SIMD_BLOCK];
+    unsigned char inside[SIMD_BLOCK];
+    size_t n = points.size(), kept = 0;
+    for (size_t first = 0; first < n; first += SIMD_BLOCK) {
+        size_t len = std::min(SIMD_BLOCK, n - first);
+        for (size_t i = 0; i < len; ++i) {
+            x[i] = points[first + i].x;
+            y[i] = points[first + i].y;
+        }
+        classify_inside(x, y, len, octagon, m, inside);
+        for (size_t i = 0; i < len; ++i)
+            if (!inside[i]) points[kept++] = points[first + i];
+    }
+    points.resize(kept);
+}
+
+/**
+ * @brief Copies the points of read-only columns that may lie on the hull.
+ *
+ * Applies the same octagon filter as discard_interior_points(), reading the
+ * columns in place: column data (stride 1) goes to classify_inside() without
+ * being gathered, so only the surviving candidates are ever copied.
+ *
+ * Every coordinate is checked for NaN and infinity while its block is in
+ * cache: x - x is 0 for a finite x and NaN otherwise, so one running sum
+ * flags them without a branch or a separate pass.
+ * 
+ * @param points The input columns.
+ * @param prefilter false to copy every point.
+ * @param out Receives the candidates in input order.
+ * @return false if a coordinate is NaN or infinite.
+ */
+template <typename Container>
+static bool copy_hull_candidates(const PointColumns& points, bool prefilter, Container& out) {
+    size_t n = points.size();
+    Point octagon[8];
+    int m = 0;
+    double check = 0; // Stays 0 while every coordinate is finite
+    if (prefilter && n >= PREFILTER_THRESHOLD) m = find_octagon(points, octagon);
+    if (m < 3) {
+        for (size_t i = 0; i < n; ++i) {
+            Point p = points[i];
+            check += (p.x - p.x) + (p.y - p.y);
+            out.push_back(p);
+        }
+        return check == 0;
+    }
+
+    double x[SIMD_BLOCK], y[SIMD_BLOCK];
+    unsigned char inside[SIMD_BLOCK];
+    for (size_t first = 0; first < n; first += SIMD_BLOCK) {
+        size_t len = std::min(SIMD_BLOCK, n - first);
+        const double* bx = points.x + first;
+        const double* by = points.y + first;
+        if (points.stride != 1) { // Interleaved pairs: gather one SoA block
+            for (size_t i = 0; i < len; ++i) {
+                x[i] = points.x[(first + i) * points.stride];
+                y[i] = points.y[(first + i) * points.stride];
+            }
+            bx = x;
+            by = y;
+        }
+        for (size_t i = 0; i < len; ++i) check += (bx[i] - bx[i]) + (by[i] - by[i]);
+        classify_inside(bx, by, len, octagon, m, inside);
+        for (size_t i = 0; i < len; ++i)
+            if (!inside[i]) out.push_back(Point{bx[i], by[i]});
+    }
+    return check == 0;
+}
+
+/**
+ * @brief Builds one strictly convex monotone chain over a sorted range of points.
+ *
+ * @param first Start of the sorted range.
+ * @param last End of the sorted range.
+ * @param side -1 for the lower chain, 1 for the upper chain (both left to right).
+ * @param chain Output vector receiving the chain vertices.
+ */
+static void build_chain(const Point* first, const Point* last, int side, std::vector<Point>& chain) {
+    chain.clear();
+    for (const Point* p = first; p != last; ++p) {
+        while (chain.size() >= 2 && side * cross(chain[chain.size() - 2], chain.back(), *p) >= 0)
+            chain.pop_back();
+        chain.push_back(*p);
+    }
+}
+
+/**
+ * @brief Sorts points lexicographically using several threads.
+ *
+ * Each thread sorts one contiguous chunk (by radix once the chunk reaches
+ * RADIX_SORT_THRESHOLD points), then neighbouring chunks are merged
+ * pairwise in parallel until a single sorted run remains.
+ *
+ * @param points The points to sort.
+ * @param bounds Chunk boundaries: chunk i is [bounds[i], bounds[i + 1]).
+ */
+static void parallel_sort(std::vector<Point>& points, const std::vector<size_t>& bounds) {
+    size_t chunks = bounds.size() - 1;
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < chunks; ++i) {
+        workers.emplace_back([&points, &bounds, i]() {
+            sort_points(points.data() + bounds[i], points.data() + bounds[i + 1]);
+        });
+    }
+    for (auto& t : workers) t.join();
+
+    for (size_t width = 1; width < chunks; width *= 2) {
+        workers.clear();
+        for (size_t i = 0; i + width < chunks; i += 2 * width) {
+            size_t lo = bounds[i], mid = bounds[i + width], hi = bounds[std::min(i + 2 * width, chunks)];
+            workers.emplace_back([&points, lo, mid, hi]() {
+                std::inplace_merge(points.begin() + lo, points.begin() + mid, points.begin() + hi);
+            });
+        }
+        for (auto& t : workers) t.join();
+    }
+}
+
+/**
+ * @struct ChainGroup
+ * @brief Lower and upper monotone chains of one group in Chan's algorithm.
+ */
+struct ChainGroup {
+    std::vector<Point> lower;
+    std::vector<Point> upper;
+};
+
+/**
+ * @brief Finds the next hull vertex candidate from p on one chain of a group.
+ *
+ * Among the chain vertices lexicographically greater than p, the slope seen
+ * from p is unimodal, so a binary search finds the vertex with the largest
+ * (upper chain) or smallest (lower chain) slope, preferring the farthest one
+ * when several are collinear with p.
+ *
+ * @param chain A lower or upper chain, sorted left to right.
+ * @param p The current hull vertex.
+ * @param side -1 for the lower chain, 1 for the upper chain.
+ * @return Index of the candidate in chain, or chain.size() if every vertex is <= p.
+ */
+static size_t chain_tangent(const std::vector<Point>& chain, const Point& p, int side) {
+    size_t lo = std::upper_bound(chain.begin(), chain.end(), p) - chain.begin();
+    if (lo == chain.size()) return lo;
+    size_t hi = chain.size() - 1;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (side * cross(p, chain[mid], chain[mid + 1]) >= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief Wraps one chain of the hull from start to end, Jarvis-march style, over group chains.
+ *
+ * @param groups The groups with their precomputed chains.
+ * @param side -1 to build the lower chain, 1 to build the upper chain.
+ * @param start The lexicographically smallest point.
+ * @param end The lexicographically largest point.
+ * @param limit Maximum number of vertices allowed in the chain.
+ * @param chain Receives the chain vertices, left to right.
+ * @return true if the chain was completed within the limit.
+ */
+static bool wrap_chain(const std::vector<ChainGroup>& groups, int side, const Point& start,
+                       const Point& end, size_t limit, std::vector<Point>& chain) {
+    chain.assign(1, start);
+    Point p = start;
+    while (p < end) {
+        if (chain.size() >= limit) return false;
+        bool found = false;
+        Point best = p;
+        for (const ChainGroup& g : groups) {
+            const std::vector<Point>& c = side > 0 ? g.upper : g.lower;
+            size_t i = chain_tangent(c, p, side);
+            if (i == c.size()) continue;
+            double turn = side * cross(p, best, c[i]);
+            if (!found || turn > 0 || (turn == 0 && best < c[i])) best = c[i];
+            found = true;
+        }
+        p = best;
+        chain.push_back(p);
+    }
+    return true;
+}
+
+/**
+ * @brief Computes the convex hull with Chan's algorithm.
+ *
+ * Guesses the hull size m, splits the input into groups of m points, builds
+ * the chains of every group, then wraps the hull using one binary search per
+ * group and step. If the hull has more than m vertices the guess is squared.
+ * The total cost is O(n log h) for a hull of h vertices.
+ *
+ * @param points The input points.
+ * @param guess Initial estimate of the hull size.
+ * @return A deque of points forming the convex hull in counter-clockwise order.
+ */
+static std::deque<Point> chan_hull(const std::deque<Point>& points, size_t guess) {
+    size_t n = points.size();
+    Point first = *std::min_element(points.begin(), points.end());
+    Point last = *std::max_element(points.begin(), points.end());
+    if (!(first < last)) return std::deque<Point>(2, first); // One distinct point: Monotone Chain returns it twice
+
+    std::vector<Point> group, lower, upper;
+    for (size_t m = std::max<size_t>(guess, 4);; m = (m > n / m) ? n : m * m) {
+        std::vector<ChainGroup> groups((n + m - 1) / m);
+        for (size_t g = 0; g < groups.size(); ++g) {
+            group.assign(points.begin() + g * m, points.begin() + std::min(n, (g + 1) * m));
+            sort_points(group.data(), group.data() + group.size());
+            build_chain(group.data(), group.data() + group.size(), -1, groups[g].lower);
+            build_chain(group.data(), group.data() + group.size(), 1, groups[g].upper);
+        }
+        if (wrap_chain(groups, -1, first, last, m + 1, lower) && wrap_chain(groups, 1, first, last, m + 1, upper))
+            break;
+    }
+
+    std::deque<Point> hull(lower.begin(), lower.end());
+    if (upper.size() > 2) hull.insert(hull.end(), upper.rbegin() + 1, upper.rend() - 1);
+    return hull;
+}
+
+/**
+ * @brief Estimates the number of hull vertices from an evenly spaced sample.
+ *
+ * @param points The input points.
+ * @return Hull size of a sample of about HULL_SAMPLE_SIZE points.
+ */
+static size_t estimate_hull_size(const std::deque<Point>& points) {
+    const size_t HULL_SAMPLE_SIZE = 1024;
+    size_t step = std::max<size_t>(1, points.size() / HULL_SAMPLE_SIZE);
+    std::deque<Point> sample;
+    for (size_t i = 0; i < points.size(); i += step) sample.push_back(points[i]);
+    return compute_convex_hull_deque(sample).size();
+}
+
+/**
+ * @brief Computes the convex hull with std::deque output, optionally on several threads.
+ *
+ * The hull of the whole set only uses vertices of the chunk hulls, so after a
+ * parallel sort every thread builds the chains of its own x-range and one final
+ * Monotone Chain pass over the concatenated chunk chains yields the full hull.
+ *
+ * @param points The input deque of 2D points.
+ * @param options Thread count and other settings.
+ * @return A deque of points forming the convex hull in counter-clockwise order.
+ */
+std::deque<Point> compute_convex_hull_deque(std::deque<Point> points, const HullOptions& options) {
+    if (options.prefilter) discard_interior_points(points);
+
+    // Chan's algorithm pays off when the hull is much smaller than the input;
+    // a sample hull gives both that estimate and the initial group size.
+    if ((options.engine == HullEngine::Chan && points.size() > 2) ||
+        (options.engine == HullEngine::Auto && points.size() >= CHAN_THRESHOLD)) {
+        size_t estimate = estimate_hull_size(points);
+        if (options.engine == HullEngine::Chan || estimate * estimate * estimate < points.size())
+            return chan_hull(points, 2 * estimate);
+    }
+
+    size_t n = points.size();
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    size_t threads = options.threads ? std::min<size_t>(options.threads, hardware) : hardware;
+    threads = std::min(threads, std::max<size_t>(1, n / PARALLEL_MIN_CHUNK)); // Never more threads than cores or chunks
+    if (threads <= 1 || n < PARALLEL_HULL_THRESHOLD) return compute_convex_hull_deque(std::move(points));
+
+    std::vector<Point> sorted(points.begin(), points.end());
+    std::vector<size_t> bounds(threads + 1);
+    for (size_t i = 0; i <= threads; ++i) bounds[i] = n * i / threads;
+    parallel_sort(sorted, bounds);
+
+    std::vector<std::vector<Point>> lower(threads), upper(threads);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([&, i]() {
+            build_chain(sorted.data() + bounds[i], sorted.data() + bounds[i + 1], -1, lower[i]);
+            build_chain(sorted.data() + bounds[i], sorted.data() + bounds[i + 1], 1, upper[i]);
+        });
+    }
+    for (auto& t : workers) t.join();
+
+    std::vector<Point> candidates, lower_chain, upper_chain;
+    for (const auto& c : lower) candidates.insert(candidates.end(), c.begin(), c.end());
+    build_chain(candidates.data(), candidates.data() + candidates.size(), -1, lower_chain);
+    candidates.clear();
+    for (const auto& c : upper) candidates.insert(candidates.end(), c.begin(), c.end());
+    build_chain(candidates.data(), candidates.data() + candidates.size(), 1, upper_chain);
+
+    std::deque<Point> hull(lower_chain.begin(), lower_chain.end());
+    if (upper_chain.size() > 2) hull.insert(hull.end(), upper_chain.rbegin() + 1, upper_chain.rend() - 1);
+    return hull;
+}
+
+bool compute_convex_hull_deque(const PointColumns& points, const HullOptions& options, std::deque<Point>& hull) {
+    std::deque<Point> candidates;
+    if (!copy_hull_candidates(points, options.prefilter, candidates)) {
+        hull.clear();
+        return false;
+    }
+    HullOptions rest = options;
+    rest.prefilter = false; // Already filtered
+    hull = compute_convex_hull_deque(std::move(candidates), rest);
+    return true;
+}
+
+StreamingHullDeque::StreamingHullDeque(size_t chunk_size, const HullOptions& options)
+    : options(options), chunk_size(std::max<size_t>(chunk_size, 1)), added(0) {}
+
+void StreamingHullDeque::add(const Point& p) {
+    buffer.push_back(p);
+    ++added;
+    if (buffer.size() >= chunk_size) merge();
+}
+
+bool StreamingHullDeque::add(const PointColumns& points) {
+    for (size_t i = 0; i < points.size(); ++i) {
+        Point p = points[i];
+        if (!std::isfinite(p.x) || !std::isfinite(p.y)) return false;
+        add(p);
+    }
+    return true;
+}
+
+const std::deque<Point>& StreamingHullDeque::hull() {
+    merge();
+    return current;
+}
+
+unsigned long long StreamingHullDeque::count() const {
+    return added;
+}
+
+void StreamingHullDeque::merge() {
+    if (buffer.empty()) return;
+    buffer.insert(buffer.end(), current.begin(), current.end());
+    current = compute_convex_hull_deque(std::move(buffer), options);
+    buffer.clear(); // Moved from
+}
+
 /**
  * @brief Computes the area of a polygon from a deque of ordered points.
  * 
@@ -68,12 +545,20 @@ std::deque<Point> compute_convex_hull_deque(std::deque<Point> points) {
  * @return The absolute area of the polygon.
  */
 double compute_area(const std::deque<Point>& polygon) {
-    double area = 0;
     size_t n = polygon.size();
-    for (size_t i = 0; i < n; ++i) {
-        const Point& p1 = polygon[i];
-        const Point& p2 = polygon[(i + 1) % n];
-        area += (p1.x * p2.y - p2.x * p1.y);
+    if (n == 0) return 0;
+
+    // Gather the closed polygon into SoA blocks for the vectorized shoelace sum
+    double x[SIMD_BLOCK + 1], y[SIMD_BLOCK + 1];
+    double area = 0;
+    for (size_t first = 0; first < n; first += SIMD_BLOCK) {
+        size_t len = std::min(SIMD_BLOCK, n - first);
+        for (size_t i = 0; i <= len; ++i) {
+            const Point& p = polygon[(first + i) % n];
+            x[i] = p.x;
+            y[i] = p.y;
+        }
+        area += shoelace_sum(x, y, len);
     }
     return std::abs(area) / 2.0;
 }
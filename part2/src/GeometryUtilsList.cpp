@@ -1,60 +1,168 @@
 #include "../include/GeometryUtils.hpp"
 #include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <utility>
 #include <vector>
 
 /**
- * @brief Lexicographic comparison operator for sorting points.
+ * @brief Size classes NodePool keeps a free list for, 16 bytes apart.
+ */
+static const size_t NODE_POOL_CLASSES = NODE_POOL_MAX_SIZE / 16;
+
+/**
+ * @struct FreeNode
+ * @brief A pooled node while it is on a free list.
+ */
+struct FreeNode {
+    FreeNode* next;
+};
+
+/**
+ * @struct NodeClass
+ * @brief One thread's nodes of one size class.
  *
- * Compares points first by x, then by y if x values are equal.
- * 
- * @param other The point to compare against.
- * @return true if this point is less than the other, false otherwise.
+ * Nodes are handed out from the free list first, then by bumping through the
+ * blocks in address order. Once every node is back, the free list is dropped
+ * and the bump pointer rewinds to the first block, so the next list is laid
+ * out sequentially again instead of in the scattered order of the frees.
  */
-bool Point::operator<(const Point& other) const {
-    return x < other.x || (x == other.x && y < other.y);
+struct NodeClass {
+    std::vector<char*> blocks;   // Every block, in the order they were allocated
+    FreeNode* free = nullptr;    // Freed nodes, most recent first
+    size_t bump_block = 0;       // Block the bump pointer is in
+    size_t bump_node = 0;        // Next never-used node of that block
+    size_t in_use = 0;           // Nodes handed out and not freed yet
+};
+
+// Node classes of the calling thread, indexed by size / 16 - 1
+static thread_local NodeClass node_classes[NODE_POOL_CLASSES];
+
+void* NodePool::allocate(size_t size) {
+    size_t size_class = (size + 15) / 16 - 1;
+    size_t node_size = (size_class + 1) * 16;
+    NodeClass& nodes = node_classes[size_class];
+    ++nodes.in_use;
+    if (nodes.free) {
+        FreeNode* node = nodes.free;
+        nodes.free = node->next;
+        return node;
+    }
+    if (nodes.bump_node == NODE_POOL_BLOCK) {
+        ++nodes.bump_block;
+        nodes.bump_node = 0;
+    }
+    if (nodes.bump_block == nodes.blocks.size())
+        nodes.blocks.push_back(static_cast<char*>(::operator new(NODE_POOL_BLOCK * node_size))); // Never freed, see NodePool
+    return nodes.blocks[nodes.bump_block] + node_size * nodes.bump_node++;
 }
 
+void NodePool::deallocate(void* node, size_t size) {
+    NodeClass& nodes = node_classes[(size + 15) / 16 - 1];
+    if (--nodes.in_use == 0) {
+        nodes.free = nullptr;
+        nodes.bump_block = 0;
+        nodes.bump_node = 0;
+        return;
+    }
+    FreeNode* freed = static_cast<FreeNode*>(node);
+    freed->next = nodes.free;
+    nodes.free = freed;
+}
+
+// Scratch for sort_list(), one per thread, kept between calls so warm runs do not allocate
+static thread_local std::vector<Point> sort_buffer;
+
 /**
- * @brief Computes the convex hull using the Monotone Chain algorithm with std::list.
+ * @brief Sorts a list's points in place without relinking its nodes.
  *
- * Converts the list to a sorted vector, builds lower and upper hulls using iterators.
- * 
- * @param input A list of 2D points.
- * @return A list of points forming the convex hull in counter-clockwise order.
+ * list::sort() merges by following links, which after a few passes means a
+ * cache miss per comparison. Instead the values are read out in one
+ * sequential walk, sorted contiguously and written back in a second walk, so
+ * each node keeps its place and receives the point of its rank.
+ *
+ * @param points The list to sort.
  */
-std::list<Point> compute_convex_hull_list(std::list<Point> input) {
-    if (input.size() <= 1) return input;
-
-    std::vector<Point> points(input.begin(), input.end());
-    std::sort(points.begin(), points.end());
-    std::list<Point> hull;
-
-    for (const auto& p : points) {
-        while (hull.size() >= 2) {
-            auto it2 = hull.rbegin();
-            auto it1 = std::next(it2);
-            if ((it2->x - it1->x) * (p.y - it1->y) - (it2->y - it1->y) * (p.x - it1->x) > 0)
-                break;
-            hull.pop_back();
+template <class List>
+static void sort_list(List& points) {
+    sort_buffer.assign(points.begin(), points.end());
+    std::sort(sort_buffer.begin(), sort_buffer.end());
+    std::copy(sort_buffer.begin(), sort_buffer.end(), points.begin());
+}
+
+/**
+ * @brief Cross product of vectors o->a and o->b: positive for a counter-clockwise turn.
+ */
+static double cross(const Point& o, const Point& a, const Point& b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+/**
+ * @brief Computes the convex hull using the Monotone Chain algorithm on list nodes.
+ *
+ * The list is sorted in place (sort_list()), then one walk splices the
+ * points strictly left of the line from the leftmost to the rightmost point
+ * onto a second list, which keeps both lists sorted: only those points can
+ * be on the upper chain, and only the others on the lower one. Each chain
+ * is then built by splicing nodes onto it from its candidates, and nodes it
+ * pops onto a bin list that is freed on return. The upper chain starts after
+ * the rightmost point and ends before the leftmost, which stay on the lower
+ * chain and are only referenced; it is finally spliced after the lower
+ * chain. Orientation tests read the chain's last two points through a
+ * pointer kept in step with its back, instead of rbegin()/std::next().
+ *
+ * @param points A list of input points, consumed.
+ * @return The hull in counter-clockwise order, starting at the leftmost point.
+ */
+template <class List>
+static List chain_of_list(List points) {
+    if (points.size() <= 1) return points;
+    sort_list(points);
+
+    typedef typename List::iterator Iterator;
+    const Point leftmost = points.front();
+    const Point rightmost = points.back();
+    List above;
+    for (Iterator it = std::next(points.begin()); it != points.end();) {
+        Iterator next = std::next(it);
+        if (cross(leftmost, rightmost, *it) > 0) above.splice(above.end(), points, it);
+        it = next;
+    }
+
+    List lower, bin;
+    const Point* before_back = nullptr; // Point before lower's last node, nullptr while lower has fewer than 2
+    while (!points.empty()) {
+        const Point& p = points.front();
+        while (before_back && cross(*before_back, lower.back(), p) <= 0) {
+            bin.splice(bin.end(), lower, std::prev(lower.end()));
+            before_back = lower.size() >= 2 ? &*std::prev(lower.end(), 2) : nullptr;
         }
-        hull.push_back(p);
+        before_back = lower.empty() ? nullptr : &lower.back();
+        lower.splice(lower.end(), points, points.begin());
     }
 
-    size_t lower_size = hull.size();
-    for (auto it = points.rbegin(); it != points.rend(); ++it) {
-        while (hull.size() > lower_size) {
-            auto it2 = hull.rbegin();
-            auto it1 = std::next(it2);
-            if ((it2->x - it1->x) * (it->y - it1->y) - (it2->y - it1->y) * (it->x - it1->x) > 0)
-                break;
-            hull.pop_back();
+    List upper;
+    before_back = &rightmost; // Point before upper's last node; rightmost while upper has 1 node
+    while (true) {
+        const Point& p = above.empty() ? leftmost : above.back();
+        while (!upper.empty() && cross(*before_back, upper.back(), p) <= 0) {
+            bin.splice(bin.end(), upper, std::prev(upper.end()));
+            before_back = upper.size() >= 2 ? &*std::prev(upper.end(), 2) : &rightmost;
         }
-        hull.push_back(*it);
+        if (above.empty()) break;
+        before_back = upper.empty() ? &rightmost : &upper.back();
+        upper.splice(upper.end(), above, std::prev(above.end()));
     }
+    lower.splice(lower.end(), upper);
+    return lower;
+}
+
+std::list<Point> compute_convex_hull_list(std::list<Point> points) {
+    return chain_of_list(std::move(points));
+}
 
-    hull.pop_back();
-    return hull;
+PooledPointList compute_convex_hull_list(PooledPointList points) {
+    return chain_of_list(std::move(points));
 }
 
 /**
@@ -65,7 +173,9 @@ std::list<Point> compute_convex_hull_list(std::list<Point> input) {
  * @param polygon A list of polygon points in order.
  * @return The absolute area of the polygon.
  */
-double compute_area(const std::list<Point>& polygon) {
+template <class List>
+static double list_area(const List& polygon) {
+    if (polygon.empty()) return 0;
     double area = 0;
     auto it1 = polygon.begin();
     for (auto it2 = std::next(it1); it2 != polygon.end(); ++it1, ++it2)
@@ -73,3 +183,11 @@ double compute_area(const std::list<Point>& polygon) {
     area += (polygon.back().x * polygon.front().y - polygon.front().x * polygon.back().y);
     return std::abs(area) / 2.0;
 }
+
+double compute_area(const std::list<Point>& polygon) {
+    return list_area(polygon);
+}
+
+double compute_area(const PooledPointList& polygon) {
+    return list_area(polygon);
+}
@@ -0,0 +1,40 @@
+#include "../include/GeometryUtils.hpp"
+#include <algorithm>
+#include <utility>
+
+/**
+ * @brief Cross product of vectors o->a and o->b: positive for a counter-clockwise turn.
+ */
+static double cross(const Point& o, const Point& a, const Point& b) {
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+/**
+ * @brief Computes the convex hull of a set of 2D points using the Monotone Chain algorithm.
+ *
+ * Sorts the points, then builds the lower and upper chains in one array,
+ * exactly as the vector engine of part1 does for double coordinates.
+ * 
+ * @param points The input vector of points.
+ * @return A vector of points representing the convex hull in counter-clockwise order.
+ */
+std::vector<Point> compute_convex_hull_vector(std::vector<Point> points) {
+    int n = points.size(), k = 0;
+    if (n <= 1) return points;
+
+    std::sort(points.begin(), points.end());
+    std::vector<Point> hull(2 * n);
+
+    for (int i = 0; i < n; ++i) {
+        while (k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) <= 0) k--;
+        hull[k++] = points[i];
+    }
+
+    for (int i = n - 2, t = k + 1; i >= 0; --i) {
+        while (k >= t && cross(hull[k - 2], hull[k - 1], points[i]) <= 0) k--;
+        hull[k++] = points[i];
+    }
+
+    hull.resize(k - 1);
+    return hull;
+}
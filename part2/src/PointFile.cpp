@@ -0,0 +1,109 @@
+#include "../include/PointFile.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(Point) == 2 * sizeof(double), "Interleaved files are written straight from Point arrays");
+
+bool map_point_file(const char* path, MappedPointFile& file, std::string& error) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        error = std::string(path) + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(PointFileHeader))) {
+        error = std::string(path) + ": not a point file (too short)";
+        close(fd);
+        return false;
+    }
+    size_t length = static_cast<size_t>(st.st_size);
+    void* base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file open
+    if (base == MAP_FAILED) {
+        error = std::string(path) + ": " + std::strerror(errno);
+        return false;
+    }
+
+    PointFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    const char* problem = nullptr;
+    if (std::memcmp(header.magic, POINT_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        problem = "not a point file";
+    } else if (header.byte_order != POINT_FILE_BYTE_ORDER) {
+        problem = "written on a host with the other byte order";
+    } else if (header.layout != static_cast<uint32_t>(PointLayout::Interleaved) &&
+               header.layout != static_cast<uint32_t>(PointLayout::Columns)) {
+        problem = "unknown point layout";
+    } else if (header.count > (length - sizeof(header)) / (2 * sizeof(double))) {
+        problem = "truncated (fewer points than the header counts)";
+    }
+    if (problem) {
+        error = std::string(path) + ": " + problem;
+        munmap(base, length);
+        return false;
+    }
+    madvise(base, length, MADV_SEQUENTIAL); // Hull passes read the points front to back
+
+    const double* data = reinterpret_cast<const double*>(static_cast<const char*>(base) + sizeof(header));
+    size_t n = static_cast<size_t>(header.count);
+    file.header = header;
+    if (header.layout == static_cast<uint32_t>(PointLayout::Columns)) {
+        file.points = PointColumns{data, data + n, 1, n};
+    } else {
+        file.points = PointColumns{data, data + 1, 2, n};
+    }
+    file.base = base;
+    file.length = length;
+    return true;
+}
+
+void unmap_point_file(MappedPointFile& file) {
+    if (file.base) munmap(file.base, file.length);
+    file.base = nullptr;
+    file.length = 0;
+    file.points = PointColumns();
+}
+
+bool write_point_file(const char* path, const std::vector<Point>& points, PointLayout layout, std::string& error) {
+    PointFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, POINT_FILE_MAGIC, sizeof(header.magic));
+    header.byte_order = POINT_FILE_BYTE_ORDER;
+    header.layout = static_cast<uint32_t>(layout);
+    header.count = points.size();
+    if (!points.empty()) {
+        header.min_x = header.max_x = points[0].x;
+        header.min_y = header.max_y = points[0].y;
+        for (const Point& p : points) {
+            header.min_x = std::min(header.min_x, p.x);
+            header.max_x = std::max(header.max_x, p.x);
+            header.min_y = std::min(header.min_y, p.y);
+            header.max_y = std::max(header.max_y, p.y);
+        }
+    }
+
+    FILE* out = std::fopen(path, "wb");
+    if (!out) {
+        error = std::string(path) + ": " + std::strerror(errno);
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1;
+    if (layout == PointLayout::Interleaved) {
+        ok = ok && std::fwrite(points.data(), sizeof(Point), points.size(), out) == points.size();
+    } else {
+        std::vector<double> column(points.size());
+        for (size_t i = 0; i < points.size(); ++i) column[i] = points[i].x;
+        ok = ok && std::fwrite(column.data(), sizeof(double), column.size(), out) == column.size();
+        for (size_t i = 0; i < points.size(); ++i) column[i] = points[i].y;
+        ok = ok && std::fwrite(column.data(), sizeof(double), column.size(), out) == column.size();
+    }
+    if (std::fclose(out) != 0) ok = false;
+    if (!ok) error = std::string(path) + ": write failed";
+    return ok;
+}
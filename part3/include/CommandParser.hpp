@@ -0,0 +1,74 @@
+#pragma once
+#include "GeometryUtils.hpp"
+#include <string_view>
+
+/**
+ * @file
+ * @brief Allocation-free parsing of command lines and "x,y" point text.
+ *
+ * Every function works on std::string_view slices of the caller's buffer and
+ * converts numbers with std::from_chars, so a line is parsed without copies,
+ * streams or heap allocations.
+ */
+
+/**
+ * @enum CommandType
+ * @brief The command named by the first token of a line.
+ */
+enum class CommandType { Newgraph, NewgraphBin, Newpoint, Removepoint, CH, Unknown };
+
+/**
+ * @enum ParseStatus
+ * @brief Outcome of parsing a point.
+ */
+enum class ParseStatus {
+    Ok,        // Both coordinates parsed
+    BadFormat, // No comma separating x and y
+    BadValue   // A coordinate is not a finite number
+};
+
+/**
+ * @brief Strips leading and trailing whitespace, including CR and LF.
+ *
+ * @param line The raw line.
+ * @return The trimmed slice of line.
+ */
+std::string_view trim_line(std::string_view line);
+
+/**
+ * @brief Parses a whole field as a finite double.
+ *
+ * Leading whitespace and a leading '+' are accepted; anything after the number is not.
+ *
+ * @param field The text to parse.
+ * @param value Receives the number on success.
+ * @return true if the whole field is a finite number.
+ */
+bool parse_number(std::string_view field, double& value);
+
+/**
+ * @brief Parses the leading integer of a field, ignoring what follows it.
+ *
+ * @param field The text to parse.
+ * @param value Receives the number on success.
+ * @return true if the field starts with an integer.
+ */
+bool parse_count(std::string_view field, int& value);
+
+/**
+ * @brief Parses "x,y" into a point.
+ *
+ * @param text The point text.
+ * @param p Receives the point on success.
+ * @return Ok, BadFormat if there is no comma, or BadValue if a coordinate is invalid.
+ */
+ParseStatus parse_point(std::string_view text, Point& p);
+
+/**
+ * @brief Splits a trimmed line into its command and arguments.
+ *
+ * @param line A line already passed through trim_line().
+ * @param args Receives the text after the command, without leading spaces.
+ * @return The command, or CommandType::Unknown.
+ */
+CommandType parse_command(std::string_view line, std::string_view& args);
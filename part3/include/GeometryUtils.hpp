@@ -34,3 +34,18 @@ std::deque<Point> compute_convex_hull_deque(std::deque<Point> points);
  * @return The absolute value of the polygon's area.
  */
 double compute_area(const std::deque<Point>& polygon);
+
+#define ORIENT_ERROR_BOUND ((3.0 + 16.0 * 0x1p-53) * 0x1p-53) // Relative error bound of the double orientation test
+
+/**
+ * @brief Tests whether a point lies strictly inside a convex polygon.
+ *
+ * Points on an edge or a vertex, or too close to one for doubles to tell,
+ * are reported as outside, so a caller that keeps a hull only when this
+ * returns true never misses a hull change.
+ *
+ * @param hull A convex polygon in counter-clockwise order, as returned by compute_convex_hull_deque().
+ * @param p The point to test.
+ * @return true if the polygon has an interior and p is in it.
+ */
+bool strictly_inside_hull(const std::deque<Point>& hull, const Point& p);
@@ -2,78 +2,50 @@
 // Stage 3 — STDIN/STDOUT interaction (no networking)
 
 #include "GeometryUtils.hpp"
+#include "CommandParser.hpp"
 #include <iostream>
-#include <sstream>
 #include <string>
+#include <string_view>
 #include <deque>
 #include <algorithm>
 #include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BATCH_READ_CHUNK (1 << 20)   // Bytes asked of each read() when a script cannot be mapped
+#define BATCH_OUTPUT_FLUSH (16 << 20) // Batch output is written out once it grows past this
 
 static std::deque<Point> point_set;     //Stores the current set of points for the graph
 static std::deque<Point> temp_points;   // Temporary container for points while creating a new graph
 static bool waiting_for_graph = false;  // Flag indicating if we are currently reading multiple points for a new graph
 static int points_to_read = 0;          // How many more points need to be read for the current new graph
-
-/**
- * @brief Removes whitespace characters from the beginning of the string.
- * @param s String to be trimmed.
- */
-static inline void ltrim(std::string& s) {
-    // std::isspace checks whether the leading char is whitespace.
-    // s.front() accesses the first character of the string.
-    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front())))
-        s.erase(s.begin());
-}
-
-/**
- * @brief Removes whitespace characters (and \r or \n) from the end of the string.
- * @param s String to be trimmed.
- */
-static inline void rtrim(std::string& s) {
-    // std::isspace checks whether the trailing char is whitespace.
-    // s.back() accesses the last character of the string.
-    while (!s.empty() && (s.back() == '\r' || s.back() == '\n' ||
-                          std::isspace(static_cast<unsigned char>(s.back()))))
-        s.pop_back();
-}
-
-/**
- * @brief Removes whitespace from both ends of the string.
- * @param s String to be trimmed.
- */
-static inline void trim(std::string& s) { rtrim(s); ltrim(s); }
-
-/**
- * @brief Checks whether the given string represents a valid floating-point number.
- * @param s Input string.
- * @return true if s is a valid float, false otherwise.
- */
-static bool is_number(const std::string& s) {
-    std::istringstream iss(s); //allows us to parse from a string as if it were a stream.
-    double d;
-    return (iss >> d) && iss.eof(); // (iss >> d) tries to parse a double; iss.eof() ensures no extra characters remain.
-}
+static std::deque<Point> hull_cache;    // Convex hull of point_set, valid while hull_valid is set
+static double hull_area = 0;            // Area of hull_cache
+static bool hull_valid = false;         // Cleared by any change that may move the hull
 
 /**
  * @brief Handles a line containing a point in the format "x,y" during new graph creation.
  * @param line The input line containing coordinates.
  * @return "OK" if successful, error message otherwise.
  */
-static std::string handle_point_line(const std::string& line) {
-    size_t comma = line.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid point format.";
-
-    std::string x_str = line.substr(0, comma);
-    std::string y_str = line.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid point values.";
+static std::string handle_point_line(std::string_view line) {
+    Point p;
+    ParseStatus status = parse_point(line, p); // std::from_chars converts "2.5,3" without copying the text.
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid point format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid point values.";
 
-    Point p{std::stod(x_str), std::stod(y_str)}; // std::stod converts a numeric string (like "2.5") to a double.
     temp_points.push_back(p);
     points_to_read--;
     if (points_to_read == 0) {
         point_set = std::move(temp_points); //moves the contents of temp_points into point_set without copying.
         temp_points.clear();
         waiting_for_graph = false;
+        hull_valid = false;
     }
     return "OK";
 }
@@ -83,10 +55,9 @@ static std::string handle_point_line(const std::string& line) {
  * @param arg_line The arguments after the command (expected: number of points).
  * @return "OK" if successful, error message otherwise.
  */
-static std::string handle_newgraph(const std::string& arg_line) {
-    std::istringstream args(arg_line);
+static std::string handle_newgraph(std::string_view arg_line) {
     int n;
-    if (!(args >> n) || n <= 0) return "ERROR: Invalid number in Newgraph.";
+    if (!parse_count(arg_line, n) || n <= 0) return "ERROR: Invalid number in Newgraph.";
 
     waiting_for_graph = true;
     points_to_read = n;
@@ -99,16 +70,15 @@ static std::string handle_newgraph(const std::string& arg_line) {
  * @param args The arguments containing "x,y".
  * @return "OK" if successful, error message otherwise.
  */
-static std::string handle_newpoint(const std::string& args) {
-    size_t comma = args.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid Newpoint format.";
+static std::string handle_newpoint(std::string_view args) {
+    Point p;
+    ParseStatus status = parse_point(args, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid Newpoint format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid point values.";
 
-    std::string x_str = args.substr(0, comma);
-    std::string y_str = args.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid point values.";
-
-    Point p{std::stod(x_str), std::stod(y_str)}; //string-to-double conversion for X/Y values.
     point_set.push_back(p);
+    // A point strictly inside the hull cannot change it; anything else may.
+    if (hull_valid && !strictly_inside_hull(hull_cache, p)) hull_valid = false;
     return "OK";
 }
 
@@ -117,35 +87,45 @@ static std::string handle_newpoint(const std::string& args) {
  * @param args The arguments containing "x,y".
  * @return "OK" if successful, error message otherwise.
  */
-static std::string handle_removepoint(const std::string& args) {
-    size_t comma = args.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid Removepoint format.";
-
-    std::string x_str = args.substr(0, comma);
-    std::string y_str = args.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid point values.";
+static std::string handle_removepoint(std::string_view args) {
+    Point p;
+    ParseStatus status = parse_point(args, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid Removepoint format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid point values.";
 
     // std::remove_if reorders the range so that elements to "remove" are moved to the end;
     // it returns an iterator to the first of those "removed" elements.
     // The lambda matches points equal to (p.x, p.y).
-    Point p{std::stod(x_str), std::stod(y_str)};
     std::deque<Point>::iterator it =
         std::remove_if(point_set.begin(), point_set.end(),
                        [&](const Point& q) { return q.x == p.x && q.y == p.y; });
-    if (it != point_set.end()) point_set.erase(it, point_set.end());
+    if (it != point_set.end()) {
+        point_set.erase(it, point_set.end());
+        // The hull holds no collinear or interior points, so only removing one of its vertices changes it.
+        if (hull_valid && std::any_of(hull_cache.begin(), hull_cache.end(),
+                                      [&](const Point& q) { return q.x == p.x && q.y == p.y; }))
+            hull_valid = false;
+    }
     return "OK";
 }
 
 /**
  * @brief Handles the "CH" command (compute convex hull and its area).
+ *
+ * The hull is rebuilt only after a change that may have moved it, so runs of
+ * CH between interior insertions cost nothing beyond formatting.
+ *
  * @return The computed area as a string.
  */
 static std::string handle_ch() {
-    std::deque<Point> hull = compute_convex_hull_deque(point_set);
-    double area = compute_area(hull);
-    std::ostringstream oss;
-    oss << area;
-    return oss.str(); // retrieves the built string (implicitly via return below).
+    if (!hull_valid) {
+        hull_cache = compute_convex_hull_deque(point_set);
+        hull_area = compute_area(hull_cache);
+        hull_valid = true;
+    }
+    char buf[32];
+    int len = std::snprintf(buf, sizeof(buf), "%g", hull_area); // Same text as the default ostream format
+    return std::string(buf, static_cast<size_t>(len));
 }
 
 /**
@@ -153,9 +133,9 @@ static std::string handle_ch() {
  * @param line The line of input.
  * @return Output string to be printed, or empty if nothing to print.
  */
-static std::string process_line(std::string line) {
+static std::string process_line(std::string_view line) {
+    line = trim_line(line);
     if (line.empty()) return "";
-    trim(line);
 
     // If currently reading points for a new graph, handle directly as point input
     if (waiting_for_graph) {
@@ -163,27 +143,175 @@ static std::string process_line(std::string line) {
     }
 
     // Parse the first token as command, rest as arguments
-    std::istringstream iss(line);
-    std::string command;
-    iss >> command;
-
-    std::string args;
-    std::getline(iss, args);
-    if (!args.empty() && args.front() == ' ') args.erase(args.begin());
+    std::string_view args;
+    CommandType command = parse_command(line, args);
 
     // Command dispatch
-    if (command == "Newgraph")       return handle_newgraph(args);
-    else if (command == "Newpoint")  return handle_newpoint(args);
-    else if (command == "Removepoint") return handle_removepoint(args);
-    else if (command == "CH")        return handle_ch();
-    else                             return "ERROR: Unknown command.";
+    switch (command) {
+    case CommandType::Newgraph:    return handle_newgraph(args);
+    case CommandType::Newpoint:    return handle_newpoint(args);
+    case CommandType::Removepoint: return handle_removepoint(args);
+    case CommandType::CH:          return handle_ch();
+    default:                       return "ERROR: Unknown command.";
+    }
+}
+
+/**
+ * @brief Writes a whole buffer to a file descriptor.
+ * @param fd The descriptor to write to.
+ * @param data The bytes to write.
+ * @return true if every byte was written.
+ */
+static bool write_all(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t n = write(fd, data.data(), data.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(n));
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the batch output if it has grown past BATCH_OUTPUT_FLUSH.
+ * @param out The pending output; emptied once written.
+ * @return false if stdout cannot be written.
+ */
+static bool spill_output(std::string& out) {
+    if (out.size() < BATCH_OUTPUT_FLUSH) return true;
+    bool ok = write_all(STDOUT_FILENO, out);
+    out.clear();
+    return ok;
+}
+
+/**
+ * @brief Runs every complete line of a script chunk and appends the results to out.
+ *
+ * The output is spilled as it passes BATCH_OUTPUT_FLUSH, so even a whole
+ * mapped script never holds more than that much output in memory.
+ *
+ * @param data The script bytes.
+ * @param at_end Whether data runs to the end of the script, so a last line without '\n' is complete too.
+ * @param out Receives one line per non-empty result.
+ * @param consumed Receives the number of bytes run; the rest starts a line that continues in the next chunk.
+ * @return false if stdout cannot be written.
+ */
+static bool process_script(std::string_view data, bool at_end, std::string& out, size_t& consumed) {
+    size_t pos = 0;
+    while (pos < data.size()) {
+        const void* nl = std::memchr(data.data() + pos, '\n', data.size() - pos);
+        if (!nl && !at_end) break;
+        size_t end = nl ? static_cast<size_t>(static_cast<const char*>(nl) - data.data()) : data.size();
+        std::string result = process_line(data.substr(pos, end - pos));
+        if (!result.empty()) {
+            out += result;
+            out += '\n';
+            if (!spill_output(out)) return false;
+        }
+        pos = nl ? end + 1 : end;
+    }
+    consumed = pos;
+    return true;
+}
+
+/**
+ * @brief Runs a script read from a descriptor in BATCH_READ_CHUNK reads.
+ *
+ * Used for stdin and for anything that cannot be mapped, such as pipes.
+ *
+ * @param fd The descriptor to read until end of file.
+ * @param out Receives the output.
+ * @return true unless reading or writing failed.
+ */
+static bool run_script_fd(int fd, std::string& out) {
+    std::string buffer;
+    size_t used = 0; // Bytes of buffer holding unprocessed script text
+    for (;;) {
+        if (buffer.size() < used + BATCH_READ_CHUNK) buffer.resize(used + BATCH_READ_CHUNK);
+        ssize_t n = read(fd, &buffer[used], BATCH_READ_CHUNK);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        used += static_cast<size_t>(n);
+        size_t consumed;
+        if (!process_script(std::string_view(buffer.data(), used), n == 0, out, consumed)) return false;
+        // Move the partial last line to the front for the next read to complete.
+        std::memmove(&buffer[0], buffer.data() + consumed, used - consumed);
+        used -= consumed;
+        if (n == 0) return true;
+    }
+}
+
+/**
+ * @brief Runs a whole command script and writes its output in as few writes as possible.
+ *
+ * Regular files are mapped and parsed in place; stdin ("-") and other
+ * unmappable inputs are read in large chunks. Results are collected in one
+ * buffer and written at the end, or whenever it passes BATCH_OUTPUT_FLUSH.
+ *
+ * @param path The script file, or "-" for stdin.
+ * @return Exit status code (0 for success).
+ */
+static int run_batch(const char* path) {
+    std::string out;
+    bool ok;
+    if (std::strcmp(path, "-") == 0) {
+        ok = run_script_fd(STDIN_FILENO, out);
+    } else {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            std::fprintf(stderr, "%s: %s\n", path, std::strerror(errno));
+            return 1;
+        }
+        struct stat st;
+        void* base = MAP_FAILED;
+        size_t length = 0;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            length = static_cast<size_t>(st.st_size);
+            base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        if (base != MAP_FAILED) {
+            madvise(base, length, MADV_SEQUENTIAL); // The script is read once, front to back
+            size_t consumed;
+            ok = process_script(std::string_view(static_cast<const char*>(base), length), true, out, consumed);
+            munmap(base, length);
+        } else {
+            ok = run_script_fd(fd, out);
+        }
+        close(fd);
+    }
+    if (!write_all(STDOUT_FILENO, out)) ok = false;
+    if (!ok) {
+        std::fprintf(stderr, "%s: %s\n", path, std::strerror(errno));
+        return 1;
+    }
+    return 0;
 }
 
 /**
  * @brief Main loop: reads commands from stdin and writes results to stdout.
+ *
+ * Usage: ConvexHull [--batch [FILE]]
+ *
+ * Without options each result is written and flushed as soon as its line is
+ * read, for interactive use. With --batch the script in FILE (or stdin when
+ * FILE is omitted or "-") is replayed as fast as possible and the output is
+ * written in bulk, see run_batch().
+ *
  * @return Exit status code (0 for success).
  */
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        if (std::strcmp(argv[1], "--batch") != 0 || argc > 3) {
+            std::fprintf(stderr, "Usage: %s [--batch [FILE]]\n", argv[0]);
+            return 1;
+        }
+        return run_batch(argc == 3 ? argv[2] : "-");
+    }
+
     std::ios::sync_with_stdio(false); // Disable C-style sync for faster I/O
     std::cin.tie(nullptr);            // Untie cin from cout for performance
 
@@ -0,0 +1,81 @@
+#include "../include/CommandParser.hpp"
+#include <charconv>
+#include <cmath>
+
+/**
+ * @brief True for the characters std::isspace accepts in the "C" locale.
+ */
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+/**
+ * @brief Drops leading whitespace and one leading '+', as stream extraction does.
+ */
+static std::string_view skip_number_prefix(std::string_view field) {
+    size_t start = 0;
+    while (start < field.size() && is_space(field[start])) ++start;
+    field.remove_prefix(start);
+    if (!field.empty() && field.front() == '+') {
+        field.remove_prefix(1);
+        if (!field.empty() && field.front() == '-') return std::string_view(); // "+-1" is not a number
+    }
+    return field;
+}
+
+std::string_view trim_line(std::string_view line) {
+    size_t start = 0;
+    while (start < line.size() && is_space(line[start])) ++start;
+    size_t end = line.size();
+    while (end > start && is_space(line[end - 1])) --end;
+    return line.substr(start, end - start);
+}
+
+bool parse_number(std::string_view field, double& value) {
+    field = skip_number_prefix(field);
+    const char* end = field.data() + field.size();
+    std::from_chars_result result = std::from_chars(field.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end && std::isfinite(value);
+}
+
+bool parse_count(std::string_view field, int& value) {
+    field = skip_number_prefix(field);
+    return std::from_chars(field.data(), field.data() + field.size(), value).ec == std::errc();
+}
+
+ParseStatus parse_point(std::string_view text, Point& p) {
+    size_t comma = text.find(',');
+    if (comma == std::string_view::npos) return ParseStatus::BadFormat;
+    if (!parse_number(text.substr(0, comma), p.x) || !parse_number(text.substr(comma + 1), p.y))
+        return ParseStatus::BadValue;
+    return ParseStatus::Ok;
+}
+
+/**
+ * @brief Maps a command token to its type, dispatching on the token length first.
+ */
+static CommandType command_type(std::string_view token) {
+    switch (token.size()) {
+    case 2:
+        if (token == "CH") return CommandType::CH;
+        break;
+    case 8:
+        if (token == "Newgraph") return CommandType::Newgraph;
+        if (token == "Newpoint") return CommandType::Newpoint;
+        break;
+    case 11:
+        if (token == "NewgraphBin") return CommandType::NewgraphBin;
+        if (token == "Removepoint") return CommandType::Removepoint;
+        break;
+    }
+    return CommandType::Unknown;
+}
+
+CommandType parse_command(std::string_view line, std::string_view& args) {
+    size_t end = 0;
+    while (end < line.size() && !is_space(line[end])) ++end;
+    args = line.substr(end);
+    size_t start = args.find_first_not_of(' ');
+    args = start == std::string_view::npos ? std::string_view() : args.substr(start);
+    return command_type(line.substr(0, end));
+}
@@ -83,3 +83,29 @@ double compute_area(const std::deque<Point>& polygon) {
     }
     return std::abs(area) / 2.0;
 }
+
+/**
+ * @brief Tests whether a point lies strictly inside a convex polygon.
+ *
+ * The point must be strictly to the left of every edge of the counter-clockwise
+ * polygon. Polygons with fewer than 3 vertices have no interior. A cross
+ * product within its rounding error bound (Shewchuk's ccwerrboundA) counts as
+ * not left, so a point whose side the doubles cannot decide is reported as
+ * outside rather than risk a wrong "inside".
+ *
+ * @param hull The convex polygon in counter-clockwise order.
+ * @param p The point to test.
+ * @return true if p is inside and not on the boundary.
+ */
+bool strictly_inside_hull(const std::deque<Point>& hull, const Point& p) {
+    size_t n = hull.size();
+    if (n < 3) return false;
+    for (size_t i = 0; i < n; ++i) {
+        const Point& o = hull[i];
+        const Point& a = hull[(i + 1) % n];
+        double left = (a.x - o.x) * (p.y - o.y);
+        double right = (a.y - o.y) * (p.x - o.x);
+        if (left - right <= ORIENT_ERROR_BOUND * (std::fabs(left) + std::fabs(right))) return false;
+    }
+    return true;
+}
@@ -0,0 +1,405 @@
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @file
+ * @brief Load generator for the convex hull servers (part4, part6, part7, part9 and part10).
+ *
+ * Every server speaks the same line protocol on the same port, so one client
+ * drives them all and each architecture can be measured on the same scenario.
+ *
+ * One connection first loads a graph of --graph-size points. Then --connections
+ * client threads, one socket each, send a weighted mix of Newgraph, Newpoint,
+ * Removepoint and CH commands for --duration seconds, with one command in
+ * flight per connection. A command's latency runs from the moment it was due
+ * until its last response line arrived; a Newgraph counts as one command
+ * whose last response is GRAPH_LOADED.
+ *
+ * Without --rate every connection sends its next command as soon as the
+ * previous one is answered (closed loop). With --rate the commands are due at
+ * fixed intervals whatever the server's speed, and a command sent late is
+ * charged for the time it waited, so a saturated server shows up in the tail
+ * latencies instead of only in a lower throughput.
+ *
+ * Options:
+ * - --host H, --port P: server address (default 127.0.0.1 9034).
+ * - --connections C: concurrent connections (default 8).
+ * - --duration S: measured seconds (default 5).
+ * - --rate R: total commands per second over all connections (default 0, closed loop).
+ * - --mix N,A,R,C: relative weights of Newgraph, Newpoint, Removepoint and CH (default 1,60,20,19).
+ * - --graph-size N: points of the initial graph and of every Newgraph (default 1000).
+ * - --range N: coordinates are integers in [-N, N] (default 100000).
+ */
+
+#define DEFAULT_PORT 9034
+#define READ_CHUNK 65536 // Bytes read from a socket at a time
+
+/**
+ * @enum Op
+ * @brief The command kinds of the mix, in --mix order.
+ */
+enum Op { OP_NEWGRAPH, OP_NEWPOINT, OP_REMOVEPOINT, OP_CH, OP_COUNT };
+
+static const char* OP_NAMES[OP_COUNT] = {"Newgraph", "Newpoint", "Removepoint", "CH"};
+
+/**
+ * @struct Options
+ * @brief The parsed command line.
+ */
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = DEFAULT_PORT;
+    int connections = 8;
+    double duration = 5;
+    double rate = 0;
+    unsigned mix[OP_COUNT] = {1, 60, 20, 19};
+    int graph_size = 1000;
+    int range = 100000;
+};
+
+/**
+ * @struct Results
+ * @brief What one connection measured: latencies in nanoseconds and error counts per Op.
+ */
+struct Results {
+    std::vector<uint64_t> latencies[OP_COUNT];
+    size_t errors[OP_COUNT] = {0};
+    bool failed = false; // The connection broke before the end of the run
+};
+
+/**
+ * @class Connection
+ * @brief A blocking socket to the server with a line reader.
+ */
+class Connection {
+public:
+    ~Connection() {
+        if (fd >= 0) close(fd);
+    }
+
+    /**
+     * @brief Connects to the server, with Nagle's algorithm off so single commands go out at once.
+     *
+     * @return true on success; otherwise prints why to stderr.
+     */
+    bool open(const Options& options) {
+        addrinfo hints{}, *addresses;
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        std::string port = std::to_string(options.port);
+        int rc = getaddrinfo(options.host.c_str(), port.c_str(), &hints, &addresses);
+        if (rc != 0) {
+            std::fprintf(stderr, "getaddrinfo: %s\n", gai_strerror(rc));
+            return false;
+        }
+        for (addrinfo* a = addresses; a && fd < 0; a = a->ai_next) {
+            fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if (fd < 0) continue;
+            if (connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(addresses);
+        if (fd < 0) {
+            std::perror("connect");
+            return false;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return true;
+    }
+
+    /**
+     * @brief Sends the whole buffer.
+     *
+     * @return false if the connection broke.
+     */
+    bool send_all(const std::string& data) {
+        for (size_t sent = 0; sent < data.size();) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Reads the next response line, without its newline.
+     *
+     * @return false if the connection closed first.
+     */
+    bool read_line(std::string& line) {
+        for (;;) {
+            size_t newline = buffer.find('\n', start);
+            if (newline != std::string::npos) {
+                line.assign(buffer, start, newline - start);
+                start = newline + 1;
+                return true;
+            }
+            buffer.erase(0, start);
+            start = 0;
+            size_t used = buffer.size();
+            buffer.resize(used + READ_CHUNK);
+            ssize_t n = recv(fd, &buffer[used], READ_CHUNK, 0);
+            buffer.resize(used + (n > 0 ? static_cast<size_t>(n) : 0));
+            if (n <= 0) return false;
+        }
+    }
+
+private:
+    int fd = -1;
+    std::string buffer; // Received bytes; those before start were already returned
+    size_t start = 0;
+};
+
+/**
+ * @brief Returns the lines of a Newgraph of n random points.
+ */
+static std::string newgraph_request(int n, int range, std::mt19937_64& rng) {
+    std::uniform_int_distribution<int> coordinate(-range, range);
+    std::string request = "Newgraph " + std::to_string(n) + "\n";
+    char line[32];
+    for (int i = 0; i < n; ++i) {
+        std::snprintf(line, sizeof(line), "%d,%d\n", coordinate(rng), coordinate(rng));
+        request += line;
+    }
+    return request;
+}
+
+/**
+ * @brief Sends a request and reads its responses.
+ *
+ * @param responses Number of response lines the request produces.
+ * @param error Set if any of them is an error.
+ * @return false if the connection broke.
+ */
+static bool exchange(Connection& connection, const std::string& request, int responses, bool& error) {
+    if (!connection.send_all(request)) return false;
+    std::string line;
+    error = false;
+    for (int i = 0; i < responses; ++i) {
+        if (!connection.read_line(line)) return false;
+        if (line.compare(0, 5, "ERROR") == 0) error = true;
+    }
+    return true;
+}
+
+/**
+ * @brief Runs one connection's share of the workload until the deadline.
+ *
+ * Removepoint removes a point this connection added earlier, so it usually
+ * hits, until some connection's Newgraph replaces the graph.
+ */
+static void run_connection(const Options& options, unsigned seed, std::chrono::steady_clock::time_point begin,
+                           std::chrono::steady_clock::time_point deadline, Results& results) {
+    Connection connection;
+    if (!connection.open(options)) {
+        results.failed = true;
+        return;
+    }
+    std::mt19937_64 rng(seed);
+    std::discrete_distribution<int> pick(std::begin(options.mix), std::end(options.mix));
+    std::uniform_int_distribution<int> coordinate(-options.range, options.range);
+    std::vector<std::pair<int, int>> added; // Points this connection added and has not removed
+    std::chrono::nanoseconds interval(
+        options.rate > 0 ? static_cast<int64_t>(1e9 * options.connections / options.rate) : 0);
+    // Stagger the connections so their fixed-rate schedules interleave
+    std::chrono::steady_clock::time_point due = begin + interval * (seed % options.connections) / options.connections;
+    std::string request;
+    char line[64];
+
+    for (;;) {
+        if (interval.count() > 0) {
+            if (due >= deadline) break;
+            std::this_thread::sleep_until(due);
+        } else {
+            due = std::chrono::steady_clock::now();
+            if (due >= deadline) break;
+        }
+
+        int op = pick(rng), responses = 1;
+        if (op == OP_NEWGRAPH) {
+            request = newgraph_request(options.graph_size, options.range, rng);
+            responses = options.graph_size + 1;
+            added.clear();
+        } else if (op == OP_NEWPOINT) {
+            std::pair<int, int> p(coordinate(rng), coordinate(rng));
+            std::snprintf(line, sizeof(line), "Newpoint %d,%d\n", p.first, p.second);
+            request = line;
+            added.push_back(p);
+        } else if (op == OP_REMOVEPOINT) {
+            std::pair<int, int> p(coordinate(rng), coordinate(rng));
+            if (!added.empty()) {
+                size_t i = rng() % added.size();
+                p = added[i];
+                added[i] = added.back();
+                added.pop_back();
+            }
+            std::snprintf(line, sizeof(line), "Removepoint %d,%d\n", p.first, p.second);
+            request = line;
+        } else {
+            request = "CH\n";
+        }
+
+        bool error;
+        if (!exchange(connection, request, responses, error)) {
+            results.failed = true;
+            return;
+        }
+        uint64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - due)
+                               .count();
+        results.latencies[op].push_back(latency);
+        if (error) ++results.errors[op];
+        due += interval;
+    }
+}
+
+/**
+ * @brief Returns the q-th quantile of sorted latencies, in microseconds.
+ */
+static double quantile_us(const std::vector<uint64_t>& sorted, double q) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(q * (sorted.size() - 1) + 0.5);
+    return sorted[rank] / 1000.0;
+}
+
+/**
+ * @brief Prints one result row.
+ */
+static void print_row(const char* name, std::vector<uint64_t>& latencies, size_t errors, double seconds) {
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("%-12s %10zu %8zu %12.1f %10.1f %10.1f %10.1f %10.1f\n", name, latencies.size(), errors,
+                latencies.size() / seconds, quantile_us(latencies, 0.5), quantile_us(latencies, 0.99),
+                quantile_us(latencies, 0.999), latencies.empty() ? 0.0 : latencies.back() / 1000.0);
+}
+
+/**
+ * @brief Parses "N,A,R,C" into the mix weights.
+ *
+ * @return false unless there are four weights and at least one is positive.
+ */
+static bool parse_mix(const char* text, unsigned* mix) {
+    unsigned total = 0;
+    for (int i = 0; i < OP_COUNT; ++i) {
+        char* end;
+        unsigned long weight = std::strtoul(text, &end, 10);
+        if (end == text || *end != (i + 1 < OP_COUNT ? ',' : '\0')) return false;
+        mix[i] = static_cast<unsigned>(weight);
+        total += mix[i];
+        text = end + 1;
+    }
+    return total > 0;
+}
+
+/**
+ * @brief Parses the options, loads the initial graph, runs the connections and prints the results.
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments (see the options above).
+ * @return 0 on success, 1 on invalid arguments or a connection failure.
+ */
+int main(int argc, char* argv[]) {
+    Options options;
+    bool valid = true;
+    for (int i = 1; i < argc && valid; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--host") == 0 && has_value) {
+            options.host = argv[++i];
+        } else if (std::strcmp(argv[i], "--port") == 0 && has_value) {
+            options.port = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--connections") == 0 && has_value) {
+            options.connections = std::atoi(argv[++i]);
+            valid = options.connections > 0;
+        } else if (std::strcmp(argv[i], "--duration") == 0 && has_value) {
+            options.duration = std::atof(argv[++i]);
+            valid = options.duration > 0;
+        } else if (std::strcmp(argv[i], "--rate") == 0 && has_value) {
+            options.rate = std::atof(argv[++i]);
+            valid = options.rate >= 0;
+        } else if (std::strcmp(argv[i], "--mix") == 0 && has_value) {
+            valid = parse_mix(argv[++i], options.mix);
+        } else if (std::strcmp(argv[i], "--graph-size") == 0 && has_value) {
+            options.graph_size = std::atoi(argv[++i]);
+            valid = options.graph_size > 0;
+        } else if (std::strcmp(argv[i], "--range") == 0 && has_value) {
+            options.range = std::atoi(argv[++i]);
+            valid = options.range > 0;
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid) {
+        std::fprintf(stderr,
+                     "Usage: %s [--host H] [--port P] [--connections C] [--duration S] [--rate R]\n"
+                     "          [--mix NEWGRAPH,NEWPOINT,REMOVEPOINT,CH] [--graph-size N] [--range N]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    // Every run starts from the same graph, whatever the server held before
+    {
+        Connection connection;
+        std::mt19937_64 rng(12345);
+        bool error;
+        if (!connection.open(options) ||
+            !exchange(connection, newgraph_request(options.graph_size, options.range, rng), options.graph_size + 1,
+                      error) ||
+            error) {
+            std::fprintf(stderr, "Could not load the initial graph\n");
+            return 1;
+        }
+    }
+
+    std::vector<Results> results(options.connections);
+    std::vector<std::thread> threads;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point deadline =
+        begin + std::chrono::nanoseconds(static_cast<int64_t>(options.duration * 1e9));
+    for (int i = 0; i < options.connections; ++i)
+        threads.emplace_back(run_connection, std::cref(options), static_cast<unsigned>(i), begin, deadline,
+                             std::ref(results[i]));
+    for (std::thread& thread : threads) thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    size_t failed = 0;
+    for (const Results& r : results) failed += r.failed;
+    std::printf("%d connection(s), %.2f s, %s\n", options.connections, seconds,
+                options.rate > 0 ? ("target " + std::to_string(static_cast<long>(options.rate)) + " ops/s").c_str()
+                                 : "closed loop");
+    std::printf("%-12s %10s %8s %12s %10s %10s %10s %10s\n", "command", "count", "errors", "ops/s", "p50us", "p99us",
+                "p999us", "maxus");
+    std::vector<uint64_t> all;
+    size_t all_errors = 0;
+    for (int op = 0; op < OP_COUNT; ++op) {
+        std::vector<uint64_t> latencies;
+        size_t errors = 0;
+        for (Results& r : results) {
+            latencies.insert(latencies.end(), r.latencies[op].begin(), r.latencies[op].end());
+            errors += r.errors[op];
+        }
+        all.insert(all.end(), latencies.begin(), latencies.end());
+        all_errors += errors;
+        if (!latencies.empty()) print_row(OP_NAMES[op], latencies, errors, seconds);
+    }
+    print_row("total", all, all_errors, seconds);
+    if (failed > 0) {
+        std::fprintf(stderr, "%zu connection(s) failed\n", failed);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+#pragma once
+#include "CommandParser.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/**
+ * @file
+ * @brief Counters and latency histograms for the server's hot paths, reported by the Stats command.
+ *
+ * Every thread records into its own ThreadMetrics slot with relaxed loads and
+ * stores, so recording takes no lock and no read-modify-write. Stats sums the
+ * slots while they are being written; a total may miss events recorded
+ * during the sum, but never tears. Slots outlive their threads and are
+ * reused by later ones, so counts are cumulative since startup.
+ *
+ * Build with `make METRICS=0` to compile every recording call to nothing;
+ * Stats then answers with an error.
+ */
+
+#ifndef METRICS
+#define METRICS 1
+#endif
+
+#define LATENCY_BUCKETS 32 // Bucket i counts durations in [2^i, 2^(i+1)) ns; the last one everything above
+
+/**
+ * @enum Counter
+ * @brief Event counts.
+ */
+enum class Counter : unsigned {
+    LoopIterations, // Wakeups of an event loop (reactor, select() or io_uring)
+    LoopReadyFds,   // Ready descriptors or completions those wakeups returned
+    HullJoins,      // Hull snapshot requests that waited for another request's computation instead of their own
+    Count
+};
+
+/**
+ * @enum Latency
+ * @brief Timed operations besides the commands.
+ */
+enum class Latency : unsigned {
+    LockWait,  // Waiting for a graph's mutex
+    LockHold,  // Holding a graph's mutex
+    HullBuild, // Building a graph's hull from all of its points (Newgraph, restore)
+    HullRead,  // Reading a hull's area or vertices for a query
+    Count
+};
+
+/**
+ * @enum Gauge
+ * @brief Current values, as opposed to counts.
+ */
+enum class Gauge : unsigned {
+    ProactorThreads, // Threads serving clients in a proactor mode
+    Count
+};
+
+const size_t METRIC_COMMANDS = static_cast<size_t>(CommandType::Unknown) + 1; // One histogram per CommandType
+
+/**
+ * @struct LatencyHistogram
+ * @brief Log2 histogram of durations with their sum.
+ */
+struct LatencyHistogram {
+    std::atomic<uint64_t> buckets[LATENCY_BUCKETS];
+    std::atomic<uint64_t> total_ns;
+};
+
+/**
+ * @struct ThreadMetrics
+ * @brief The metrics recorded by one thread; only that thread writes them.
+ */
+struct ThreadMetrics {
+    std::atomic<uint64_t> counters[static_cast<size_t>(Counter::Count)];
+    LatencyHistogram latencies[static_cast<size_t>(Latency::Count)];
+    LatencyHistogram commands[METRIC_COMMANDS];
+    std::atomic<bool> in_use{false}; // Claimed by a running thread
+    ThreadMetrics* next = nullptr;   // Next slot of the global list, immutable once published
+};
+
+extern thread_local ThreadMetrics* thread_metrics_slot; // The calling thread's slot, nullptr until claimed
+
+/**
+ * @brief Claims a free slot for the calling thread, or allocates one.
+ *
+ * The slot is handed back when the thread exits.
+ */
+ThreadMetrics* claim_thread_metrics();
+
+/**
+ * @brief Adds to a value only the calling thread writes.
+ */
+inline void metrics_bump(std::atomic<uint64_t>& value, uint64_t n) {
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Adds one duration to a histogram of the calling thread.
+ */
+inline void metrics_record_into(LatencyHistogram& histogram, uint64_t ns) {
+    unsigned bucket = ns ? 63 - __builtin_clzll(ns) : 0;
+    metrics_bump(histogram.buckets[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1], 1);
+    metrics_bump(histogram.total_ns, ns);
+}
+
+/**
+ * @brief Returns the calling thread's slot, claiming one on first use.
+ */
+inline ThreadMetrics& thread_metrics() {
+    ThreadMetrics* slot = thread_metrics_slot;
+    return slot ? *slot : *claim_thread_metrics();
+}
+
+/**
+ * @brief Monotonic clock for the timings, in nanoseconds; 0 without METRICS.
+ */
+inline uint64_t metrics_clock() {
+#if METRICS
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Counts n events.
+ */
+inline void metrics_count(Counter counter, uint64_t n = 1) {
+#if METRICS
+    metrics_bump(thread_metrics().counters[static_cast<size_t>(counter)], n);
+#else
+    (void)counter;
+    (void)n;
+#endif
+}
+
+/**
+ * @brief Records the duration of an operation that started at metrics_clock() time start.
+ */
+inline void metrics_record(Latency latency, uint64_t start) {
+#if METRICS
+    metrics_record_into(thread_metrics().latencies[static_cast<size_t>(latency)], metrics_clock() - start);
+#else
+    (void)latency;
+    (void)start;
+#endif
+}
+
+/**
+ * @brief Records the duration of a command that started at metrics_clock() time start.
+ */
+inline void metrics_record_command(CommandType command, uint64_t start) {
+#if METRICS
+    metrics_record_into(thread_metrics().commands[static_cast<size_t>(command)], metrics_clock() - start);
+#else
+    (void)command;
+    (void)start;
+#endif
+}
+
+/**
+ * @brief Adjusts a gauge; for rare events such as threads starting and exiting.
+ */
+void metrics_gauge_add(Gauge gauge, int64_t delta);
+
+/**
+ * @class TimedLock
+ * @brief std::lock_guard for a graph's mutex that records how long it waited and held it.
+ */
+class TimedLock {
+public:
+    explicit TimedLock(std::mutex& mutex) : mutex(mutex) {
+        uint64_t start = metrics_clock();
+        mutex.lock();
+        metrics_record(Latency::LockWait, start);
+        locked_at = metrics_clock();
+    }
+
+    ~TimedLock() {
+        mutex.unlock();
+        metrics_record(Latency::LockHold, locked_at);
+    }
+
+    TimedLock(const TimedLock&) = delete;
+    TimedLock& operator=(const TimedLock&) = delete;
+
+private:
+    std::mutex& mutex;
+    uint64_t locked_at; // metrics_clock() when the lock was taken
+};
+
+/**
+ * @brief Formats the Stats response body from every thread's metrics.
+ *
+ * Space-separated name=value fields: uptime_s, the counters and gauges, then
+ * one field per latency and per command that ran, as
+ * name=count/mean/p50/p99/max. Mean is exact; p50, p99 and max are the upper
+ * bounds of their log2 buckets. Times are in microseconds.
+ *
+ * @return The fields, without a trailing space.
+ */
+std::string metrics_report();
@@ -0,0 +1,182 @@
+#pragma once
+#include "GeometryUtils.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @file
+ * @brief On-disk copy of the server graph: binary snapshots plus an append-only change log.
+ *
+ * A state directory holds one snapshot and one or more numbered logs:
+ * - snapshot: a 64-byte SnapshotHeader, then all x coordinates, all y
+ *   coordinates and the hull vertices as x,y pairs, as doubles in the
+ *   producer's byte order.
+ * - log.G: the Newpoint/Removepoint changes made after the snapshot of
+ *   generation G was taken, as fixed-size LogRecords.
+ *
+ * Every snapshot starts a new log, and a log is deleted only once the
+ * snapshot that supersedes it is on disk. A snapshot of generation G replayed
+ * with the logs G, G+1, ... therefore reproduces the last graph even if the
+ * server stopped while a snapshot was being written.
+ *
+ * Changes are written with one write() each and no fsync(): they survive the
+ * server process being killed, not the machine losing power.
+ */
+
+#define SNAPSHOT_MAGIC "CHSNAPSH"         // First 8 bytes of a snapshot, no terminator
+#define STATE_BYTE_ORDER 0x01020304u      // Reads differently on a host of the other endianness
+#define SNAPSHOT_LOG_RECORDS (1 << 20)    // Logged changes that make a background snapshot due
+
+/**
+ * @struct SnapshotHeader
+ * @brief Fixed-size header at the start of a snapshot.
+ */
+struct SnapshotHeader {
+    char magic[8];        // SNAPSHOT_MAGIC
+    uint32_t byte_order;  // STATE_BYTE_ORDER as written by the producer
+    uint32_t reserved0;   // Written as 0
+    uint64_t generation;  // The first log to replay on top of this snapshot
+    uint64_t point_count; // Number of points
+    uint64_t hull_count;  // Number of hull vertices
+    uint64_t reserved[3]; // Written as 0
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "SnapshotHeader must stay 64 bytes");
+
+/**
+ * @enum LogOp
+ * @brief The change a LogRecord describes.
+ */
+enum class LogOp : uint32_t {
+    Insert = 1, // Newpoint
+    Remove = 2  // Removepoint that removed at least one copy
+};
+
+/**
+ * @struct LogRecord
+ * @brief One change in a log file.
+ */
+struct LogRecord {
+    uint32_t op;      // A LogOp value; anything else ends the replay
+    uint32_t padding; // Written as 0
+    double x, y;      // The point
+};
+
+static_assert(sizeof(LogRecord) == 24, "LogRecord must stay 24 bytes");
+
+/**
+ * @class StateStore
+ * @brief Persists a server's point set so a restart does not need the Newgraph upload again.
+ *
+ * open() maps the snapshot, replays the logs written after it and then keeps
+ * appending to the newest log. snapshot() copies the graph in O(n) while the
+ * caller holds its graph lock and writes the copy from a background thread,
+ * so the lock is never held for disk I/O.
+ *
+ * Until open() succeeds every call is a no-op, which leaves servers started
+ * without a state directory unchanged. Not thread-safe: the servers make all
+ * calls with their graph lock held.
+ */
+class StateStore {
+public:
+    StateStore() = default;
+    ~StateStore();
+    StateStore(const StateStore&) = delete;
+    StateStore& operator=(const StateStore&) = delete;
+
+    /**
+     * @brief Restores the graph saved in a state directory and starts logging into it.
+     *
+     * The directory is created if missing; an empty directory restores no points.
+     *
+     * @param dir The state directory.
+     * @param points Receives the saved point set.
+     * @param hull Receives the snapshot's hull in counter-clockwise order, or
+     *             is left empty when logged changes followed the snapshot.
+     * @param error Receives a message on failure.
+     * @return true on success.
+     */
+    bool open(const std::string& dir, PointCloud& points, std::vector<Point>& hull, std::string& error);
+
+    /**
+     * @brief True once open() has succeeded.
+     */
+    bool is_open() const { return log_fd >= 0; }
+
+    /**
+     * @brief Logs a point added by Newpoint.
+     *
+     * @param p The added point.
+     */
+    void log_insert(const Point& p);
+
+    /**
+     * @brief Logs a batch of points added by Newpoint with a single write().
+     *
+     * @param points The added points, in the order they were applied.
+     */
+    void log_inserts(const std::vector<Point>& points);
+
+    /**
+     * @brief Logs that every copy of a point was removed.
+     *
+     * @param p The removed point.
+     */
+    void log_remove(const Point& p);
+
+    /**
+     * @brief Logs a batch of points removed by Removepoints with a single write().
+     *
+     * @param points The points whose copies were removed.
+     */
+    void log_removes(const std::vector<Point>& points);
+
+    /**
+     * @brief True when SNAPSHOT_LOG_RECORDS changes were logged and no snapshot is being written.
+     */
+    bool snapshot_due() const;
+
+    /**
+     * @brief Starts writing a snapshot of the graph in the background.
+     *
+     * Copies the points and the hull, then switches to a new log. Waits for
+     * the previous snapshot first if that is still being written.
+     *
+     * @param points The current point set.
+     * @param hull Its hull vertices in counter-clockwise order.
+     * @return false if the store is not open or the new log cannot be created.
+     */
+    bool snapshot(const PointCloud& points, const std::vector<Point>& hull);
+
+private:
+    /**
+     * @brief Appends records to the current log, retrying short writes.
+     */
+    void append(const LogRecord* records, size_t count);
+
+    /**
+     * @brief Path of the log of a generation.
+     */
+    std::string log_path(uint64_t log_generation) const;
+
+    /**
+     * @brief Writes a copied graph to the snapshot file and deletes the logs it supersedes.
+     *
+     * Runs on the writer thread.
+     */
+    void write_snapshot(uint64_t snapshot_generation, std::vector<double> xs, std::vector<double> ys,
+                        std::vector<Point> hull);
+
+    std::string directory;             // State directory
+    int log_fd = -1;                   // Log receiving the changes, -1 while closed
+    uint64_t generation = 0;           // Generation of that log
+    uint64_t oldest_log = 0;           // Oldest log that may still exist on disk
+    size_t logged = 0;                 // Records appended since the last snapshot
+    std::vector<LogRecord> batch;      // Encoding buffer reused by the batch logs
+    std::thread writer;                // Writes the latest snapshot
+    std::atomic<bool> writing{false};  // True until the writer has finished
+};
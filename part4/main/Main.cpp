@@ -1,8 +1,12 @@
 #include "../include/GeometryUtils.hpp"
+#include "../include/CommandParser.hpp"
+#include "../include/InputBuffer.hpp"
+#include "../include/StateStore.hpp"
+#include "../include/Metrics.hpp"
 #include <iostream>
 #include <sstream>
 #include <string>
-#include <deque>
+#include <string_view>
 #include <unordered_map>
 #include <algorithm>
 #include <cctype>
@@ -12,189 +16,507 @@
 #include <sys/types.h>
 #include <sys/select.h>
 #include <cstring>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 #define PORT 9034
 #define MAX_CLIENTS 10
+#define POINT_WIRE_SIZE 16 // NewgraphBin point: x then y as little-endian IEEE-754 doubles
+#define DEFAULT_GRAPH "default" // Graph of a client that has not sent Use
+
+/**
+ * @struct Graph
+ * @brief One named point set with its hull and its log.
+ */
+struct Graph {
+    PointCloud point_set; // Current set of points forming the graph.
+    DynamicHull hull_engine; // Convex hull of point_set, updated in place by every Newpoint/Removepoint
+    StateStore state_store; // Snapshot and change log of point_set, idle unless --state is given
+};
 
 /**
  * @struct ClientState
  * @brief Represents per-client state, including input buffer for incomplete messages.
  */
 struct ClientState {
-    std::string inbuf;  // Accumulate input until newline
+    InputBuffer input;      // Received bytes not consumed yet
+    std::string outbuf;     // Responses of the current read, sent with a single send()
+    Graph* graph = nullptr; // Graph the client's commands apply to, DEFAULT_GRAPH until Use
+    // Pending Newgraph, staged here so the graph stays usable until the last point arrives
+    PointCloud temp_points;            // Points received so far
+    int points_to_read = 0;            // Points still expected, 0 when no Newgraph is pending
+    bool binary_graph = false;         // True while the client sends a NewgraphBin payload
+    bool binary_graph_invalid = false; // Set if that payload held a coordinate PointCloud cannot store
+    std::string upload_id;             // Request ID of a NewgraphBin, echoed with its final answer
 };
 
 // === Global State ===
 
-std::deque<Point> point_set; // Current set of points forming the shared graph.
-std::deque<Point> temp_points; // Temporary buffer for points being read during a Newgraph command.
-bool waiting_for_graph = false; // True if a client is currently building a new graph.
-int points_to_read = 0; // Number of remaining points expected after Newgraph.
-int newgraph_owner_fd = -1;  // fd of the client building the new graph
+thread_local HullWorkspace hull_workspace; // Scratch for hull walks, one per worker thread
+thread_local std::vector<Point> command_points; // Points of the Newpoints/Removepoints being run, one buffer per thread
+std::unordered_map<std::string, std::unique_ptr<Graph>> graphs; // Graphs by name, created by their first Use
+std::string state_root; // --state directory, empty if graphs are not persisted
 std::unordered_map<int, ClientState> clients; // Map of connected clients and their associated state.
 
 
 /**
- * @brief Checks if a given string is a valid floating-point number.
- * 
- * @param s The input string.
- * @return true if valid float, false otherwise.
+ * @brief Replaces a graph with the points a client staged for it.
+ *
+ * @param graph The graph being replaced.
+ * @param state The client that sent the points; its staging buffer is emptied.
  */
-bool is_number(const std::string& s) {
-    std::istringstream iss(s);
-    double d;
-    return (iss >> d) && iss.eof();
+void install_new_graph(Graph& graph, ClientState& state) {
+    graph.point_set.swap(state.temp_points);
+    PointCloud().swap(state.temp_points); // Releases the replaced points instead of keeping them per client
+    uint64_t start = metrics_clock();
+    graph.hull_engine.assign(graph.point_set);
+    metrics_record(Latency::HullBuild, start);
+    graph.state_store.snapshot(graph.point_set, graph.hull_engine.vertices(hull_workspace)); // The old log no longer applies
 }
 
 /**
- * @brief Trims CR/LF and leading spaces from a string.
- * 
- * @param s The string to trim (modified in-place).
+ * @brief Stages a point line received during a client's Newgraph.
+ *
+ * @param state The uploading client.
+ * @param line Input in the form "x,y".
+ * @return "OK", "GRAPH_LOADED", or an error message.
  */
-void trim_crlf(std::string &s) {
-    while (!s.empty() && (s.back() == '\n' || s.back() == '\r')) s.pop_back();
-    while (!s.empty() && std::isspace((unsigned char)s.front())) s.erase(s.begin());
+std::string handle_point_line(ClientState& state, std::string_view line) {
+    Point p;
+    ParseStatus status = parse_point(line, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid point format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid point values.";
+
+    state.temp_points.push_back(p);
+    if (--state.points_to_read > 0) return "OK";
+    install_new_graph(*state.graph, state);
+    return "GRAPH_LOADED";
 }
 
 /**
- * @brief Checks if a client is currently blocked due to another client's Newgraph.
+ * @brief Decodes a little-endian IEEE-754 double, whatever the host byte order.
  *
- * @param fd The file descriptor of the client.
- * @return true if the client is blocked, false otherwise.
+ * @param bytes Eight bytes, least significant first.
+ * @return The decoded value.
  */
-bool is_busy_for_fd(int fd) {
-    return waiting_for_graph && fd != newgraph_owner_fd;
+double read_le_double(const char* bytes) {
+    uint64_t bits = 0;
+    for (int i = 7; i >= 0; --i) bits = (bits << 8) | static_cast<unsigned char>(bytes[i]);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
 }
 
 /**
- * @brief Handles a point line received during a Newgraph phase.
- * 
- * @param line Input in the format x,y
- * @return "OK" or "GRAPH_LOADED" or an error message.
+ * @brief Prefixes a response with the request ID of the command it answers.
+ *
+ * @param id The ID without '#', empty for an untagged command.
+ * @param response The response; an empty one (no answer) stays empty.
+ * @return "#ID response", or response itself when there is nothing to tag.
  */
-std::string handle_point_line(const std::string& line) {
-    size_t comma = line.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid point format.";
-    std::string x_str = line.substr(0, comma);
-    std::string y_str = line.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid point values.";
-
-    Point p{std::stod(x_str), std::stod(y_str)};
-    temp_points.push_back(p);
-    points_to_read--;
-    if (points_to_read == 0) {
-        point_set = temp_points;
-        temp_points.clear();
-        waiting_for_graph = false;
-        newgraph_owner_fd = -1;
-        return "GRAPH_LOADED";
+std::string tag_response(std::string_view id, std::string response) {
+    if (id.empty() || response.empty()) return response;
+    std::string tagged;
+    tagged.reserve(id.size() + 2 + response.size());
+    tagged += '#';
+    tagged.append(id.data(), id.size());
+    tagged += ' ';
+    tagged += response;
+    return tagged;
+}
+
+/**
+ * @brief Moves the NewgraphBin points buffered so far straight into the client's staging buffer.
+ *
+ * Consumes whole points from the front of the client's unread input without
+ * any text parsing. A trailing partial point stays buffered for the next read.
+ *
+ * @param state The uploading client; consumed points are removed from its input.
+ * @return "GRAPH_LOADED" or an error once the payload is complete, "" while points are missing.
+ */
+std::string handle_binary_points(ClientState& state) {
+    InputBuffer& input = state.input;
+    std::string_view unread = input.unread();
+    size_t count = std::min(unread.size() / POINT_WIRE_SIZE, static_cast<size_t>(state.points_to_read));
+    const char* data = unread.data();
+    for (size_t i = 0; i < count; ++i, data += POINT_WIRE_SIZE) {
+        Point p{read_le_double(data), read_le_double(data + 8)};
+        if (!coord_fits(p.x) || !coord_fits(p.y)) state.binary_graph_invalid = true;
+        else state.temp_points.push_back(p);
     }
-    return "OK";
+    input.consume(count * POINT_WIRE_SIZE);
+    state.points_to_read -= static_cast<int>(count);
+    if (state.points_to_read > 0) return "";
+
+    state.binary_graph = false;
+    if (state.binary_graph_invalid) {
+        PointCloud().swap(state.temp_points);
+        return tag_response(state.upload_id, "ERROR: Invalid point values.");
+    }
+    install_new_graph(*state.graph, state);
+    return tag_response(state.upload_id, "GRAPH_LOADED");
+}
+
+/**
+ * @brief Starts a background snapshot once enough changes were logged since the last one.
+ *
+ * @param graph The graph that changed.
+ */
+void snapshot_if_due(Graph& graph) {
+    if (graph.state_store.snapshot_due()) graph.state_store.snapshot(graph.point_set, graph.hull_engine.vertices(hull_workspace));
 }
 
 /**
  * @brief Handles a Newpoint command from any client.
  * 
+ * @param graph The client's graph.
  * @param args Input in the format x,y
  * @return "OK" or error message.
  */
-std::string handle_newpoint(const std::string& args) {
-    size_t comma = args.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid format.";
-    std::string x_str = args.substr(0, comma);
-    std::string y_str = args.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid values.";
-    Point p{std::stod(x_str), std::stod(y_str)};
-    point_set.push_back(p);
+std::string handle_newpoint(Graph& graph, std::string_view args) {
+    Point p;
+    ParseStatus status = parse_point(args, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    graph.point_set.push_back(p);
+    graph.hull_engine.insert(p);
+    graph.state_store.log_insert(p);
+    snapshot_if_due(graph);
     return "OK";
 }
 
 /**
  * @brief Handles a Removepoint command from any client.
  * 
+ * @param graph The client's graph.
  * @param args Input in the format x,y
  * @return "OK" or error message.
  */
-std::string handle_removepoint(const std::string& args) {
-    size_t comma = args.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid format.";
-    std::string x_str = args.substr(0, comma);
-    std::string y_str = args.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid values.";
-    Point p{std::stod(x_str), std::stod(y_str)};
-    auto it = std::remove_if(point_set.begin(), point_set.end(),
-                             [&](const Point& q) { return q.x == p.x && q.y == p.y; });
-    if (it != point_set.end()) point_set.erase(it, point_set.end());
+std::string handle_removepoint(Graph& graph, std::string_view args) {
+    Point p;
+    ParseStatus status = parse_point(args, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    if (graph.point_set.remove_all(p) > 0) {
+        graph.hull_engine.erase(p);
+        graph.state_store.log_remove(p);
+        snapshot_if_due(graph);
+    }
+    return "OK";
+}
+
+/**
+ * @brief Parses the "k x1,y1;...;xk,yk" arguments of Newpoints and Removepoints.
+ *
+ * @param args Arguments after the command.
+ * @param points Receives the k points.
+ * @return An empty string on success, else the error message.
+ */
+std::string parse_point_batch(std::string_view args, std::vector<Point>& points) {
+    int n;
+    if (!parse_count(args, n) || n <= 0) return "ERROR: Invalid number.";
+    size_t space = args.find_first_of(" \t");
+    ParseStatus status = parse_point_list(space == std::string_view::npos ? std::string_view() : args.substr(space + 1), points);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    if (points.size() != static_cast<size_t>(n)) return "ERROR: Point count mismatch.";
+    return "";
+}
+
+/**
+ * @brief Adds a batch of points to the graph (via Newpoints).
+ *
+ * Either every point is added or, if any of them is invalid, none. The hull
+ * takes the batch in one insert_batch() call and the log in one write().
+ *
+ * @param graph The client's graph.
+ * @param args Arguments after the command (k x1,y1;...;xk,yk).
+ * @return Response message.
+ */
+std::string handle_newpoints(Graph& graph, std::string_view args) {
+    std::string error = parse_point_batch(args, command_points);
+    if (!error.empty()) return error;
+    for (const Point& p : command_points) graph.point_set.push_back(p);
+    graph.hull_engine.insert_batch(command_points);
+    graph.state_store.log_inserts(command_points);
+    snapshot_if_due(graph);
+    return "OK";
+}
+
+/**
+ * @brief Removes every copy of each point of a batch from the graph (via Removepoints).
+ *
+ * Validated and applied like Newpoints; points not in the graph are ignored.
+ *
+ * @param graph The client's graph.
+ * @param args Arguments after the command (k x1,y1;...;xk,yk).
+ * @return Response message.
+ */
+std::string handle_removepoints(Graph& graph, std::string_view args) {
+    std::string error = parse_point_batch(args, command_points);
+    if (!error.empty()) return error;
+    // Keep only the points that were present, which are the ones the hull and the log need
+    size_t removed = 0;
+    for (const Point& p : command_points) {
+        if (graph.point_set.remove_all(p) > 0) command_points[removed++] = p;
+    }
+    command_points.resize(removed);
+    if (removed > 0) {
+        graph.hull_engine.erase_batch(command_points);
+        graph.state_store.log_removes(command_points);
+        snapshot_if_due(graph);
+    }
     return "OK";
 }
 
 /**
  * @brief Handles the CH command: computes and returns the convex hull area.
  *
+ * @param graph The client's graph.
  * @return String containing the area.
  */
-std::string handle_ch() {
-    auto hull = compute_convex_hull_deque(point_set);
-    double area = compute_area(hull);
+std::string handle_ch(Graph& graph) {
+    uint64_t start = metrics_clock();
+    double area = graph.hull_engine.area(hull_workspace);
+    metrics_record(Latency::HullRead, start);
     std::ostringstream oss;
     oss << area;
     return oss.str();
 }
 
 /**
- * @brief Processes a full line received from a client.
- * 
- * @param fd The client's socket file descriptor.
- * @param rawline The raw input line from the client.
- * @return Response to be sent back to the client.
+ * @brief Answers the queries computed from the hull alone.
+ *
+ * Walks the maintained hull in O(h log n), so no query looks at the point set.
+ * - CHPoints: "h x1,y1;...;xh,yh", the vertices counter-clockwise.
+ * - Perimeter, Diameter: a number.
+ * - Contains x,y: "YES" if the point is inside or on the hull, else "NO", in O(log h).
+ * - MinBoundingRect: "area x1,y1;...;x4,y4", the corners counter-clockwise, or
+ *   "0" for an empty graph.
+ *
+ * @param graph The client's graph.
+ * @param command CHPoints, Perimeter, Contains, Diameter or MinBoundingRect.
+ * @param args Arguments after the command (x,y for Contains).
+ * @return Response message.
  */
-std::string process_line(int fd, const std::string& rawline) {
-    std::string line = rawline;
-    trim_crlf(line);
-    if (line.empty()) return "";
+std::string handle_hull_query(Graph& graph, CommandType command, std::string_view args) {
+    Point p{0, 0};
+    if (command == CommandType::Contains) {
+        ParseStatus status = parse_point(args, p);
+        if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+        if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    }
+    const std::vector<Point>& hull = graph.hull_engine.vertices(hull_workspace);
 
-    if (waiting_for_graph && fd != newgraph_owner_fd) {
-        return "BUSY";
+    std::ostringstream oss;
+    switch (command) {
+    case CommandType::CHPoints: {
+        std::string response = std::to_string(hull.size());
+        if (!hull.empty()) response += ' ';
+        format_point_list(hull.data(), hull.size(), response);
+        return response;
+    }
+    case CommandType::Perimeter:
+        oss << compute_perimeter(hull);
+        return oss.str();
+    case CommandType::Contains:
+        return hull_contains(hull, p) ? "YES" : "NO";
+    case CommandType::Diameter:
+        oss << hull_diameter(hull);
+        return oss.str();
+    default: {
+        if (hull.empty()) return "0";
+        BoundingRect rect = min_bounding_rect(hull);
+        oss << rect.area << ' ';
+        std::string response = oss.str();
+        format_point_list(rect.corners, 4, response);
+        return response;
+    }
+    }
+}
+
+/**
+ * @brief Handles the Snapshot command: writes the graph to the state directory now.
+ *
+ * @param graph The client's graph.
+ * @return "OK" once the background write has started, or an error message.
+ */
+std::string handle_snapshot(Graph& graph) {
+    if (!graph.state_store.is_open()) return "ERROR: No state directory.";
+    if (!graph.state_store.snapshot(graph.point_set, graph.hull_engine.vertices(hull_workspace))) return "ERROR: Snapshot failed.";
+    return "OK";
+}
+
+/**
+ * @brief Returns the graph with the given name, creating it on first use.
+ *
+ * With a state directory a new graph is restored from its own
+ * subdirectory (the directory itself for DEFAULT_GRAPH, graph.NAME for
+ * the others).
+ *
+ * @param name A name accepted by valid_graph_name().
+ * @param error Receives a message if the graph cannot be restored.
+ * @return The graph, or nullptr on failure.
+ */
+Graph* open_graph(const std::string& name, std::string& error) {
+    auto it = graphs.find(name);
+    if (it != graphs.end()) return it->second.get();
+
+    std::unique_ptr<Graph> graph(new Graph);
+    if (!state_root.empty()) {
+        std::string dir = name == DEFAULT_GRAPH ? state_root : state_root + "/graph." + name;
+        std::vector<Point> saved_hull; // DynamicHull rebuilds its own
+        if (!graph->state_store.open(dir, graph->point_set, saved_hull, error)) return nullptr;
+        uint64_t start = metrics_clock();
+        graph->hull_engine.assign(graph->point_set);
+        metrics_record(Latency::HullBuild, start);
+        if (!graph->point_set.empty())
+            std::cout << "Restored " << graph->point_set.size() << " point(s) of " << name << " from " << dir << std::endl;
     }
+    return graphs.emplace(name, std::move(graph)).first->second.get();
+}
 
-    if (waiting_for_graph && fd == newgraph_owner_fd) {
-        return handle_point_line(line);
+/**
+ * @brief Handles the Use command: switches the client to another graph.
+ *
+ * @param state The client's state.
+ * @param args The graph name.
+ * @return "OK" or an error message.
+ */
+std::string handle_use(ClientState& state, std::string_view args) {
+    if (!valid_graph_name(args)) return "ERROR: Invalid graph name.";
+    std::string error;
+    Graph* graph = open_graph(std::string(args), error);
+    if (!graph) {
+        std::cerr << "Cannot restore graph " << args << ": " << error << std::endl;
+        return "ERROR: Cannot open graph.";
     }
+    state.graph = graph;
+    return "OK";
+}
+
+/**
+ * @brief Handles the Stats command: reports the server's counters and latencies.
+ *
+ * Appends the number of graphs and their total point count to metrics_report().
+ *
+ * @return The report, or an error if the server was built with METRICS=0.
+ */
+std::string handle_stats() {
+#if METRICS
+    size_t points = 0;
+    for (auto& entry : graphs) points += entry.second->point_set.size();
+    return metrics_report() + " graphs=" + std::to_string(graphs.size()) + " points=" + std::to_string(points);
+#else
+    return "ERROR: Metrics are disabled.";
+#endif
+}
 
-    std::istringstream iss(line);
-    std::string command;
-    iss >> command;
-    std::string args;
-    std::getline(iss, args);
-    size_t pos = args.find_first_not_of(" "); // finds the index of the first non-space character.
-    if (pos != std::string::npos) args.erase(0, pos); // if found—removes leading whitespace.
-    else args.clear(); // else—clears (no arguments).
-
-    if (command == "Newgraph") {
-        std::istringstream a(args);
+/**
+ * @brief Executes one command line, once its request ID is split off.
+ * 
+ * @param state The client's state, which selects its graph.
+ * @param line The trimmed command or point line.
+ * @param command Receives the parsed command; left unchanged for a point line.
+ * @return Response to be sent back to the client.
+ */
+std::string run_command(ClientState& state, std::string_view line, CommandType& command) {
+    Graph& graph = *state.graph;
+
+    if (state.points_to_read > 0) return handle_point_line(state, line);
+
+    std::string_view args;
+    command = parse_command(line, args);
+
+    if (command == CommandType::Newgraph) {
         int n;
-        if (!(a >> n) || n <= 0) return "ERROR: Invalid number.";
-        waiting_for_graph = true;
-        newgraph_owner_fd = fd;
-        points_to_read = n;
-        temp_points.clear();
+        if (!parse_count(args, n) || n <= 0) return "ERROR: Invalid number.";
+        state.binary_graph = false;
+        state.points_to_read = n;
+        state.temp_points.clear();
+        state.temp_points.reserve(std::min(n, 1 << 20)); // Cap what an untrusted count can preallocate
         return "OK";
     }
-    if (command == "Newpoint") return handle_newpoint(args);
-    if (command == "Removepoint") return handle_removepoint(args);
-    if (command == "CH") return handle_ch();
+    if (command == CommandType::NewgraphBin) {
+        int n;
+        if (!parse_count(args, n) || n <= 0) return "ERROR: Invalid number.";
+        state.binary_graph = true;
+        state.binary_graph_invalid = false;
+        state.points_to_read = n;
+        state.temp_points.clear();
+        state.temp_points.reserve(std::min(n, 1 << 20)); // Cap what an untrusted count can preallocate
+        return ""; // Acknowledged once, after the payload
+    }
+    if (command == CommandType::Newpoint) return handle_newpoint(graph, args);
+    if (command == CommandType::Removepoint) return handle_removepoint(graph, args);
+    if (command == CommandType::Newpoints) return handle_newpoints(graph, args);
+    if (command == CommandType::Removepoints) return handle_removepoints(graph, args);
+    if (command == CommandType::CH) return handle_ch(graph);
+    if (command == CommandType::CHPoints || command == CommandType::Perimeter || command == CommandType::Contains ||
+        command == CommandType::Diameter || command == CommandType::MinBoundingRect)
+        return handle_hull_query(graph, command, args);
+    if (command == CommandType::Snapshot) return handle_snapshot(graph);
+    if (command == CommandType::Use) return handle_use(state, args);
+    if (command == CommandType::Stats) return handle_stats();
 
     return "ERROR: Unknown command.";
 }
 
+/**
+ * @brief Answers a line received from a client, echoing its request ID if it has one.
+ *
+ * @param state The client's state, which selects its graph.
+ * @param rawline The raw input line.
+ * @return Response string, "" if the line needs no answer yet.
+ */
+std::string process_line(ClientState& state, std::string_view rawline) {
+    std::string_view line = trim_line(rawline);
+    if (line.empty()) return "";
+    std::string_view id;
+    if (!split_request_id(line, id)) return "ERROR: Invalid request ID.";
+    CommandType command = CommandType::Unknown;
+    bool timed = state.points_to_read == 0; // Lines of a Newgraph upload are not commands
+    uint64_t start = metrics_clock();
+    std::string response = run_command(state, line, command);
+    if (timed) metrics_record_command(command, start);
+    if (state.binary_graph && response.empty()) state.upload_id.assign(id.data(), id.size()); // Answered after the payload
+    return tag_response(id, std::move(response));
+}
+
 /**
  * @brief Main function that runs the TCP server event loop.
  * 
  * Accepts multiple clients, manages their states, and processes their commands.
+ *
+ * Options:
+ * - --state DIR: restore the graphs saved in DIR when they are first used,
+ *   then keep DIR up to date with change logs and snapshots (every Newgraph,
+ *   every SNAPSHOT_LOG_RECORDS changes and on the Snapshot command).
  * 
- * @return Always returns 0 (infinite loop unless externally interrupted).
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments (see the options above).
+ * @return 1 on invalid arguments or an unusable state directory; otherwise runs until interrupted.
  */
-int main() {
+int main(int argc, char* argv[]) {
+    const char* state_dir = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--state") == 0 && i + 1 < argc) {
+            state_dir = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--state DIR]" << std::endl;
+            return 1;
+        }
+    }
+    if (state_dir) state_root = state_dir;
+    std::string error;
+    Graph* default_graph = open_graph(DEFAULT_GRAPH, error);
+    if (!default_graph) {
+        std::cerr << "Cannot restore the graph: " << error << std::endl;
+        return 1;
+    }
+
     // Create a TCP socket (IPv4, stream-based)
     int listener = socket(AF_INET, SOCK_STREAM, 0);
 
@@ -219,7 +541,9 @@ int main() {
     // Main loop to handle incoming connections and data
     while (true) {
         read_fds = master; // Copy master set to a temporary set
-        select(fdmax + 1, &read_fds, nullptr, nullptr, nullptr); // Wait for activity
+        int ready = select(fdmax + 1, &read_fds, nullptr, nullptr, nullptr); // Wait for activity
+        metrics_count(Counter::LoopIterations);
+        if (ready > 0) metrics_count(Counter::LoopReadyFds, ready);
 
         // Loop through all file descriptors
         for (int i = 0; i <= fdmax; ++i) {
@@ -229,33 +553,37 @@ int main() {
                     FD_SET(newfd, &master); // Add new client socket to the master set
                     if (newfd > fdmax) fdmax = newfd; // Update max fd if needed
                     clients[newfd] = ClientState{};  // Initialize client state
+                    clients[newfd].graph = default_graph;
                 } else {   // Data from an existing client
-                    char buffer[1024];
-                    int bytes = recv(i, buffer, sizeof(buffer), 0); // Receive data
+                    ClientState& state = clients[i];
+                    InputBuffer& input = state.input;
+                    int bytes = recv(i, input.write_area(), input.write_size(), 0); // Receive straight into the buffer
                     if (bytes <= 0) { // Connection closed or error
                         close(i);  // Close the socket
                         FD_CLR(i, &master);  // Remove from master set
-                        clients.erase(i); // Remove client from map
-                        // If this client was uploading a graph, reset graph state
-                        if (waiting_for_graph && i == newgraph_owner_fd) {
-                            waiting_for_graph = false;
-                            temp_points.clear();
-                            newgraph_owner_fd = -1;
-                        }
+                        clients.erase(i); // Remove client from map, dropping any upload it staged
                     } else {                   // Received some data
-                        std::string& inbuf = clients[i].inbuf; // Get client's input buffer
-                        inbuf.append(buffer, bytes);           // Append new data
-                        size_t pos;
+                        input.commit(bytes);
                         // Process each complete line of data
-                        while ((pos = inbuf.find('\n')) != std::string::npos) {
-                            std::string line = inbuf.substr(0, pos + 1); // Extract line
-                            inbuf.erase(0, pos + 1);                    // Remove it from buffer
-                            std::string response = process_line(i, line); // Handle the line
-                            if (!response.empty()) { // Send response back to client
-                                response += "\n";
-                                send(i, response.c_str(), response.size(), 0);
+                        while (true) {
+                            std::string_view line;
+                            std::string response;
+                            if (state.binary_graph) {
+                                response = handle_binary_points(state);
+                                if (response.empty()) break; // Rest of the payload is still in flight
+                            } else {
+                                if (!input.next_line(line)) break; // Slice of the buffer, no copy
+                                response = process_line(state, line); // Handle the line
+                            }
+                            if (!response.empty()) { // Queue response for the client
+                                state.outbuf += response;
+                                state.outbuf += '\n';
                             }
                         }
+                        if (!state.outbuf.empty()) { // One send for every response of this read
+                            send(i, state.outbuf.data(), state.outbuf.size(), 0);
+                            state.outbuf.clear();
+                        }
                     }
                 }
             }
@@ -44,3 +44,59 @@ int removeFdFromReactor(void* reactor, int fd);
  * @return 0 on success, or -1 on failure.
  */
 int stopReactor(void* reactor);
+
+/**
+ * @brief Starts a pool of reactors, each running its own event loop thread.
+ *
+ * Descriptors added to the pool are spread over the loops, so callbacks of
+ * different descriptors run in parallel. Callbacks may therefore run
+ * concurrently and must synchronize any shared state.
+ *
+ * @param n Number of loops; 0 or less starts one per hardware thread.
+ * @return A pointer to the pool (opaque to user), or nullptr on failure.
+ */
+void* startReactorPool(int n);
+
+/**
+ * @brief Returns the number of event loops in a pool.
+ *
+ * @param pool The pool returned by `startReactorPool`.
+ */
+int reactorPoolSize(void* pool);
+
+/**
+ * @brief Registers a file descriptor and its callback with one loop of the pool.
+ *
+ * @param pool The pool returned by `startReactorPool`.
+ * @param fd The file descriptor to monitor.
+ * @param func The callback function to invoke when the fd is ready.
+ * @param loop Index of the loop to use, or -1 for the loop watching the fewest descriptors.
+ * @return 0 on success, or -1 on failure.
+ */
+int addFdToReactorPool(void* pool, int fd, reactorFunc func, int loop = -1);
+
+/**
+ * @brief Removes a file descriptor from whichever loop of the pool watches it.
+ *
+ * @param pool The pool instance.
+ * @param fd The file descriptor to remove.
+ * @return 0 on success, or -1 on failure.
+ */
+int removeFdFromReactorPool(void* pool, int fd);
+
+/**
+ * @brief Returns the index of the loop watching a file descriptor.
+ *
+ * @param pool The pool instance.
+ * @param fd A registered file descriptor.
+ * @return The loop index, or -1 if fd is not registered.
+ */
+int reactorPoolLoopOf(void* pool, int fd);
+
+/**
+ * @brief Stops every loop of the pool and frees its resources.
+ *
+ * @param pool The pool instance to stop.
+ * @return 0 on success, or -1 on failure.
+ */
+int stopReactorPool(void* pool);
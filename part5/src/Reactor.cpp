@@ -1,11 +1,20 @@
 #include "../include/Reactor.hpp"
 #include <unordered_map>
 #include <sys/select.h>
+#if defined(__linux__)
+#define REACTOR_EPOLL 1
+#include <sys/epoll.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#define REACTOR_KQUEUE 1
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
 #include <unistd.h>
 #include <thread>
 #include <mutex>
 #include <atomic>
 #include <vector>
+#include <algorithm>
 
 /**
  * @struct Reactor
@@ -19,62 +28,146 @@ struct Reactor {
     std::mutex lock;
     std::atomic<bool> running;
     std::thread loopThread;
+    int pollFd;
 };
 
 /**
- * @brief The internal loop that runs the reactor.
+ * @brief Maximum number of ready descriptors fetched per wait.
+ */
+static const int REACTOR_MAX_EVENTS = 256;
+
+/**
+ * @brief Opens the kernel event queue backing the reactor.
  *
- * Uses `select()` to monitor all registered file descriptors.
- * When a descriptor becomes ready, the associated callback is invoked.
+ * @param reactor Pointer to the reactor instance.
+ * @return true on success.
+ */
+static bool openPoller(Reactor* reactor) {
+#if defined(REACTOR_EPOLL)
+    reactor->pollFd = epoll_create1(EPOLL_CLOEXEC);
+#elif defined(REACTOR_KQUEUE)
+    reactor->pollFd = kqueue();
+#else
+    reactor->pollFd = -1;
+    return true;
+#endif
+    return reactor->pollFd >= 0;
+}
+
+/**
+ * @brief Starts watching a descriptor for readability. Called with `lock` held.
  *
  * @param reactor Pointer to the reactor instance.
+ * @param fd The file descriptor to watch.
+ * @return 0 on success, -1 on failure.
  */
-static void reactorLoop(Reactor* reactor) {
-    while (reactor->running) {
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        int maxfd = -1;
-
-        {
-            std::lock_guard<std::mutex> guard(reactor->lock);
-            for (const auto& pair : reactor->handlers) {
-                FD_SET(pair.first, &readfds);
-                if (pair.first > maxfd) maxfd = pair.first;
-            }
-        }
+static int watchFd(Reactor* reactor, int fd) {
+#if defined(REACTOR_EPOLL)
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    return epoll_ctl(reactor->pollFd, EPOLL_CTL_ADD, fd, &ev) == 0 ? 0 : -1;
+#elif defined(REACTOR_KQUEUE)
+    struct kevent ev;
+    EV_SET(&ev, fd, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+    return kevent(reactor->pollFd, &ev, 1, nullptr, 0, nullptr) == 0 ? 0 : -1;
+#else
+    (void)reactor;
+    return fd < FD_SETSIZE ? 0 : -1;
+#endif
+}
+
+/**
+ * @brief Stops watching a descriptor. Called with `lock` held.
+ *
+ * Errors are ignored: the kernel already dropped the registration if the
+ * descriptor was closed first.
+ *
+ * @param reactor Pointer to the reactor instance.
+ * @param fd The file descriptor to forget.
+ */
+static void unwatchFd(Reactor* reactor, int fd) {
+#if defined(REACTOR_EPOLL)
+    epoll_ctl(reactor->pollFd, EPOLL_CTL_DEL, fd, nullptr);
+#elif defined(REACTOR_KQUEUE)
+    struct kevent ev;
+    EV_SET(&ev, fd, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+    kevent(reactor->pollFd, &ev, 1, nullptr, 0, nullptr);
+#else
+    (void)reactor;
+    (void)fd;
+#endif
+}
 
-        if (maxfd == -1) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            continue;
+/**
+ * @brief Waits up to one second and collects the descriptors that are ready.
+ *
+ * epoll (Linux) and kqueue (BSD/macOS) keep the registrations in the kernel
+ * and return only the ready descriptors, so a wakeup costs O(ready) and there
+ * is no FD_SETSIZE limit. Other systems rebuild an fd_set for select().
+ *
+ * @param reactor Pointer to the reactor instance.
+ * @param ready Receives the ready file descriptors.
+ */
+static void waitForEvents(Reactor* reactor, std::vector<int>& ready) {
+    ready.clear();
+#if defined(REACTOR_EPOLL)
+    epoll_event events[REACTOR_MAX_EVENTS];
+    int n = epoll_wait(reactor->pollFd, events, REACTOR_MAX_EVENTS, 1000);
+    for (int i = 0; i < n; ++i) ready.push_back(events[i].data.fd);
+#elif defined(REACTOR_KQUEUE)
+    struct kevent events[REACTOR_MAX_EVENTS];
+    struct timespec timeout = {1, 0};
+    int n = kevent(reactor->pollFd, nullptr, 0, events, REACTOR_MAX_EVENTS, &timeout);
+    for (int i = 0; i < n; ++i) ready.push_back(static_cast<int>(events[i].ident));
+#else
+    fd_set readfds;
+    FD_ZERO(&readfds);
+    int maxfd = -1;
+    {
+        std::lock_guard<std::mutex> guard(reactor->lock);
+        for (const auto& pair : reactor->handlers) {
+            FD_SET(pair.first, &readfds);
+            if (pair.first > maxfd) maxfd = pair.first;
         }
+    }
 
-        struct timeval tv = {1, 0};
-        int ready = select(maxfd + 1, &readfds, nullptr, nullptr, &tv);
+    if (maxfd == -1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        return;
+    }
 
-        if (ready > 0) {
-            std::vector<int> ready_fds;
+    struct timeval tv = {1, 0};
+    if (select(maxfd + 1, &readfds, nullptr, nullptr, &tv) <= 0) return;
+
+    std::lock_guard<std::mutex> guard(reactor->lock);
+    for (const auto& pair : reactor->handlers) {
+        if (FD_ISSET(pair.first, &readfds)) ready.push_back(pair.first);
+    }
+#endif
+}
+
+/**
+ * @brief The internal loop that runs the reactor.
+ *
+ * Waits for ready descriptors and invokes the callback of each one that is
+ * still registered; a callback may remove other descriptors before their turn.
+ *
+ * @param reactor Pointer to the reactor instance.
+ */
+static void reactorLoop(Reactor* reactor) {
+    std::vector<int> ready_fds;
+    while (reactor->running) {
+        waitForEvents(reactor, ready_fds);
+        for (int fd : ready_fds) {
+            reactorFunc func;
             {
                 std::lock_guard<std::mutex> guard(reactor->lock);
-                for (const auto& pair : reactor->handlers) {
-                    if (FD_ISSET(pair.first, &readfds)) {
-                        ready_fds.push_back(pair.first);
-                    }
-                }
-            }
-
-            for (int fd : ready_fds) {
-                reactorFunc func;
-                {
-                    std::lock_guard<std::mutex> guard(reactor->lock);
-                    auto it = reactor->handlers.find(fd);
-                    if (it != reactor->handlers.end()) {
-                        func = it->second;
-                    } else {
-                        continue;
-                    }
-                }
-                func(fd);
+                auto it = reactor->handlers.find(fd);
+                if (it == reactor->handlers.end()) continue;
+                func = it->second;
             }
+            func(fd);
         }
     }
 }
@@ -88,6 +181,10 @@ static void reactorLoop(Reactor* reactor) {
  */
 void* startReactor() {
     Reactor* reactor = new Reactor;
+    if (!openPoller(reactor)) {
+        delete reactor;
+        return nullptr;
+    }
     reactor->running = true;
     reactor->loopThread = std::thread(reactorLoop, reactor);
     return reactor;
@@ -106,6 +203,7 @@ void* startReactor() {
 int addFdToReactor(void* reactorPtr, int fd, reactorFunc func) {
     Reactor* reactor = static_cast<Reactor*>(reactorPtr);
     std::lock_guard<std::mutex> guard(reactor->lock);
+    if (reactor->handlers.find(fd) == reactor->handlers.end() && watchFd(reactor, fd) != 0) return -1;
     reactor->handlers[fd] = func;
     return 0;
 }
@@ -122,7 +220,7 @@ int addFdToReactor(void* reactorPtr, int fd, reactorFunc func) {
 int removeFdFromReactor(void* reactorPtr, int fd) {
     Reactor* reactor = static_cast<Reactor*>(reactorPtr);
     std::lock_guard<std::mutex> guard(reactor->lock);
-    reactor->handlers.erase(fd);
+    if (reactor->handlers.erase(fd) > 0) unwatchFd(reactor, fd);
     return 0;
 }
 
@@ -140,6 +238,143 @@ int stopReactor(void* reactorPtr) {
     if (reactor->loopThread.joinable()) {
         reactor->loopThread.join();
     }
+    if (reactor->pollFd >= 0) close(reactor->pollFd);
     delete reactor;
     return 0;
 }
+
+/**
+ * @struct ReactorPool
+ * @brief Several reactors sharing the descriptors of one server.
+ */
+struct ReactorPool {
+    std::vector<Reactor*> loops;
+    std::unordered_map<int, size_t> owner; // Loop index watching each descriptor
+    std::mutex lock;                        // Guards `owner` and `next`
+    size_t next = 0;                        // Where the next least-loaded scan starts
+};
+
+/**
+ * @brief Picks the loop watching the fewest descriptors. Called with the pool lock held.
+ *
+ * Scanning starts after the previous pick, so equally loaded loops are used round-robin.
+ *
+ * @param pool Pointer to the pool instance.
+ * @return Index of the chosen loop.
+ */
+static size_t leastLoadedLoop(ReactorPool* pool) {
+    size_t n = pool->loops.size(), best = pool->next % n, bestLoad = static_cast<size_t>(-1);
+    for (size_t k = 0; k < n; ++k) {
+        size_t i = (pool->next + k) % n;
+        std::lock_guard<std::mutex> guard(pool->loops[i]->lock);
+        if (pool->loops[i]->handlers.size() < bestLoad) {
+            bestLoad = pool->loops[i]->handlers.size();
+            best = i;
+        }
+    }
+    pool->next = best + 1;
+    return best;
+}
+
+/**
+ * @brief Starts n reactors, each with its own loop thread.
+ *
+ * @param n Number of loops; 0 or less starts one per hardware thread.
+ * @return Pointer to the pool, or nullptr on failure.
+ */
+void* startReactorPool(int n) {
+    if (n <= 0) n = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    ReactorPool* pool = new ReactorPool;
+    for (int i = 0; i < n; ++i) {
+        void* loop = startReactor();
+        if (!loop) {
+            stopReactorPool(pool);
+            return nullptr;
+        }
+        pool->loops.push_back(static_cast<Reactor*>(loop));
+    }
+    return pool;
+}
+
+/**
+ * @brief Returns the number of loops in the pool.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @return The loop count.
+ */
+int reactorPoolSize(void* poolPtr) {
+    return static_cast<int>(static_cast<ReactorPool*>(poolPtr)->loops.size());
+}
+
+/**
+ * @brief Registers a file descriptor with one loop of the pool.
+ *
+ * A descriptor that is already registered keeps its loop and only gets the new callback.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @param fd The file descriptor to monitor.
+ * @param func The callback function to invoke when the fd is ready.
+ * @param loop Index of the loop to use, or -1 for the least loaded one.
+ * @return 0 on success, -1 on failure.
+ */
+int addFdToReactorPool(void* poolPtr, int fd, reactorFunc func, int loop) {
+    ReactorPool* pool = static_cast<ReactorPool*>(poolPtr);
+    std::lock_guard<std::mutex> guard(pool->lock);
+    size_t index;
+    auto it = pool->owner.find(fd);
+    if (it != pool->owner.end()) {
+        index = it->second;
+    } else if (loop >= 0) {
+        if (static_cast<size_t>(loop) >= pool->loops.size()) return -1;
+        index = static_cast<size_t>(loop);
+    } else {
+        index = leastLoadedLoop(pool);
+    }
+    if (addFdToReactor(pool->loops[index], fd, func) != 0) return -1;
+    pool->owner[fd] = index;
+    return 0;
+}
+
+/**
+ * @brief Removes a file descriptor from the loop that watches it.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @param fd The file descriptor to remove.
+ * @return 0 on success, -1 on failure.
+ */
+int removeFdFromReactorPool(void* poolPtr, int fd) {
+    ReactorPool* pool = static_cast<ReactorPool*>(poolPtr);
+    std::lock_guard<std::mutex> guard(pool->lock);
+    auto it = pool->owner.find(fd);
+    if (it == pool->owner.end()) return 0;
+    removeFdFromReactor(pool->loops[it->second], fd);
+    pool->owner.erase(it);
+    return 0;
+}
+
+/**
+ * @brief Returns the index of the loop watching a file descriptor.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @param fd A registered file descriptor.
+ * @return The loop index, or -1 if fd is not registered.
+ */
+int reactorPoolLoopOf(void* poolPtr, int fd) {
+    ReactorPool* pool = static_cast<ReactorPool*>(poolPtr);
+    std::lock_guard<std::mutex> guard(pool->lock);
+    auto it = pool->owner.find(fd);
+    return it == pool->owner.end() ? -1 : static_cast<int>(it->second);
+}
+
+/**
+ * @brief Stops every loop of the pool, joins their threads and deletes the pool.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @return 0 on success, -1 on failure.
+ */
+int stopReactorPool(void* poolPtr) {
+    ReactorPool* pool = static_cast<ReactorPool*>(poolPtr);
+    for (Reactor* loop : pool->loops) stopReactor(loop);
+    delete pool;
+    return 0;
+}
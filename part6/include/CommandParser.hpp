@@ -0,0 +1,136 @@
+#pragma once
+#include "GeometryUtils.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define GRAPH_NAME_MAX 64 // Longest accepted graph name
+#define REQUEST_ID_MAX 32 // Longest accepted request ID
+
+/**
+ * @file
+ * @brief Allocation-free parsing of command lines and "x,y" point text, and its inverse for responses.
+ *
+ * Every function works on std::string_view slices of the caller's buffer and
+ * converts numbers with std::from_chars, so a line is parsed without copies,
+ * streams or heap allocations.
+ */
+
+/**
+ * @enum CommandType
+ * @brief The command named by the first token of a line.
+ */
+enum class CommandType {
+    Newgraph, NewgraphBin, Newpoint, Newpoints, Removepoint, Removepoints, CH, Snapshot, Use,
+    CHPoints, Perimeter, Contains, Diameter, MinBoundingRect, // Queries answered from the hull alone
+    Subscribe, Unsubscribe, // Area-threshold events, served by part10
+    Stats,                  // Counters and latency histograms, see Metrics.hpp
+    Unknown
+};
+
+/**
+ * @brief Returns the command token of a type, e.g. "Newpoint", or "Unknown".
+ */
+const char* command_name(CommandType type);
+
+/**
+ * @enum ParseStatus
+ * @brief Outcome of parsing a point.
+ */
+enum class ParseStatus {
+    Ok,        // Both coordinates parsed
+    BadFormat, // No comma separating x and y
+    BadValue   // A coordinate is not a finite number
+};
+
+/**
+ * @brief Strips leading and trailing whitespace, including CR and LF.
+ *
+ * @param line The raw line.
+ * @return The trimmed slice of line.
+ */
+std::string_view trim_line(std::string_view line);
+
+/**
+ * @brief Parses a whole field as a finite double.
+ *
+ * Leading whitespace and a leading '+' are accepted; anything after the number is not.
+ *
+ * @param field The text to parse.
+ * @param value Receives the number on success.
+ * @return true if the whole field is a finite number.
+ */
+bool parse_number(std::string_view field, double& value);
+
+/**
+ * @brief Parses the leading integer of a field, ignoring what follows it.
+ *
+ * @param field The text to parse.
+ * @param value Receives the number on success.
+ * @return true if the field starts with an integer.
+ */
+bool parse_count(std::string_view field, int& value);
+
+/**
+ * @brief Parses "x,y" into a point, rounded to the precision PointCloud stores (see PointCoord).
+ *
+ * @param text The point text.
+ * @param p Receives the point on success.
+ * @return Ok, BadFormat if there is no comma, or BadValue if a coordinate is invalid or out of range.
+ */
+ParseStatus parse_point(std::string_view text, Point& p);
+
+/**
+ * @brief Parses a ';'-separated list of "x,y" points, as taken by Newpoints and Removepoints.
+ *
+ * Whitespace around each point is ignored, as is one trailing ';'.
+ *
+ * @param text The point list.
+ * @param points Cleared, then receives the points; its capacity is reused.
+ * @return Ok, or the status of the first point that does not parse.
+ */
+ParseStatus parse_point_list(std::string_view text, std::vector<Point>& points);
+
+/**
+ * @brief Appends points in the format parse_point_list() reads, "x1,y1;x2,y2;...".
+ *
+ * Coordinates are written in the shortest form that parses back to the same double.
+ *
+ * @param points The points.
+ * @param count Number of points.
+ * @param out The string to append to.
+ */
+void format_point_list(const Point* points, size_t count, std::string& out);
+
+/**
+ * @brief Checks a graph name given to Use.
+ *
+ * Names are 1 to GRAPH_NAME_MAX letters, digits, '_', '-' or '.', not
+ * starting with '.', so they can double as file names.
+ *
+ * @param name The name, without surrounding whitespace.
+ * @return true if the name is valid.
+ */
+bool valid_graph_name(std::string_view name);
+
+/**
+ * @brief Splits an optional "#ID " request-ID prefix off a trimmed line.
+ *
+ * IDs are 1 to REQUEST_ID_MAX letters, digits, '_' or '-'. The caller echoes
+ * the ID in front of the command's response, so a client can send many
+ * commands without waiting and still match every answer to its command.
+ *
+ * @param line A line already passed through trim_line(); on success, the command after the prefix.
+ * @param id Receives the ID without '#', or an empty view if the line has no prefix.
+ * @return false if the line starts with '#' but the ID is malformed.
+ */
+bool split_request_id(std::string_view& line, std::string_view& id);
+
+/**
+ * @brief Splits a trimmed line into its command and arguments.
+ *
+ * @param line A line already passed through trim_line().
+ * @param args Receives the text after the command, without leading spaces.
+ * @return The command, or CommandType::Unknown.
+ */
+CommandType parse_command(std::string_view line, std::string_view& args);
@@ -1,16 +1,27 @@
 #pragma once
 #include <functional>
 
+#define REACTOR_READ 1  // Watch a descriptor for readability (and for hangups)
+#define REACTOR_WRITE 2 // Watch a descriptor for writability
+
 /**
  * @typedef reactorFunc
  * @brief Type definition for a callback function associated with a file descriptor.
  *
- * This function is called when the associated file descriptor is ready (e.g., readable).
+ * This function is called when the associated file descriptor is ready for
+ * any of the events it is watched for. It is not told which; a callback
+ * watching both reads and writes on a non-blocking socket simply tries both.
  *
  * @param fd The file descriptor that triggered the event.
  */
 typedef void (*reactorFunc)(int fd);
 
+/**
+ * @typedef reactorTask
+ * @brief A task run on a reactor's loop thread, by a timer or after postToReactor().
+ */
+typedef std::function<void()> reactorTask;
+
 /**
  * @brief Starts the reactor loop in a background thread.
  *
@@ -28,9 +39,23 @@ void* startReactor();
  * @param reactor A pointer to the reactor instance returned by `startReactor()`.
  * @param fd The file descriptor to monitor.
  * @param func The function to call when the FD is ready.
+ * @param events REACTOR_READ (the default) and/or REACTOR_WRITE.
+ * @return 0 on success, -1 on error.
+ */
+int addFdToReactor(void* reactor, int fd, reactorFunc func, int events = REACTOR_READ);
+
+/**
+ * @brief Changes the events a registered file descriptor is watched for.
+ *
+ * Watch for REACTOR_WRITE only while there is output the socket did not
+ * accept, and drop REACTOR_READ to stop reading from a client.
+ *
+ * @param reactor A pointer to the reactor instance.
+ * @param fd A registered file descriptor.
+ * @param events REACTOR_READ and/or REACTOR_WRITE.
  * @return 0 on success, -1 on error.
  */
-int addFdToReactor(void* reactor, int fd, reactorFunc func);
+int modifyFdInReactor(void* reactor, int fd, int events);
 
 /**
  * @brief Removes a file descriptor from the reactor.
@@ -43,6 +68,42 @@ int addFdToReactor(void* reactor, int fd, reactorFunc func);
  */
 int removeFdFromReactor(void* reactor, int fd);
 
+/**
+ * @brief Runs a task on the reactor's loop after a delay, and optionally every interval after that.
+ *
+ * The loop sleeps until its earliest timer instead of polling, so timers
+ * replace threads that sleep and wake for periodic work. Tasks run after the
+ * descriptor callbacks of the same loop iteration and never concurrently with them.
+ *
+ * @param reactor A pointer to the reactor instance.
+ * @param delayMs Milliseconds until the first run.
+ * @param task The task to run.
+ * @param intervalMs Milliseconds between later runs, 0 (the default) for a one-shot timer.
+ * @return The timer's id for cancelReactorTimer(), or -1 on error.
+ */
+int addTimerToReactor(void* reactor, int delayMs, reactorTask task, int intervalMs = 0);
+
+/**
+ * @brief Cancels a timer added by addTimerToReactor().
+ *
+ * @param reactor A pointer to the reactor instance.
+ * @param timerId The timer's id.
+ * @return 0 on success, -1 if there is no such timer left.
+ */
+int cancelReactorTimer(void* reactor, int timerId);
+
+/**
+ * @brief Runs a task on the reactor's loop thread as soon as possible; callable from any thread.
+ *
+ * The loop is woken through an eventfd (a pipe outside Linux), and tasks run
+ * in the order they were posted.
+ *
+ * @param reactor A pointer to the reactor instance.
+ * @param task The task to run.
+ * @return 0 on success.
+ */
+int postToReactor(void* reactor, reactorTask task);
+
 /**
  * @brief Stops the reactor loop and deallocates the reactor instance.
  *
@@ -52,3 +113,79 @@ int removeFdFromReactor(void* reactor, int fd);
  * @return 0 on success, -1 on error.
  */
 int stopReactor(void* reactor);
+
+/**
+ * @brief Starts a pool of reactors, each running its own event loop thread.
+ *
+ * Descriptors added to the pool are spread over the loops, so callbacks of
+ * different descriptors run in parallel. Callbacks may therefore run
+ * concurrently and must synchronize any shared state.
+ *
+ * @param n Number of loops; 0 or less starts one per hardware thread.
+ * @return A pointer to the pool (opaque to user), or nullptr on failure.
+ */
+void* startReactorPool(int n);
+
+/**
+ * @brief Returns the number of event loops in a pool.
+ *
+ * @param pool The pool returned by `startReactorPool`.
+ */
+int reactorPoolSize(void* pool);
+
+/**
+ * @brief Returns one loop of a pool, to add timers to or post tasks to.
+ *
+ * @param pool The pool returned by `startReactorPool`.
+ * @param loop Index of the loop.
+ * @return The loop's reactor, or nullptr if loop is out of range.
+ */
+void* reactorPoolLoop(void* pool, int loop);
+
+/**
+ * @brief Registers a file descriptor and its callback with one loop of the pool.
+ *
+ * @param pool The pool returned by `startReactorPool`.
+ * @param fd The file descriptor to monitor.
+ * @param func The callback function to invoke when the fd is ready.
+ * @param loop Index of the loop to use, or -1 for the loop watching the fewest descriptors.
+ * @param events REACTOR_READ (the default) and/or REACTOR_WRITE.
+ * @return 0 on success, or -1 on failure.
+ */
+int addFdToReactorPool(void* pool, int fd, reactorFunc func, int loop = -1, int events = REACTOR_READ);
+
+/**
+ * @brief Changes the events a descriptor is watched for by whichever loop of the pool watches it.
+ *
+ * @param pool The pool instance.
+ * @param fd A registered file descriptor.
+ * @param events REACTOR_READ and/or REACTOR_WRITE.
+ * @return 0 on success, or -1 on failure.
+ */
+int modifyFdInReactorPool(void* pool, int fd, int events);
+
+/**
+ * @brief Removes a file descriptor from whichever loop of the pool watches it.
+ *
+ * @param pool The pool instance.
+ * @param fd The file descriptor to remove.
+ * @return 0 on success, or -1 on failure.
+ */
+int removeFdFromReactorPool(void* pool, int fd);
+
+/**
+ * @brief Returns the index of the loop watching a file descriptor.
+ *
+ * @param pool The pool instance.
+ * @param fd A registered file descriptor.
+ * @return The loop index, or -1 if fd is not registered.
+ */
+int reactorPoolLoopOf(void* pool, int fd);
+
+/**
+ * @brief Stops every loop of the pool and frees its resources.
+ *
+ * @param pool The pool instance to stop.
+ * @return 0 on success, or -1 on failure.
+ */
+int stopReactorPool(void* pool);
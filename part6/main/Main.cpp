@@ -1,234 +1,675 @@
 #include "../include/GeometryUtils.hpp"
+#include "../include/CommandParser.hpp"
+#include "../include/InputBuffer.hpp"
+#include "../include/Log.hpp"
+#include "../include/StateStore.hpp"
+#include "../include/Metrics.hpp"
 #include <iostream>
 #include <sstream>
 #include <string>
-#include <deque>
+#include <string_view>
 #include <unordered_map>
 #include <algorithm>
 #include <cctype>
 #include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/select.h>
 #include <cstring>
+#include <cmath>
+#include <cstdint>
 #include <thread>
 #include <chrono>
+#include <mutex>
+#include <memory>
+#include <vector>
 #include "../include/Reactor.hpp"
 
 #define PORT 9034
 #define MAX_CLIENTS 10
+#define POINT_WIRE_SIZE 16 // NewgraphBin point: x then y as little-endian IEEE-754 doubles
+#define DEFAULT_GRAPH "default" // Graph of a client that has not sent Use
+#define IDLE_SCAN_MS 1000 // Longest time between two idle-client scans of a loop
+#define OUTPUT_HIGH_WATERMARK (1 << 20)  // Unsent response bytes that stop reading from a client
+#define OUTPUT_LOW_WATERMARK (256 << 10) // Unsent response bytes below which reading resumes
+
+/**
+ * @struct Graph
+ * @brief One named point set with its hull and its log.
+ *
+ * mutex protects every member, so commands on different graphs run in
+ * parallel on different event loops.
+ */
+struct Graph {
+    std::mutex mutex;
+    PointCloud point_set;
+    DynamicHull hull_engine; // Convex hull of point_set, updated in place by every Newpoint/Removepoint
+    StateStore state_store; // Snapshot and change log of point_set, idle unless --state is given
+};
 
 /**
  * @struct ClientState
  * @brief Maintains input buffer for each connected client.
  */
 struct ClientState {
-    std::string inbuf;  // Accumulate input until newline
+    InputBuffer input;      // Received bytes not consumed yet
+    std::string outbuf;     // Responses the socket did not accept yet, sent when it becomes writable
+    int events = REACTOR_READ; // What the client's loop watches it for, see update_interest()
+    Graph* graph = nullptr; // Graph the client's commands apply to, DEFAULT_GRAPH until Use
+    // Pending Newgraph, staged here so the graph stays usable until the last point arrives
+    PointCloud temp_points;            // Points received so far
+    int points_to_read = 0;            // Points still expected, 0 when no Newgraph is pending
+    bool binary_graph = false;         // True while the client sends a NewgraphBin payload
+    bool binary_graph_invalid = false; // Set if that payload held a coordinate PointCloud cannot store
+    std::string upload_id;             // Request ID of a NewgraphBin, echoed with its final answer
+    std::chrono::steady_clock::time_point last_active; // Accept or last receive, for --idle-timeout
 };
 
-// Shared graph data (global)
-std::deque<Point> point_set;
-std::deque<Point> temp_points;
-bool waiting_for_graph = false;
-int points_to_read = 0;
-int newgraph_owner_fd = -1;  // fd of the client building the new graph
+// Shared server state; pool loops run handlers in parallel, so every map has its mutex
+thread_local HullWorkspace hull_workspace; // Scratch for hull walks, one per worker thread
+thread_local std::vector<Point> command_points; // Points of the Newpoints/Removepoints being run, one buffer per thread
+std::mutex state_mutex; // Protects clients
 std::unordered_map<int, ClientState> clients;
-void* globalReactor = nullptr;
+std::mutex graphs_mutex; // Protects graphs
+std::unordered_map<std::string, std::unique_ptr<Graph>> graphs; // Graphs by name, created by their first Use
+std::string state_root; // --state directory, empty if graphs are not persisted
+Graph* default_graph = nullptr; // DEFAULT_GRAPH, opened before the first client is accepted
+void* globalPool = nullptr;
+bool reuse_port = false; // One SO_REUSEPORT listener per loop instead of a shared one
+std::chrono::seconds idle_timeout{0}; // Clients silent this long are disconnected, 0 to keep them
 
 /**
- * @brief Checks if a string represents a valid float.
+ * @brief Replaces a graph with the points a client staged for it.
+ *
+ * The hull of the new points is built before the graph's mutex is taken, so
+ * other clients of the graph only wait for the swap, and the replaced points
+ * and hull are freed after the mutex is released.
  *
- * @param s The string to check.
- * @return true if valid float, false otherwise.
+ * @param graph The graph being replaced.
+ * @param state The client that sent the points; its staging buffer is emptied.
  */
-bool is_number(const std::string& s) {
-    std::istringstream iss(s);
-    double d;
-    return (iss >> d) && iss.eof();
+void install_new_graph(Graph& graph, ClientState& state) {
+    DynamicHull hull;
+    uint64_t start = metrics_clock();
+    hull.assign(state.temp_points);
+    metrics_record(Latency::HullBuild, start);
+    {
+        TimedLock lock(graph.mutex);
+        graph.point_set.swap(state.temp_points);
+        graph.hull_engine.swap(hull);
+        graph.state_store.snapshot(graph.point_set, graph.hull_engine.vertices(hull_workspace)); // The old log no longer applies
+    }
+    PointCloud().swap(state.temp_points); // Releases the replaced points instead of keeping them per client
 }
 
 /**
- * @brief Removes trailing CR/LF and leading spaces from a string.
+ * @brief Stages a point line received during a client's Newgraph.
+ *
+ * Only touches the client's own state; the graph is locked once, when the
+ * last point arrives.
  *
- * @param s The string to trim (modified in place).
+ * @param state The uploading client.
+ * @param line Input in the form "x,y".
+ * @return "OK", "GRAPH_LOADED", or an error message.
  */
-void trim_crlf(std::string &s) {
-    while (!s.empty() && (s.back() == '\n' || s.back() == '\r')) s.pop_back();
-    while (!s.empty() && std::isspace((unsigned char)s.front())) s.erase(s.begin());
+std::string handle_point_line(ClientState& state, std::string_view line) {
+    Point p;
+    ParseStatus status = parse_point(line, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid point format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid point values.";
+
+    state.temp_points.push_back(p);
+    if (--state.points_to_read > 0) return "OK";
+    install_new_graph(*state.graph, state);
+    return "GRAPH_LOADED";
 }
 
 /**
- * @brief Checks whether a client is allowed to send points.
+ * @brief Decodes a little-endian IEEE-754 double, whatever the host byte order.
  *
- * @param fd The client's file descriptor.
- * @return true if the client is blocked because another is building a graph.
+ * @param bytes Eight bytes, least significant first.
+ * @return The decoded value.
  */
-bool is_busy_for_fd(int fd) {
-    return waiting_for_graph && fd != newgraph_owner_fd;
+double read_le_double(const char* bytes) {
+    uint64_t bits = 0;
+    for (int i = 7; i >= 0; --i) bits = (bits << 8) | static_cast<unsigned char>(bytes[i]);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
 }
 
 /**
- * @brief Handles a line containing a point during Newgraph.
+ * @brief Prefixes a response with the request ID of the command it answers.
  *
- * @param line Input in the form "x,y".
- * @return "OK", "GRAPH_LOADED", or an error message.
+ * @param id The ID without '#', empty for an untagged command.
+ * @param response The response; an empty one (no answer) stays empty.
+ * @return "#ID response", or response itself when there is nothing to tag.
  */
-std::string handle_point_line(const std::string& line) {
-    size_t comma = line.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid point format.";
-    std::string x_str = line.substr(0, comma);
-    std::string y_str = line.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid point values.";
-
-    Point p{std::stod(x_str), std::stod(y_str)};
-    temp_points.push_back(p);
-    points_to_read--;
-    if (points_to_read == 0) {
-        point_set = temp_points;
-        temp_points.clear();
-        waiting_for_graph = false;
-        newgraph_owner_fd = -1;
-        return "GRAPH_LOADED";
+std::string tag_response(std::string_view id, std::string response) {
+    if (id.empty() || response.empty()) return response;
+    std::string tagged;
+    tagged.reserve(id.size() + 2 + response.size());
+    tagged += '#';
+    tagged.append(id.data(), id.size());
+    tagged += ' ';
+    tagged += response;
+    return tagged;
+}
+
+/**
+ * @brief Moves the NewgraphBin points buffered so far straight into the client's staging buffer.
+ *
+ * Consumes whole points from the front of the client's unread input without
+ * any text parsing. A trailing partial point stays buffered for the next read.
+ *
+ * @param state The uploading client; consumed points are removed from its input.
+ * @return "GRAPH_LOADED" or an error once the payload is complete, "" while points are missing.
+ */
+std::string handle_binary_points(ClientState& state) {
+    InputBuffer& input = state.input;
+    std::string_view unread = input.unread();
+    size_t count = std::min(unread.size() / POINT_WIRE_SIZE, static_cast<size_t>(state.points_to_read));
+    const char* data = unread.data();
+    for (size_t i = 0; i < count; ++i, data += POINT_WIRE_SIZE) {
+        Point p{read_le_double(data), read_le_double(data + 8)};
+        if (!coord_fits(p.x) || !coord_fits(p.y)) state.binary_graph_invalid = true;
+        else state.temp_points.push_back(p);
     }
-    return "OK";
+    input.consume(count * POINT_WIRE_SIZE);
+    state.points_to_read -= static_cast<int>(count);
+    if (state.points_to_read > 0) return "";
+
+    state.binary_graph = false;
+    if (state.binary_graph_invalid) {
+        PointCloud().swap(state.temp_points);
+        return tag_response(state.upload_id, "ERROR: Invalid point values.");
+    }
+    install_new_graph(*state.graph, state);
+    return tag_response(state.upload_id, "GRAPH_LOADED");
+}
+
+/**
+ * @brief Starts a background snapshot once enough changes were logged since the last one.
+ * @param graph The graph that changed.
+ */
+void snapshot_if_due(Graph& graph) {
+    if (graph.state_store.snapshot_due()) graph.state_store.snapshot(graph.point_set, graph.hull_engine.vertices(hull_workspace));
 }
 
 /**
  * @brief Handles the "Newpoint" command.
  *
+ * @param graph The client's graph.
  * @param args A string of the form "x,y".
  * @return "OK" or error message.
  */
-std::string handle_newpoint(const std::string& args) {
-    size_t comma = args.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid format.";
-    std::string x_str = args.substr(0, comma);
-    std::string y_str = args.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid values.";
-    Point p{std::stod(x_str), std::stod(y_str)};
-    point_set.push_back(p);
+std::string handle_newpoint(Graph& graph, std::string_view args) {
+    Point p;
+    ParseStatus status = parse_point(args, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    graph.point_set.push_back(p);
+    graph.hull_engine.insert(p);
+    graph.state_store.log_insert(p);
+    snapshot_if_due(graph);
     return "OK";
 }
 
 /**
  * @brief Handles the "Removepoint" command.
  *
+ * @param graph The client's graph.
  * @param args A string of the form "x,y".
  * @return "OK" or error message.
  */
-std::string handle_removepoint(const std::string& args) {
-    size_t comma = args.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid format.";
-    std::string x_str = args.substr(0, comma);
-    std::string y_str = args.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid values.";
-    Point p{std::stod(x_str), std::stod(y_str)};
-    auto it = std::remove_if(point_set.begin(), point_set.end(),
-                             [&](const Point& q) { return q.x == p.x && q.y == p.y; });
-    if (it != point_set.end()) point_set.erase(it, point_set.end());
+std::string handle_removepoint(Graph& graph, std::string_view args) {
+    Point p;
+    ParseStatus status = parse_point(args, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    if (graph.point_set.remove_all(p) > 0) {
+        graph.hull_engine.erase(p);
+        graph.state_store.log_remove(p);
+        snapshot_if_due(graph);
+    }
+    return "OK";
+}
+
+/**
+ * @brief Parses the "k x1,y1;...;xk,yk" arguments of Newpoints and Removepoints.
+ *
+ * @param args Arguments after the command.
+ * @param points Receives the k points.
+ * @return An empty string on success, else the error message.
+ */
+std::string parse_point_batch(std::string_view args, std::vector<Point>& points) {
+    int n;
+    if (!parse_count(args, n) || n <= 0) return "ERROR: Invalid number.";
+    size_t space = args.find_first_of(" \t");
+    ParseStatus status = parse_point_list(space == std::string_view::npos ? std::string_view() : args.substr(space + 1), points);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    if (points.size() != static_cast<size_t>(n)) return "ERROR: Point count mismatch.";
+    return "";
+}
+
+/**
+ * @brief Adds a batch of points to the graph (via Newpoints).
+ *
+ * Either every point is added or, if any of them is invalid, none. The
+ * points are parsed before the graph's mutex is taken, which is then held once
+ * for the whole batch. The hull takes the batch in one insert_batch() call and
+ * the log in one write().
+ *
+ * @param graph The client's graph.
+ * @param args Arguments after the command (k x1,y1;...;xk,yk).
+ * @return Response message.
+ */
+std::string handle_newpoints(Graph& graph, std::string_view args) {
+    std::string error = parse_point_batch(args, command_points);
+    if (!error.empty()) return error;
+    TimedLock lock(graph.mutex);
+    for (const Point& p : command_points) graph.point_set.push_back(p);
+    graph.hull_engine.insert_batch(command_points);
+    graph.state_store.log_inserts(command_points);
+    snapshot_if_due(graph);
+    return "OK";
+}
+
+/**
+ * @brief Removes every copy of each point of a batch from the graph (via Removepoints).
+ *
+ * Validated and applied like Newpoints; points not in the graph are ignored.
+ *
+ * @param graph The client's graph.
+ * @param args Arguments after the command (k x1,y1;...;xk,yk).
+ * @return Response message.
+ */
+std::string handle_removepoints(Graph& graph, std::string_view args) {
+    std::string error = parse_point_batch(args, command_points);
+    if (!error.empty()) return error;
+    TimedLock lock(graph.mutex);
+    // Keep only the points that were present, which are the ones the hull and the log need
+    size_t removed = 0;
+    for (const Point& p : command_points) {
+        if (graph.point_set.remove_all(p) > 0) command_points[removed++] = p;
+    }
+    command_points.resize(removed);
+    if (removed > 0) {
+        graph.hull_engine.erase_batch(command_points);
+        graph.state_store.log_removes(command_points);
+        snapshot_if_due(graph);
+    }
     return "OK";
 }
 
 /**
  * @brief Computes the convex hull area of the current point set.
  *
+ * @param graph The client's graph.
  * @return A string containing the area.
  */
-std::string handle_ch() {
-    auto hull = compute_convex_hull_deque(point_set);
-    double area = compute_area(hull);
+std::string handle_ch(Graph& graph) {
+    uint64_t start = metrics_clock();
+    double area = graph.hull_engine.area(hull_workspace);
+    metrics_record(Latency::HullRead, start);
     std::ostringstream oss;
     oss << area;
     return oss.str();
 }
 
 /**
- * @brief Parses and executes a line of input from a client.
+ * @brief Answers the queries computed from the hull alone.
  *
- * @param fd The client's file descriptor.
- * @param rawline The raw input line.
- * @return Response string to send back to the client.
+ * Walks the maintained hull in O(h log n), so no query looks at the point set.
+ * Must be called with the graph's mutex held.
+ * - CHPoints: "h x1,y1;...;xh,yh", the vertices counter-clockwise.
+ * - Perimeter, Diameter: a number.
+ * - Contains x,y: "YES" if the point is inside or on the hull, else "NO", in O(log h).
+ * - MinBoundingRect: "area x1,y1;...;x4,y4", the corners counter-clockwise, or
+ *   "0" for an empty graph.
+ *
+ * @param graph The client's graph.
+ * @param command CHPoints, Perimeter, Contains, Diameter or MinBoundingRect.
+ * @param args Arguments after the command (x,y for Contains).
+ * @return Response message.
  */
-std::string process_line(int fd, const std::string& rawline) {
-    std::string line = rawline;
-    trim_crlf(line);
-    if (line.empty()) return "";
+std::string handle_hull_query(Graph& graph, CommandType command, std::string_view args) {
+    Point p{0, 0};
+    if (command == CommandType::Contains) {
+        ParseStatus status = parse_point(args, p);
+        if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+        if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    }
+    const std::vector<Point>& hull = graph.hull_engine.vertices(hull_workspace);
 
-    if (waiting_for_graph && fd != newgraph_owner_fd) {
-        return "BUSY";
+    std::ostringstream oss;
+    switch (command) {
+    case CommandType::CHPoints: {
+        std::string response = std::to_string(hull.size());
+        if (!hull.empty()) response += ' ';
+        format_point_list(hull.data(), hull.size(), response);
+        return response;
+    }
+    case CommandType::Perimeter:
+        oss << compute_perimeter(hull);
+        return oss.str();
+    case CommandType::Contains:
+        return hull_contains(hull, p) ? "YES" : "NO";
+    case CommandType::Diameter:
+        oss << hull_diameter(hull);
+        return oss.str();
+    default: {
+        if (hull.empty()) return "0";
+        BoundingRect rect = min_bounding_rect(hull);
+        oss << rect.area << ' ';
+        std::string response = oss.str();
+        format_point_list(rect.corners, 4, response);
+        return response;
     }
+    }
+}
 
-    if (waiting_for_graph && fd == newgraph_owner_fd) {
-        return handle_point_line(line);
+/**
+ * @brief Handles the "Snapshot" command: writes the graph to the state directory now.
+ *
+ * @param graph The client's graph.
+ * @return "OK" once the background write has started, or an error message.
+ */
+std::string handle_snapshot(Graph& graph) {
+    if (!graph.state_store.is_open()) return "ERROR: No state directory.";
+    if (!graph.state_store.snapshot(graph.point_set, graph.hull_engine.vertices(hull_workspace))) return "ERROR: Snapshot failed.";
+    return "OK";
+}
+
+/**
+ * @brief Returns the graph with the given name, creating it on first use.
+ *
+ * With a state directory a new graph is restored from its own directory
+ * (the state directory itself for DEFAULT_GRAPH, graph.NAME inside it for
+ * the others).
+ *
+ * @param name A name accepted by valid_graph_name().
+ * @param error Receives a message if the graph cannot be restored.
+ * @return The graph, or nullptr on failure. Graphs are never freed.
+ */
+Graph* open_graph(const std::string& name, std::string& error) {
+    std::lock_guard<std::mutex> lock(graphs_mutex);
+    auto it = graphs.find(name);
+    if (it != graphs.end()) return it->second.get();
+
+    std::unique_ptr<Graph> graph(new Graph);
+    if (!state_root.empty()) {
+        std::string dir = name == DEFAULT_GRAPH ? state_root : state_root + "/graph." + name;
+        std::vector<Point> saved_hull; // DynamicHull rebuilds its own
+        if (!graph->state_store.open(dir, graph->point_set, saved_hull, error)) return nullptr;
+        uint64_t start = metrics_clock();
+        graph->hull_engine.assign(graph->point_set);
+        metrics_record(Latency::HullBuild, start);
+        LOG_INFO("Restored " << graph->point_set.size() << " point(s) of " << name << " from " << dir);
     }
+    return graphs.emplace(name, std::move(graph)).first->second.get();
+}
 
-    std::istringstream iss(line);
-    std::string command;
-    iss >> command;
-    std::string args;
-    std::getline(iss, args);
-    size_t pos = args.find_first_not_of(" ");
-    if (pos != std::string::npos) args.erase(0, pos);
-    else args.clear();
+/**
+ * @brief Handles the Use command: switches the client to another graph.
+ *
+ * @param state The client's state.
+ * @param args The graph name.
+ * @return "OK" or an error message.
+ */
+std::string handle_use(ClientState& state, std::string_view args) {
+    if (!valid_graph_name(args)) return "ERROR: Invalid graph name.";
+    std::string error;
+    Graph* graph = open_graph(std::string(args), error);
+    if (!graph) {
+        std::cerr << "Cannot restore graph " << args << ": " << error << std::endl;
+        return "ERROR: Cannot open graph.";
+    }
+    state.graph = graph;
+    return "OK";
+}
+
+/**
+ * @brief Handles the Stats command: reports the server's counters and latencies.
+ *
+ * Appends the number of graphs and their total point count to metrics_report().
+ *
+ * @return The report, or an error if the server was built with METRICS=0.
+ */
+std::string handle_stats() {
+#if METRICS
+    size_t graph_count, points = 0;
+    {
+        std::lock_guard<std::mutex> lock(graphs_mutex);
+        graph_count = graphs.size();
+        for (auto& entry : graphs) {
+            std::lock_guard<std::mutex> graph_lock(entry.second->mutex);
+            points += entry.second->point_set.size();
+        }
+    }
+    return metrics_report() + " graphs=" + std::to_string(graph_count) + " points=" + std::to_string(points);
+#else
+    return "ERROR: Metrics are disabled.";
+#endif
+}
 
-    if (command == "Newgraph") {
-        std::istringstream a(args);
+/**
+ * @brief Executes one command line, once its request ID is split off.
+ *
+ * @param state The client's state, which selects its graph.
+ * @param line The trimmed command or point line.
+ * @param command Receives the parsed command; left unchanged for a point line.
+ * @return Response string to send back to the client.
+ */
+std::string run_command(ClientState& state, std::string_view line, CommandType& command) {
+    Graph& graph = *state.graph;
+
+    if (state.points_to_read > 0) return handle_point_line(state, line);
+
+    std::string_view args;
+    command = parse_command(line, args);
+
+    if (command == CommandType::Newgraph) {
         int n;
-        if (!(a >> n) || n <= 0) return "ERROR: Invalid number.";
-        waiting_for_graph = true;
-        newgraph_owner_fd = fd;
-        points_to_read = n;
-        temp_points.clear();
+        if (!parse_count(args, n) || n <= 0) return "ERROR: Invalid number.";
+        state.binary_graph = false;
+        state.points_to_read = n;
+        state.temp_points.clear();
+        state.temp_points.reserve(std::min(n, 1 << 20)); // Cap what an untrusted count can preallocate
         return "OK";
     }
-    if (command == "Newpoint") return handle_newpoint(args);
-    if (command == "Removepoint") return handle_removepoint(args);
-    if (command == "CH") return handle_ch();
+    if (command == CommandType::NewgraphBin) {
+        int n;
+        if (!parse_count(args, n) || n <= 0) return "ERROR: Invalid number.";
+        state.binary_graph = true;
+        state.binary_graph_invalid = false;
+        state.points_to_read = n;
+        state.temp_points.clear();
+        state.temp_points.reserve(std::min(n, 1 << 20)); // Cap what an untrusted count can preallocate
+        return ""; // Acknowledged once, after the payload
+    }
+    if (command == CommandType::Use) return handle_use(state, args);
+    if (command == CommandType::Stats) return handle_stats();
+
+    if (command == CommandType::Newpoints) return handle_newpoints(graph, args);
+    if (command == CommandType::Removepoints) return handle_removepoints(graph, args);
+
+    TimedLock lock(graph.mutex); // The remaining commands read or change the graph
+    if (command == CommandType::Newpoint) return handle_newpoint(graph, args);
+    if (command == CommandType::Removepoint) return handle_removepoint(graph, args);
+    if (command == CommandType::CH) return handle_ch(graph);
+    if (command == CommandType::CHPoints || command == CommandType::Perimeter || command == CommandType::Contains ||
+        command == CommandType::Diameter || command == CommandType::MinBoundingRect)
+        return handle_hull_query(graph, command, args);
+    if (command == CommandType::Snapshot) return handle_snapshot(graph);
 
     return "ERROR: Unknown command.";
 }
 
 /**
- * @brief Handles incoming data from a connected client.
+ * @brief Answers a line received from a client, echoing its request ID if it has one.
  *
- * If the client disconnects, cleans up state and removes the client from the reactor.
+ * @param state The client's state, which selects its graph.
+ * @param rawline The raw input line.
+ * @return Response string, "" if the line needs no answer yet.
+ */
+std::string process_line(ClientState& state, std::string_view rawline) {
+    std::string_view line = trim_line(rawline);
+    if (line.empty()) return "";
+    std::string_view id;
+    if (!split_request_id(line, id)) return "ERROR: Invalid request ID.";
+    CommandType command = CommandType::Unknown;
+    bool timed = state.points_to_read == 0; // Lines of a Newgraph upload are not commands
+    uint64_t start = metrics_clock();
+    std::string response = run_command(state, line, command);
+    if (timed) metrics_record_command(command, start);
+    if (state.binary_graph && response.empty()) state.upload_id.assign(id.data(), id.size()); // Answered after the payload
+    return tag_response(id, std::move(response));
+}
+
+/**
+ * @brief Disconnects a client and forgets its state, including any upload it staged.
+ *
+ * Must run on the client's event loop.
  *
  * @param fd The client's file descriptor.
  */
-void handle_client(int fd) {
-    char buffer[1024];
-    int bytes = recv(fd, buffer, sizeof(buffer), 0);
-
-    if (bytes <= 0) {
-        std::cout << "Client " << fd << " disconnected or error occurred (recv=" << bytes << "). Closing fd." << std::endl;
-        removeFdFromReactor(globalReactor, fd);
-        close(fd);
+void drop_client(int fd) {
+    removeFdFromReactorPool(globalPool, fd);
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
         clients.erase(fd);
-        if (waiting_for_graph && fd == newgraph_owner_fd) {
-            std::cout << "Graph construction aborted (owner disconnected)." << std::endl;
-            waiting_for_graph = false;
-            newgraph_owner_fd = -1;
-            temp_points.clear();
+    }
+    close(fd); // Only now may another loop accept a client onto this fd number
+}
+
+/**
+ * @brief Sends as much of a client's queued responses as its socket accepts without blocking.
+ *
+ * @param fd The client's non-blocking socket.
+ * @param state The client's state; sent bytes are removed from its outbuf.
+ * @return false if the connection broke.
+ */
+bool flush_output(int fd, ClientState& state) {
+    size_t sent = 0;
+    while (sent < state.outbuf.size()) {
+        ssize_t n = send(fd, state.outbuf.data() + sent, state.outbuf.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) return false;
+            break; // Socket buffer full; the rest goes out when the loop reports it writable
         }
-        return;
     }
+    state.outbuf.erase(0, sent); // Keeps its capacity for the next responses
+    return true;
+}
+
+/**
+ * @brief Sets what a client's loop watches it for from the size of its unsent output.
+ *
+ * Writability is watched only while responses are queued. Reading stops once
+ * more than OUTPUT_HIGH_WATERMARK bytes are queued, so a client that does not
+ * read its replies is throttled by TCP flow control instead of growing the
+ * queue or blocking the loop, and resumes below OUTPUT_LOW_WATERMARK.
+ *
+ * @param fd The client's socket.
+ * @param state The client's state.
+ */
+void update_interest(int fd, ClientState& state) {
+    size_t queued = state.outbuf.size();
+    bool reading = state.events & REACTOR_READ;
+    if (reading && queued > OUTPUT_HIGH_WATERMARK) {
+        reading = false;
+        LOG_INFO("Client " << fd << " is not reading its responses. Pausing input.");
+    } else if (!reading && queued <= OUTPUT_LOW_WATERMARK) {
+        reading = true;
+    }
+    int events = (reading ? REACTOR_READ : 0) | (queued > 0 ? REACTOR_WRITE : 0);
+    if (events == state.events) return;
+    modifyFdInReactorPool(globalPool, fd, events);
+    state.events = events;
+}
 
-    std::string& inbuf = clients[fd].inbuf;
-    inbuf.append(buffer, bytes);
-    std::cout << "Received from fd " << fd << ": " << std::string(buffer, bytes) << std::endl;
+/**
+ * @brief Reads what a client sent and queues a response for every complete line.
+ *
+ * @param fd The client's non-blocking socket.
+ * @param state The client's state.
+ */
+void read_client(int fd, ClientState& state) {
+    InputBuffer& input = state.input;
+    char* buffer = input.write_area();
+    int bytes = recv(fd, buffer, input.write_size(), 0); // Receive straight into the buffer
 
-    size_t pos;
-    while ((pos = inbuf.find('\n')) != std::string::npos) {
-        std::string line = inbuf.substr(0, pos + 1);
-        inbuf.erase(0, pos + 1);
-        std::string response = process_line(fd, line);
-        std::cout << "Processing line: " << line << " → Response: " << response << "\n" << std::endl;
+    if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        update_interest(fd, state); // Woken for writability only
+        return;
+    }
+    if (bytes <= 0) {
+        LOG_INFO("Client " << fd << " disconnected or error occurred (recv=" << bytes << "). Closing fd.");
+        drop_client(fd);
+        return;
+    }
+
+    LOG_TRACE("Received from fd " << fd << ": " << std::string_view(buffer, bytes));
+    input.commit(bytes);
+    state.last_active = std::chrono::steady_clock::now();
+    while (true) {
+        std::string_view line;
+        std::string response;
+        if (state.binary_graph) {
+            response = handle_binary_points(state);
+            if (response.empty()) break; // Rest of the payload is still in flight
+        } else {
+            if (!input.next_line(line)) break; // Slice of the buffer, no copy
+            response = process_line(state, line);
+        }
+        LOG_TRACE("Processing line: " << line << " → Response: " << response << "\n");
         if (!response.empty()) {
-            response += "\n";
-            send(fd, response.c_str(), response.size(), 0);
+            state.outbuf += response;
+            state.outbuf += '\n';
         }
     }
+    if (!flush_output(fd, state)) {
+        LOG_INFO("Client " << fd << " stopped accepting data. Closing fd.");
+        drop_client(fd);
+        return;
+    }
+    update_interest(fd, state);
+}
+
+/**
+ * @brief Handles a connected client's readiness: sends queued responses, then reads and answers new input.
+ *
+ * If the client disconnects, cleans up state and removes the client from the reactor.
+ *
+ * @param fd The client's file descriptor.
+ */
+void handle_client(int fd) {
+    ClientState* state; // Only this fd's event loop touches or erases the entry
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        auto it = clients.find(fd);
+        if (it == clients.end()) return; // Stale event for a client already dropped
+        state = &it->second;
+    }
+    if (!flush_output(fd, *state)) {
+        LOG_INFO("Client " << fd << " stopped accepting data. Closing fd.");
+        drop_client(fd);
+        return;
+    }
+    if (state->events & REACTOR_READ) {
+        read_client(fd, *state);
+    } else {
+        update_interest(fd, *state); // Paused: only resumes once enough output drained
+    }
 }
 
 /**
@@ -239,26 +680,64 @@ void handle_client(int fd) {
 void handle_listener(int fd) {
     int client_fd = accept(fd, nullptr, nullptr);
     if (client_fd >= 0) {
-        std::cout << "New client accepted: " << client_fd << "\n" << std::endl;
-        addFdToReactor(globalReactor, client_fd, handle_client);
-        clients[client_fd] = ClientState{};
+        LOG_INFO("New client accepted: " << client_fd << "\n");
+        fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL) | O_NONBLOCK); // A slow client must not block its loop
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            clients[client_fd] = ClientState{};
+            clients[client_fd].graph = default_graph;
+            clients[client_fd].last_active = std::chrono::steady_clock::now();
+        }
+        // With per-loop listeners keep the client on the loop that accepted it
+        int loop = reuse_port ? reactorPoolLoopOf(globalPool, fd) : -1;
+        addFdToReactorPool(globalPool, client_fd, handle_client, loop);
     } else {
         perror("accept failed");
     }
 }
 
 /**
- * @brief Entry point of the server.
+ * @brief Disconnects the clients of one event loop that were silent for idle_timeout.
  *
- * Initializes the TCP socket, starts the reactor, and waits for events.
+ * Runs on that loop as a repeating timer, so it only reads the state of
+ * clients whose callbacks run on the same thread.
  *
- * @return 0 on success, 1 on failure.
+ * @param loop Index of the loop in the pool.
  */
-int main() {
+void reap_idle_clients(int loop) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::vector<int> idle;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        for (const auto& entry : clients) {
+            if (reactorPoolLoopOf(globalPool, entry.first) == loop && now - entry.second.last_active >= idle_timeout)
+                idle.push_back(entry.first);
+        }
+    }
+    for (int fd : idle) {
+        LOG_INFO("Client " << fd << " idle for " << idle_timeout.count() << "s. Closing fd.");
+        drop_client(fd);
+    }
+}
+
+/**
+ * @brief Creates a TCP socket listening on PORT.
+ *
+ * @param reuse Set SO_REUSEPORT so that several sockets can share the port.
+ * @return The listening socket, or -1 on failure.
+ */
+int open_listener(bool reuse) {
     int listener = socket(AF_INET, SOCK_STREAM, 0);
     if (listener < 0) {
         perror("socket failed");
-        return 1;
+        return -1;
+    }
+
+    int yes = 1;
+    if (reuse && setsockopt(listener, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes)) < 0) {
+        perror("setsockopt SO_REUSEPORT failed");
+        close(listener);
+        return -1;
     }
 
     sockaddr_in server{};
@@ -268,26 +747,91 @@ int main() {
 
     if (bind(listener, (sockaddr*)&server, sizeof(server)) < 0) {
         perror("bind failed");
-        return 1;
+        close(listener);
+        return -1;
     }
 
     if (listen(listener, MAX_CLIENTS) < 0) {
         perror("listen failed");
+        close(listener);
+        return -1;
+    }
+    return listener;
+}
+
+/**
+ * @brief Entry point of the server.
+ *
+ * Initializes the TCP socket, starts the reactor pool, and waits for events.
+ *
+ * Options:
+ * - -l N: run N event loops (0 = one per hardware thread, default 1). Clients
+ *   are assigned to the loop watching the fewest descriptors.
+ * - --reuseport: give every loop its own SO_REUSEPORT listener, so the kernel
+ *   spreads incoming connections and each loop accepts its own clients.
+ * - --state DIR: restore the graphs saved in DIR when they are first used,
+ *   then keep DIR up to date with change logs and snapshots (every Newgraph,
+ *   every SNAPSHOT_LOG_RECORDS changes and on the Snapshot command).
+ * - --idle-timeout S: disconnect clients that sent nothing for S seconds,
+ *   checked by a timer on each event loop.
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments (see the options above).
+ * @return 0 on success, 1 on failure.
+ */
+int main(int argc, char* argv[]) {
+    int loops = 1, idle_seconds = 0;
+    const char* state_dir = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-l") == 0 && i + 1 < argc && parse_count(argv[i + 1], loops)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--idle-timeout") == 0 && i + 1 < argc &&
+                   parse_count(argv[i + 1], idle_seconds)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--reuseport") == 0) {
+            reuse_port = true;
+        } else if (std::strcmp(argv[i], "--state") == 0 && i + 1 < argc) {
+            state_dir = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [-l loops] [--reuseport] [--state DIR] [--idle-timeout S]"
+                      << std::endl;
+            return 1;
+        }
+    }
+    if (state_dir) state_root = state_dir;
+    std::string error;
+    default_graph = open_graph(DEFAULT_GRAPH, error);
+    if (!default_graph) {
+        std::cerr << "Cannot restore the graph: " << error << std::endl;
         return 1;
     }
 
-    globalReactor = startReactor();
-    addFdToReactor(globalReactor, listener, handle_listener);
+    globalPool = startReactorPool(loops);
+    if (!globalPool) {
+        std::cerr << "Failed to start the reactor pool." << std::endl;
+        return 1;
+    }
 
-    std::cout << "Server is running. Press Ctrl+C to exit.\n\n";
+    int listeners = reuse_port ? reactorPoolSize(globalPool) : 1;
+    for (int i = 0; i < listeners; ++i) {
+        int listener = open_listener(reuse_port);
+        if (listener < 0) return 1;
+        addFdToReactorPool(globalPool, listener, handle_listener, i);
+    }
+
+    idle_timeout = std::chrono::seconds(idle_seconds);
+    if (idle_seconds > 0) {
+        int scan_ms = std::min(IDLE_SCAN_MS, idle_seconds * 1000);
+        for (int i = 0; i < reactorPoolSize(globalPool); ++i)
+            addTimerToReactor(reactorPoolLoop(globalPool, i), scan_ms, [i] { reap_idle_clients(i); }, scan_ms);
+    }
+
+    std::cout << "Server is running with " << reactorPoolSize(globalPool) << " event loop(s). Press Ctrl+C to exit.\n\n";
 
     while (true) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
 
-    stopReactor(globalReactor);
+    stopReactorPool(globalPool);
     return 0;
 }
-
-
-
@@ -0,0 +1,179 @@
+#include "../include/CommandParser.hpp"
+#include <charconv>
+#include <cmath>
+
+/**
+ * @brief True for the characters std::isspace accepts in the "C" locale.
+ */
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+/**
+ * @brief Drops leading whitespace and one leading '+', as stream extraction does.
+ */
+static std::string_view skip_number_prefix(std::string_view field) {
+    size_t start = 0;
+    while (start < field.size() && is_space(field[start])) ++start;
+    field.remove_prefix(start);
+    if (!field.empty() && field.front() == '+') {
+        field.remove_prefix(1);
+        if (!field.empty() && field.front() == '-') return std::string_view(); // "+-1" is not a number
+    }
+    return field;
+}
+
+std::string_view trim_line(std::string_view line) {
+    size_t start = 0;
+    while (start < line.size() && is_space(line[start])) ++start;
+    size_t end = line.size();
+    while (end > start && is_space(line[end - 1])) --end;
+    return line.substr(start, end - start);
+}
+
+bool parse_number(std::string_view field, double& value) {
+    field = skip_number_prefix(field);
+    const char* end = field.data() + field.size();
+    std::from_chars_result result = std::from_chars(field.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end && std::isfinite(value);
+}
+
+bool parse_count(std::string_view field, int& value) {
+    field = skip_number_prefix(field);
+    return std::from_chars(field.data(), field.data() + field.size(), value).ec == std::errc();
+}
+
+/**
+ * @brief Parses one coordinate and rounds it to the precision PointCloud stores.
+ *
+ * Rounds each coordinate as soon as it is parsed: GCC 12 at -O2 drops the
+ * double-float-double round trip when x and y are converted as a pair.
+ */
+static bool parse_coord(std::string_view field, double& value) {
+    if (!parse_number(field, value) || !coord_fits(value)) return false;
+    value = stored_coord(value);
+    return true;
+}
+
+ParseStatus parse_point(std::string_view text, Point& p) {
+    size_t comma = text.find(',');
+    if (comma == std::string_view::npos) return ParseStatus::BadFormat;
+    if (!parse_coord(text.substr(0, comma), p.x) || !parse_coord(text.substr(comma + 1), p.y))
+        return ParseStatus::BadValue;
+    return ParseStatus::Ok;
+}
+
+ParseStatus parse_point_list(std::string_view text, std::vector<Point>& points) {
+    points.clear();
+    while (!text.empty()) {
+        size_t semicolon = text.find(';');
+        std::string_view item = trim_line(text.substr(0, semicolon));
+        text = semicolon == std::string_view::npos ? std::string_view() : text.substr(semicolon + 1);
+        if (item.empty() && trim_line(text).empty() && !points.empty()) break; // Trailing ';'
+        Point p;
+        ParseStatus status = parse_point(item, p);
+        if (status != ParseStatus::Ok) return status;
+        points.push_back(p);
+    }
+    return ParseStatus::Ok;
+}
+
+void format_point_list(const Point* points, size_t count, std::string& out) {
+    char buffer[64]; // Two shortest round-trip doubles take at most 49 bytes
+    for (size_t i = 0; i < count; ++i) {
+        char* end = buffer;
+        if (i > 0) *end++ = ';';
+        end = std::to_chars(end, buffer + sizeof(buffer), points[i].x).ptr;
+        *end++ = ',';
+        end = std::to_chars(end, buffer + sizeof(buffer), points[i].y).ptr;
+        out.append(buffer, end);
+    }
+}
+
+bool valid_graph_name(std::string_view name) {
+    if (name.empty() || name.size() > GRAPH_NAME_MAX || name.front() == '.') return false;
+    for (char c : name) {
+        bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        bool digit = c >= '0' && c <= '9';
+        if (!letter && !digit && c != '_' && c != '-' && c != '.') return false;
+    }
+    return true;
+}
+
+bool split_request_id(std::string_view& line, std::string_view& id) {
+    id = std::string_view();
+    if (line.empty() || line.front() != '#') return true;
+    size_t end = 1;
+    while (end < line.size() && !is_space(line[end])) ++end;
+    std::string_view token = line.substr(1, end - 1);
+    if (token.empty() || token.size() > REQUEST_ID_MAX) return false;
+    for (char c : token) {
+        bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        bool digit = c >= '0' && c <= '9';
+        if (!letter && !digit && c != '_' && c != '-') return false;
+    }
+    id = token;
+    line = trim_line(line.substr(end));
+    return true;
+}
+
+/**
+ * @brief Maps a command token to its type, dispatching on the token length first.
+ */
+static CommandType command_type(std::string_view token) {
+    switch (token.size()) {
+    case 2:
+        if (token == "CH") return CommandType::CH;
+        break;
+    case 3:
+        if (token == "Use") return CommandType::Use;
+        break;
+    case 5:
+        if (token == "Stats") return CommandType::Stats;
+        break;
+    case 8:
+        if (token == "Newgraph") return CommandType::Newgraph;
+        if (token == "Newpoint") return CommandType::Newpoint;
+        if (token == "Snapshot") return CommandType::Snapshot;
+        if (token == "CHPoints") return CommandType::CHPoints;
+        if (token == "Contains") return CommandType::Contains;
+        if (token == "Diameter") return CommandType::Diameter;
+        break;
+    case 9:
+        if (token == "Newpoints") return CommandType::Newpoints;
+        if (token == "Perimeter") return CommandType::Perimeter;
+        if (token == "Subscribe") return CommandType::Subscribe;
+        break;
+    case 11:
+        if (token == "NewgraphBin") return CommandType::NewgraphBin;
+        if (token == "Removepoint") return CommandType::Removepoint;
+        if (token == "Unsubscribe") return CommandType::Unsubscribe;
+        break;
+    case 12:
+        if (token == "Removepoints") return CommandType::Removepoints;
+        break;
+    case 15:
+        if (token == "MinBoundingRect") return CommandType::MinBoundingRect;
+        break;
+    }
+    return CommandType::Unknown;
+}
+
+const char* command_name(CommandType type) {
+    static const char* const names[] = {
+        "Newgraph", "NewgraphBin", "Newpoint", "Newpoints", "Removepoint", "Removepoints", "CH", "Snapshot", "Use",
+        "CHPoints", "Perimeter", "Contains", "Diameter", "MinBoundingRect", "Subscribe", "Unsubscribe", "Stats",
+        "Unknown"};
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(CommandType::Unknown) + 1,
+                  "One name per CommandType");
+    return names[static_cast<size_t>(type)];
+}
+
+CommandType parse_command(std::string_view line, std::string_view& args) {
+    size_t end = 0;
+    while (end < line.size() && !is_space(line[end])) ++end;
+    args = line.substr(end);
+    size_t start = args.find_first_not_of(' ');
+    args = start == std::string_view::npos ? std::string_view() : args.substr(start);
+    return command_type(line.substr(0, end));
+}
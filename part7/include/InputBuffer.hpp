@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+/**
+ * @file
+ * @brief Per-connection receive buffer with a cursor-based line splitter.
+ */
+
+#define INPUT_READ_MIN 1024        // Smallest recv() size offered to a connection
+#define INPUT_READ_MAX (1 << 20)   // Largest recv() size, reached by bulk loaders
+
+/**
+ * @class InputBuffer
+ * @brief Holds the bytes a client sent that have not been consumed yet.
+ *
+ * Data is received straight into the free space after the unread bytes and
+ * consumed by moving a cursor, so splitting k lines out of one read costs a
+ * single scan and no per-line copies or erases. The unread bytes are moved
+ * back to the front only when the free space runs out, and not at all when
+ * every byte was consumed.
+ *
+ * The recv() size adapts to the client: it doubles while reads fill the
+ * whole window (up to INPUT_READ_MAX) and halves again once reads come back
+ * mostly empty (down to INPUT_READ_MIN).
+ *
+ * Views returned by next_line() and unread() stay valid until the next call
+ * to write_area() or append(). Not thread-safe.
+ */
+class InputBuffer {
+public:
+    /**
+     * @brief Makes room for the next read and returns where it should go.
+     *
+     * @return Space for at least write_size() bytes.
+     */
+    char* write_area();
+
+    /**
+     * @brief Number of bytes the next recv() should ask for.
+     */
+    size_t write_size() const { return read_size; }
+
+    /**
+     * @brief Marks n bytes written into write_area() as received.
+     *
+     * @param n Bytes returned by recv(), at most write_size().
+     */
+    void commit(size_t n);
+
+    /**
+     * @brief Copies bytes received elsewhere (e.g. a kernel-provided buffer) in.
+     *
+     * @param data The received bytes.
+     * @param len Number of bytes.
+     */
+    void append(const char* data, size_t len);
+
+    /**
+     * @brief Takes the next complete line, including its '\n', off the front.
+     *
+     * Bytes already searched by an earlier call are not searched again, so a
+     * long line arriving in many reads is scanned once.
+     *
+     * @param line Set to the line on success.
+     * @return false if no complete line is buffered.
+     */
+    bool next_line(std::string_view& line);
+
+    /**
+     * @brief All bytes received but not consumed yet.
+     */
+    std::string_view unread() const { return std::string_view(storage.data() + head, tail - head); }
+
+    /**
+     * @brief Drops n bytes from the front of unread().
+     */
+    void consume(size_t n);
+
+private:
+    /**
+     * @brief Guarantees n free bytes after the unread ones.
+     */
+    void reserve(size_t n);
+
+    std::vector<char> storage;        // Unread bytes live in [head, tail)
+    size_t head = 0;                  // First unread byte
+    size_t tail = 0;                  // One past the last received byte
+    size_t scanned = 0;               // Unread bytes already known not to contain '\n'
+    size_t read_size = INPUT_READ_MIN; // Current recv() size
+};
@@ -1,8 +1,12 @@
 #include "../include/GeometryUtils.hpp"
+#include "../include/CommandParser.hpp"
+#include "../include/InputBuffer.hpp"
+#include "../include/StateStore.hpp"
+#include "../include/Metrics.hpp"
 #include <iostream>
 #include <sstream>
 #include <string>
-#include <deque>
+#include <string_view>
 #include <unordered_map>
 #include <algorithm>
 #include <cctype>
@@ -11,220 +15,680 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <cstring>
+#include <cmath>
 #include <thread>            // Added for std::thread
 #include <mutex>             // Added for std::mutex
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <future>
+#include <vector>
 
 #define PORT 9034
 #define MAX_CLIENTS 10
+#define POINT_WIRE_SIZE 16 // NewgraphBin point: x then y as little-endian IEEE-754 doubles
+#define DEFAULT_GRAPH "default" // Graph of a client that has not sent Use
 
-std::mutex graph_mutex;     // Added: mutex to protect access to shared graph data
+/**
+ * @struct HullSnapshot
+ * @brief Immutable convex hull of one graph generation, shared by CH readers.
+ *
+ * Published RCU-style: readers load the current snapshot without taking the
+ * graph's mutex and writers only advance its generation. The first CH that
+ * finds an older snapshot copies the hull vertices under the lock, computes
+ * the area outside it and publishes the result; retired snapshots are freed
+ * when their last reader drops them.
+ */
+struct HullSnapshot {
+    uint64_t generation = 0;
+    std::vector<Point> hull; // Hull vertices in counter-clockwise order
+    double area = 0;
+};
+
+/**
+ * @struct Graph
+ * @brief One named point set with its hull and its log.
+ *
+ * mutex protects every member except the atomics, so commands on different
+ * graphs never wait for each other.
+ */
+struct Graph {
+    std::mutex mutex;
+    // Incremented under mutex every time point_set changes
+    std::atomic<uint64_t> generation{0};
+    PointCloud point_set;
+    DynamicHull hull_engine; // Convex hull of point_set, updated in place by every Newpoint/Removepoint
+    // Latest published snapshot, only accessed through std::atomic_load/std::atomic_store
+    std::shared_ptr<const HullSnapshot> hull_snapshot = std::make_shared<HullSnapshot>();
+    // Snapshot being computed, shared by the CH requests that need the same generation meanwhile
+    std::mutex hull_flight_mutex; // Protects the hull_flight members
+    std::shared_future<std::shared_ptr<const HullSnapshot>> hull_flight;
+    uint64_t hull_flight_generation = 0; // generation hull_flight was started for
+    StateStore state_store; // Snapshot and change log of point_set, idle unless --state is given
+};
 
 /**
  * @struct ClientState
  * @brief Stores per-client state including partial input buffer.
  */
 struct ClientState {
-    std::string inbuf;
+    InputBuffer input;      // Received bytes not consumed yet
+    std::string outbuf;     // Responses of the current read, sent with a single send()
+    Graph* graph = nullptr; // Graph the client's commands apply to, DEFAULT_GRAPH until Use
+    // Pending Newgraph, staged here so the graph stays usable until the last point arrives
+    PointCloud temp_points;            // Points received so far
+    int points_to_read = 0;            // Points still expected, 0 when no Newgraph is pending
+    bool binary_graph = false;         // True while the client sends a NewgraphBin payload
+    bool binary_graph_invalid = false; // Set if that payload held a coordinate PointCloud cannot store
+    std::string upload_id;             // Request ID of a NewgraphBin, echoed with its final answer
 };
 
 // --- Shared server state ---
-std::deque<Point> point_set;
-std::deque<Point> temp_points;
-bool waiting_for_graph = false;
-int points_to_read = 0;
-int newgraph_owner_fd = -1;
+thread_local HullWorkspace hull_workspace; // Scratch for hull walks, one per worker thread
+thread_local std::vector<Point> command_points; // Points of the Newpoints/Removepoints being run, one buffer per thread
+std::mutex clients_mutex; // Protects clients
 std::unordered_map<int, ClientState> clients;
+std::mutex graphs_mutex; // Protects graphs
+std::unordered_map<std::string, std::unique_ptr<Graph>> graphs; // Graphs by name, created by their first Use
+Graph* default_graph = nullptr; // DEFAULT_GRAPH, opened before the first client is accepted
+std::string state_root; // --state directory, empty if graphs are not persisted
 
 /**
- * @brief Checks if a string represents a valid number.
- * @param s The input string.
- * @return True if the string can be parsed as a number.
+ * @brief Replaces a graph with the points a client staged for it.
+ *
+ * The hull of the new points is built before the graph's mutex is taken, so
+ * other clients of the graph only wait for the swap, and the replaced points
+ * and hull are freed after the mutex is released.
+ *
+ * @param graph The graph being replaced.
+ * @param state The client that sent the points; its staging buffer is emptied.
  */
-bool is_number(const std::string& s) {
-    std::istringstream iss(s);
-    double d;
-    return (iss >> d) && iss.eof();
+void install_new_graph(Graph& graph, ClientState& state) {
+    DynamicHull hull;
+    uint64_t start = metrics_clock();
+    hull.assign(state.temp_points);
+    metrics_record(Latency::HullBuild, start);
+    {
+        TimedLock lock(graph.mutex);
+        graph.point_set.swap(state.temp_points);
+        graph.hull_engine.swap(hull);
+        ++graph.generation;
+        graph.state_store.snapshot(graph.point_set, graph.hull_engine.vertices(hull_workspace)); // The old log no longer applies
+    }
+    PointCloud().swap(state.temp_points); // Releases the replaced points instead of keeping them per client
 }
 
 /**
- * @brief Trims newline and leading spaces from a string.
- * @param s The string to trim (in-place).
+ * @brief Stages a point line received during a client's Newgraph.
+ *
+ * Only touches the client's own state; the graph is locked once, when the
+ * last point arrives.
+ *
+ * @param state The uploading client.
+ * @param line Input in the form "x,y".
+ * @return "OK", "GRAPH_LOADED", or an error message.
  */
-void trim_crlf(std::string &s) {
-    while (!s.empty() && (s.back() == '\n' || s.back() == '\r')) s.pop_back();
-    while (!s.empty() && std::isspace((unsigned char)s.front())) s.erase(s.begin());
+std::string handle_point_line(ClientState& state, std::string_view line) {
+    Point p;
+    ParseStatus status = parse_point(line, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid point format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid point values.";
+
+    state.temp_points.push_back(p);
+    if (--state.points_to_read > 0) return "OK";
+    install_new_graph(*state.graph, state);
+    return "GRAPH_LOADED";
 }
 
 /**
- * @brief Checks if a file descriptor is blocked from writing due to active graph input.
- * @param fd File descriptor to check.
- * @return True if the client must wait.
+ * @brief Decodes a little-endian IEEE-754 double, whatever the host byte order.
+ *
+ * @param bytes Eight bytes, least significant first.
+ * @return The decoded value.
  */
-bool is_busy_for_fd(int fd) {
-    return waiting_for_graph && fd != newgraph_owner_fd;
+double read_le_double(const char* bytes) {
+    uint64_t bits = 0;
+    for (int i = 7; i >= 0; --i) bits = (bits << 8) | static_cast<unsigned char>(bytes[i]);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
 }
 
 /**
- * @brief Handles input line containing a single point during Newgraph construction.
- * @param line The input line.
- * @return Response message for the client.
+ * @brief Prefixes a response with the request ID of the command it answers.
+ *
+ * @param id The ID without '#', empty for an untagged command.
+ * @param response The response; an empty one (no answer) stays empty.
+ * @return "#ID response", or response itself when there is nothing to tag.
  */
-std::string handle_point_line(const std::string& line) {
-    std::lock_guard<std::mutex> lock(graph_mutex); // Protect access to shared temp_points
-    size_t comma = line.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid point format.";
-    std::string x_str = line.substr(0, comma);
-    std::string y_str = line.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid point values.";
+std::string tag_response(std::string_view id, std::string response) {
+    if (id.empty() || response.empty()) return response;
+    std::string tagged;
+    tagged.reserve(id.size() + 2 + response.size());
+    tagged += '#';
+    tagged.append(id.data(), id.size());
+    tagged += ' ';
+    tagged += response;
+    return tagged;
+}
 
-    Point p{std::stod(x_str), std::stod(y_str)};
-    temp_points.push_back(p);
-    points_to_read--;
-    if (points_to_read == 0) {
-        point_set = temp_points;
-        temp_points.clear();
-        waiting_for_graph = false;
-        newgraph_owner_fd = -1;
-        return "GRAPH_LOADED";
+/**
+ * @brief Moves the NewgraphBin points buffered so far straight into the client's staging buffer.
+ *
+ * Consumes whole points from the front of the client's unread input without
+ * any text parsing. A trailing partial point stays buffered for the next read.
+ *
+ * @param state The uploading client; consumed points are removed from its input.
+ * @return "GRAPH_LOADED" or an error once the payload is complete, "" while points are missing.
+ */
+std::string handle_binary_points(ClientState& state) {
+    InputBuffer& input = state.input;
+    std::string_view unread = input.unread();
+    size_t count = std::min(unread.size() / POINT_WIRE_SIZE, static_cast<size_t>(state.points_to_read));
+    const char* data = unread.data();
+    for (size_t i = 0; i < count; ++i, data += POINT_WIRE_SIZE) {
+        Point p{read_le_double(data), read_le_double(data + 8)};
+        if (!coord_fits(p.x) || !coord_fits(p.y)) state.binary_graph_invalid = true;
+        else state.temp_points.push_back(p);
     }
-    return "OK";
+    input.consume(count * POINT_WIRE_SIZE);
+    state.points_to_read -= static_cast<int>(count);
+    if (state.points_to_read > 0) return "";
+
+    state.binary_graph = false;
+    if (state.binary_graph_invalid) {
+        PointCloud().swap(state.temp_points);
+        return tag_response(state.upload_id, "ERROR: Invalid point values.");
+    }
+    install_new_graph(*state.graph, state);
+    return tag_response(state.upload_id, "GRAPH_LOADED");
+}
+
+/**
+ * @brief Starts a background snapshot once enough changes were logged since the last one.
+ *
+ * Must be called with the graph's mutex held.
+ * @param graph The graph that changed.
+ */
+void snapshot_if_due(Graph& graph) {
+    if (graph.state_store.snapshot_due()) graph.state_store.snapshot(graph.point_set, graph.hull_engine.vertices(hull_workspace));
 }
 
 /**
  * @brief Adds a single point to the graph (via Newpoint).
+ * @param graph The client's graph.
  * @param args Arguments after the command (x,y).
  * @return Response message.
  */
-std::string handle_newpoint(const std::string& args) {
-    std::lock_guard<std::mutex> lock(graph_mutex); // Protect access to point_set
-    size_t comma = args.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid format.";
-    std::string x_str = args.substr(0, comma);
-    std::string y_str = args.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid values.";
-    Point p{std::stod(x_str), std::stod(y_str)};
-    point_set.push_back(p);
+std::string handle_newpoint(Graph& graph, std::string_view args) {
+    TimedLock lock(graph.mutex); // Protect access to point_set
+    Point p;
+    ParseStatus status = parse_point(args, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    graph.point_set.push_back(p);
+    graph.hull_engine.insert(p);
+    ++graph.generation;
+    graph.state_store.log_insert(p);
+    snapshot_if_due(graph);
     return "OK";
 }
 
 /**
  * @brief Removes a specific point from the graph.
+ * @param graph The client's graph.
  * @param args Arguments after the command (x,y).
  * @return Response message.
  */
-std::string handle_removepoint(const std::string& args) {
-    std::lock_guard<std::mutex> lock(graph_mutex); // Protect access to point_set
-    size_t comma = args.find(',');
-    if (comma == std::string::npos) return "ERROR: Invalid format.";
-    std::string x_str = args.substr(0, comma);
-    std::string y_str = args.substr(comma + 1);
-    if (!is_number(x_str) || !is_number(y_str)) return "ERROR: Invalid values.";
-    Point p{std::stod(x_str), std::stod(y_str)};
-    auto it = std::remove_if(point_set.begin(), point_set.end(),
-                             [&](const Point& q) { return q.x == p.x && q.y == p.y; });
-    if (it != point_set.end()) point_set.erase(it, point_set.end());
+std::string handle_removepoint(Graph& graph, std::string_view args) {
+    TimedLock lock(graph.mutex); // Protect access to point_set
+    Point p;
+    ParseStatus status = parse_point(args, p);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    if (graph.point_set.remove_all(p) > 0) {
+        graph.hull_engine.erase(p);
+        ++graph.generation;
+        graph.state_store.log_remove(p);
+        snapshot_if_due(graph);
+    }
+    return "OK";
+}
+
+/**
+ * @brief Parses the "k x1,y1;...;xk,yk" arguments of Newpoints and Removepoints.
+ *
+ * @param args Arguments after the command.
+ * @param points Receives the k points.
+ * @return An empty string on success, else the error message.
+ */
+std::string parse_point_batch(std::string_view args, std::vector<Point>& points) {
+    int n;
+    if (!parse_count(args, n) || n <= 0) return "ERROR: Invalid number.";
+    size_t space = args.find_first_of(" \t");
+    ParseStatus status = parse_point_list(space == std::string_view::npos ? std::string_view() : args.substr(space + 1), points);
+    if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+    if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    if (points.size() != static_cast<size_t>(n)) return "ERROR: Point count mismatch.";
+    return "";
+}
+
+/**
+ * @brief Adds a batch of points to the graph (via Newpoints).
+ *
+ * Either every point is added or, if any of them is invalid, none. The
+ * points are parsed before the graph's mutex is taken, which is then held once
+ * for the whole batch. The hull takes the batch in one insert_batch() call and
+ * the log in one write().
+ *
+ * @param graph The client's graph.
+ * @param args Arguments after the command (k x1,y1;...;xk,yk).
+ * @return Response message.
+ */
+std::string handle_newpoints(Graph& graph, std::string_view args) {
+    std::string error = parse_point_batch(args, command_points);
+    if (!error.empty()) return error;
+    TimedLock lock(graph.mutex);
+    for (const Point& p : command_points) graph.point_set.push_back(p);
+    graph.hull_engine.insert_batch(command_points);
+    ++graph.generation;
+    graph.state_store.log_inserts(command_points);
+    snapshot_if_due(graph);
+    return "OK";
+}
+
+/**
+ * @brief Removes every copy of each point of a batch from the graph (via Removepoints).
+ *
+ * Validated and applied like Newpoints; points not in the graph are ignored.
+ *
+ * @param graph The client's graph.
+ * @param args Arguments after the command (k x1,y1;...;xk,yk).
+ * @return Response message.
+ */
+std::string handle_removepoints(Graph& graph, std::string_view args) {
+    std::string error = parse_point_batch(args, command_points);
+    if (!error.empty()) return error;
+    TimedLock lock(graph.mutex);
+    // Keep only the points that were present, which are the ones the hull and the log need
+    size_t removed = 0;
+    for (const Point& p : command_points) {
+        if (graph.point_set.remove_all(p) > 0) command_points[removed++] = p;
+    }
+    command_points.resize(removed);
+    if (removed > 0) {
+        graph.hull_engine.erase_batch(command_points);
+        ++graph.generation;
+        graph.state_store.log_removes(command_points);
+        snapshot_if_due(graph);
+    }
     return "OK";
 }
 
 /**
- * @brief Computes the convex hull of the graph and returns its area.
+ * @brief Returns the hull snapshot of the current graph generation.
+ *
+ * Lock-free while the graph is unchanged; otherwise holds the graph's mutex only
+ * for the O(h) copy of the hull vertices.
+ *
+ * Single flight: requests that find the same stale generation while a
+ * snapshot of it is being computed wait for that computation and share its
+ * result, so a burst of CH requests after a write builds one snapshot.
+ *
+ * @param graph The client's graph.
+ * @return The snapshot, valid for as long as the caller keeps it.
+ */
+std::shared_ptr<const HullSnapshot> current_hull_snapshot(Graph& graph) {
+    std::shared_ptr<const HullSnapshot> snapshot = std::atomic_load(&graph.hull_snapshot);
+    uint64_t generation = graph.generation;
+    if (snapshot->generation == generation) return snapshot;
+
+    // Join the computation of this generation if one is running, otherwise lead one
+    std::promise<std::shared_ptr<const HullSnapshot>> result;
+    std::shared_future<std::shared_ptr<const HullSnapshot>> flight;
+    {
+        std::lock_guard<std::mutex> lock(graph.hull_flight_mutex);
+        if (graph.hull_flight.valid() && graph.hull_flight_generation == generation) {
+            flight = graph.hull_flight;
+        } else {
+            graph.hull_flight = result.get_future().share();
+            graph.hull_flight_generation = generation;
+        }
+    }
+    if (flight.valid()) {
+        metrics_count(Counter::HullJoins);
+        return flight.get(); // The leader read the generation after this request saw it, so it is at least as new
+    }
+
+    std::shared_ptr<HullSnapshot> fresh = std::make_shared<HullSnapshot>();
+    uint64_t start;
+    {
+        TimedLock lock(graph.mutex);
+        start = metrics_clock();
+        fresh->generation = graph.generation;
+        fresh->hull = graph.hull_engine.vertices(hull_workspace);
+    }
+    fresh->area = compute_area(fresh->hull);
+    metrics_record(Latency::HullRead, start);
+
+    // Publish unless a concurrent CH already published a newer generation
+    std::shared_ptr<const HullSnapshot> published = fresh;
+    while (snapshot->generation < fresh->generation &&
+           !std::atomic_compare_exchange_weak(&graph.hull_snapshot, &snapshot, published)) {
+    }
+    result.set_value(fresh);
+    std::lock_guard<std::mutex> lock(graph.hull_flight_mutex);
+    if (graph.hull_flight_generation == generation) graph.hull_flight = {}; // Still ours: later requests read the published snapshot
+    return fresh;
+}
+
+/**
+ * @brief Returns the convex hull area of the current graph snapshot.
+ * @param graph The client's graph.
  * @return Area as a string.
  */
-std::string handle_ch() {
-    std::lock_guard<std::mutex> lock(graph_mutex); // Protect read access to point_set
-    auto hull = compute_convex_hull_deque(point_set);
-    double area = compute_area(hull);
+std::string handle_ch(Graph& graph) {
+    double area = current_hull_snapshot(graph)->area;
     std::ostringstream oss;
     oss << area;
     return oss.str();
 }
 
 /**
- * @brief Parses and processes a full client command line.
- * @param fd The client's file descriptor.
- * @param rawline The full input line.
- * @return Response string.
+ * @brief Answers the queries computed from the hull alone.
+ *
+ * Reads the published hull snapshot like CH, so the graph's mutex is only taken
+ * when the graph changed since the last query, and then just for the O(h) copy.
+ * - CHPoints: "h x1,y1;...;xh,yh", the vertices counter-clockwise.
+ * - Perimeter, Diameter: a number.
+ * - Contains x,y: "YES" if the point is inside or on the hull, else "NO", in O(log h).
+ * - MinBoundingRect: "area x1,y1;...;x4,y4", the corners counter-clockwise, or
+ *   "0" for an empty graph.
+ *
+ * @param graph The client's graph.
+ * @param command CHPoints, Perimeter, Contains, Diameter or MinBoundingRect.
+ * @param args Arguments after the command (x,y for Contains).
+ * @return Response message.
  */
-std::string process_line(int fd, const std::string& rawline) {
-    std::string line = rawline;
-    trim_crlf(line);
-    if (line.empty()) return "";
+std::string handle_hull_query(Graph& graph, CommandType command, std::string_view args) {
+    Point p{0, 0};
+    if (command == CommandType::Contains) {
+        ParseStatus status = parse_point(args, p);
+        if (status == ParseStatus::BadFormat) return "ERROR: Invalid format.";
+        if (status == ParseStatus::BadValue) return "ERROR: Invalid values.";
+    }
+    std::shared_ptr<const HullSnapshot> snapshot = current_hull_snapshot(graph);
+    const std::vector<Point>& hull = snapshot->hull;
 
-    if (waiting_for_graph && fd != newgraph_owner_fd) {
-        return "BUSY";
+    std::ostringstream oss;
+    switch (command) {
+    case CommandType::CHPoints: {
+        std::string response = std::to_string(hull.size());
+        if (!hull.empty()) response += ' ';
+        format_point_list(hull.data(), hull.size(), response);
+        return response;
+    }
+    case CommandType::Perimeter:
+        oss << compute_perimeter(hull);
+        return oss.str();
+    case CommandType::Contains:
+        return hull_contains(hull, p) ? "YES" : "NO";
+    case CommandType::Diameter:
+        oss << hull_diameter(hull);
+        return oss.str();
+    default: {
+        if (hull.empty()) return "0";
+        BoundingRect rect = min_bounding_rect(hull);
+        oss << rect.area << ' ';
+        std::string response = oss.str();
+        format_point_list(rect.corners, 4, response);
+        return response;
+    }
     }
+}
+
+/**
+ * @brief Handles the Snapshot command: writes the graph to the state directory now.
+ *
+ * @param graph The client's graph.
+ * @return "OK" once the background write has started, or an error message.
+ */
+std::string handle_snapshot(Graph& graph) {
+    TimedLock lock(graph.mutex);
+    if (!graph.state_store.is_open()) return "ERROR: No state directory.";
+    if (!graph.state_store.snapshot(graph.point_set, graph.hull_engine.vertices(hull_workspace))) return "ERROR: Snapshot failed.";
+    return "OK";
+}
+
+/**
+ * @brief Returns the graph with the given name, creating it on first use.
+ *
+ * With a state directory a new graph is restored from its own directory
+ * (the state directory itself for DEFAULT_GRAPH, graph.NAME inside it for
+ * the others). A snapshot without later changes also holds the hull, which
+ * is published right away so the first CH does not have to walk the rebuilt
+ * tree.
+ *
+ * @param name A name accepted by valid_graph_name().
+ * @param error Receives a message if the graph cannot be restored.
+ * @return The graph, or nullptr on failure. Graphs are never freed.
+ */
+Graph* open_graph(const std::string& name, std::string& error) {
+    std::lock_guard<std::mutex> lock(graphs_mutex);
+    auto it = graphs.find(name);
+    if (it != graphs.end()) return it->second.get();
+
+    std::unique_ptr<Graph> graph(new Graph);
+    if (!state_root.empty()) {
+        std::string dir = name == DEFAULT_GRAPH ? state_root : state_root + "/graph." + name;
+        std::vector<Point> saved_hull;
+        if (!graph->state_store.open(dir, graph->point_set, saved_hull, error)) return nullptr;
+        uint64_t start = metrics_clock();
+        graph->hull_engine.assign(graph->point_set);
+        metrics_record(Latency::HullBuild, start);
+        ++graph->generation;
+        if (!saved_hull.empty()) {
+            std::shared_ptr<HullSnapshot> restored = std::make_shared<HullSnapshot>();
+            restored->generation = graph->generation;
+            restored->area = compute_area(saved_hull);
+            restored->hull = std::move(saved_hull);
+            graph->hull_snapshot = restored; // Not shared with any reader yet
+        }
+        if (!graph->point_set.empty())
+            std::cout << "Restored " << graph->point_set.size() << " point(s) of " << name << " from " << dir << std::endl;
+    }
+    return graphs.emplace(name, std::move(graph)).first->second.get();
+}
+
+/**
+ * @brief Handles the Use command: switches the client to another graph.
+ *
+ * @param state The client's state.
+ * @param args The graph name.
+ * @return "OK" or an error message.
+ */
+std::string handle_use(ClientState& state, std::string_view args) {
+    if (!valid_graph_name(args)) return "ERROR: Invalid graph name.";
+    std::string error;
+    Graph* graph = open_graph(std::string(args), error);
+    if (!graph) {
+        std::cerr << "Cannot restore graph " << args << ": " << error << std::endl;
+        return "ERROR: Cannot open graph.";
+    }
+    state.graph = graph;
+    return "OK";
+}
 
-    if (waiting_for_graph && fd == newgraph_owner_fd) {
-        return handle_point_line(line);
+/**
+ * @brief Handles the Stats command: reports the server's counters and latencies.
+ *
+ * Appends the number of graphs and their total point count to metrics_report().
+ *
+ * @return The report, or an error if the server was built with METRICS=0.
+ */
+std::string handle_stats() {
+#if METRICS
+    size_t graph_count, points = 0;
+    {
+        std::lock_guard<std::mutex> lock(graphs_mutex);
+        graph_count = graphs.size();
+        for (auto& entry : graphs) {
+            std::lock_guard<std::mutex> graph_lock(entry.second->mutex);
+            points += entry.second->point_set.size();
+        }
     }
+    return metrics_report() + " graphs=" + std::to_string(graph_count) + " points=" + std::to_string(points);
+#else
+    return "ERROR: Metrics are disabled.";
+#endif
+}
 
-    std::istringstream iss(line);
-    std::string command;
-    iss >> command;
-    std::string args;
-    std::getline(iss, args);
-    size_t pos = args.find_first_not_of(" ");
-    if (pos != std::string::npos) args.erase(0, pos);
-    else args.clear();
+/**
+ * @brief Executes one command line, once its request ID is split off.
+ * @param state The client's state, which selects its graph.
+ * @param line The trimmed command or point line.
+ * @param command Receives the parsed command; left unchanged for a point line.
+ * @return Response string.
+ */
+std::string run_command(ClientState& state, std::string_view line, CommandType& command) {
+    Graph& graph = *state.graph;
+
+    if (state.points_to_read > 0) return handle_point_line(state, line);
+
+    std::string_view args;
+    command = parse_command(line, args);
 
-    if (command == "Newgraph") {
-        std::lock_guard<std::mutex> lock(graph_mutex); // Protect write to shared state
-        std::istringstream a(args);
+    if (command == CommandType::Newgraph) {
         int n;
-        if (!(a >> n) || n <= 0) return "ERROR: Invalid number.";
-        waiting_for_graph = true;
-        newgraph_owner_fd = fd;
-        points_to_read = n;
-        temp_points.clear();
+        if (!parse_count(args, n) || n <= 0) return "ERROR: Invalid number.";
+        state.binary_graph = false;
+        state.points_to_read = n;
+        state.temp_points.clear();
+        state.temp_points.reserve(std::min(n, 1 << 20)); // Cap what an untrusted count can preallocate
         return "OK";
     }
-    if (command == "Newpoint") return handle_newpoint(args);
-    if (command == "Removepoint") return handle_removepoint(args);
-    if (command == "CH") return handle_ch();
+    if (command == CommandType::NewgraphBin) {
+        int n;
+        if (!parse_count(args, n) || n <= 0) return "ERROR: Invalid number.";
+        state.binary_graph = true;
+        state.binary_graph_invalid = false;
+        state.points_to_read = n;
+        state.temp_points.clear();
+        state.temp_points.reserve(std::min(n, 1 << 20)); // Cap what an untrusted count can preallocate
+        return ""; // Acknowledged once, after the payload
+    }
+    if (command == CommandType::Newpoint) return handle_newpoint(graph, args);
+    if (command == CommandType::Removepoint) return handle_removepoint(graph, args);
+    if (command == CommandType::Newpoints) return handle_newpoints(graph, args);
+    if (command == CommandType::Removepoints) return handle_removepoints(graph, args);
+    if (command == CommandType::CH) return handle_ch(graph);
+    if (command == CommandType::CHPoints || command == CommandType::Perimeter || command == CommandType::Contains ||
+        command == CommandType::Diameter || command == CommandType::MinBoundingRect)
+        return handle_hull_query(graph, command, args);
+    if (command == CommandType::Snapshot) return handle_snapshot(graph);
+    if (command == CommandType::Use) return handle_use(state, args);
+    if (command == CommandType::Stats) return handle_stats();
 
     return "ERROR: Unknown command.";
 }
 
+/**
+ * @brief Answers a line received from a client, echoing its request ID if it has one.
+ *
+ * @param state The client's state, which selects its graph.
+ * @param rawline The raw input line.
+ * @return Response string, "" if the line needs no answer yet.
+ */
+std::string process_line(ClientState& state, std::string_view rawline) {
+    std::string_view line = trim_line(rawline);
+    if (line.empty()) return "";
+    std::string_view id;
+    if (!split_request_id(line, id)) return "ERROR: Invalid request ID.";
+    CommandType command = CommandType::Unknown;
+    bool timed = state.points_to_read == 0; // Lines of a Newgraph upload are not commands
+    uint64_t start = metrics_clock();
+    std::string response = run_command(state, line, command);
+    if (timed) metrics_record_command(command, start);
+    if (state.binary_graph && response.empty()) state.upload_id.assign(id.data(), id.size()); // Answered after the payload
+    return tag_response(id, std::move(response));
+}
+
 /**
  * @brief Handles interaction with a single connected client.
  * @param client_fd The socket file descriptor of the client.
  */
 void handle_client(int client_fd) {
-    char buffer[1024];
+    metrics_gauge_add(Gauge::ProactorThreads, 1); // One thread per client
+    ClientState* state;
+    {
+        // Map nodes are stable, so the entry can be used after the lock is released
+        std::lock_guard<std::mutex> lock(clients_mutex);
+        state = &clients[client_fd];
+    }
+    InputBuffer& input = state->input;
     while (true) {
-        int bytes = recv(client_fd, buffer, sizeof(buffer), 0);
+        int bytes = recv(client_fd, input.write_area(), input.write_size(), 0); // Receive straight into the buffer
         if (bytes <= 0) {
             close(client_fd);
-            std::lock_guard<std::mutex> lock(graph_mutex);
-            clients.erase(client_fd);
-            if (waiting_for_graph && client_fd == newgraph_owner_fd) {
-                waiting_for_graph = false;
-                temp_points.clear();
-                newgraph_owner_fd = -1;
-            }
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            clients.erase(client_fd); // Drops any upload the client staged
             break;
         }
 
-        std::string& inbuf = clients[client_fd].inbuf;
-        inbuf.append(buffer, bytes);
-        size_t pos;
-        while ((pos = inbuf.find('\n')) != std::string::npos) {
-            std::string line = inbuf.substr(0, pos + 1);
-            inbuf.erase(0, pos + 1);
-            std::string response = process_line(client_fd, line);
+        input.commit(bytes);
+        while (true) {
+            std::string_view line;
+            std::string response;
+            if (state->binary_graph) {
+                response = handle_binary_points(*state);
+                if (response.empty()) break; // Rest of the payload is still in flight
+            } else {
+                if (!input.next_line(line)) break; // Slice of the buffer, no copy
+                response = process_line(*state, line);
+            }
             if (!response.empty()) {
-                response += "\n";
-                send(client_fd, response.c_str(), response.size(), 0);
+                state->outbuf += response;
+                state->outbuf += '\n';
             }
         }
+        if (!state->outbuf.empty()) {
+            send(client_fd, state->outbuf.data(), state->outbuf.size(), 0);
+            state->outbuf.clear();
+        }
     }
+    metrics_gauge_add(Gauge::ProactorThreads, -1);
 }
 
 /**
  * @brief Main server loop. Accepts clients and launches threads to serve them.
+ *
+ * Options:
+ * - --state DIR: restore the graphs saved in DIR when they are first used,
+ *   then keep DIR up to date with change logs and snapshots (every Newgraph,
+ *   every SNAPSHOT_LOG_RECORDS changes and on the Snapshot command).
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments (see the options above).
  * @return Exit code.
  */
-int main() {
+int main(int argc, char* argv[]) {
+    const char* state_dir = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--state") == 0 && i + 1 < argc) {
+            state_dir = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--state DIR]" << std::endl;
+            return 1;
+        }
+    }
+    if (state_dir) state_root = state_dir;
+    std::string error;
+    default_graph = open_graph(DEFAULT_GRAPH, error);
+    if (!default_graph) {
+        std::cerr << "Cannot restore the graph: " << error << std::endl;
+        return 1;
+    }
+
     int listener = socket(AF_INET, SOCK_STREAM, 0);
     sockaddr_in server{};
     server.sin_family = AF_INET;
@@ -239,8 +703,9 @@ int main() {
         int client_fd = accept(listener, nullptr, nullptr);
         if (client_fd >= 0) {
             {
-                std::lock_guard<std::mutex> lock(graph_mutex);
+                std::lock_guard<std::mutex> lock(clients_mutex);
                 clients[client_fd] = ClientState{};
+                clients[client_fd].graph = default_graph;
             }
             std::thread t(handle_client, client_fd); // Launch new thread per client
             t.detach(); // Detach thread so it runs independently
@@ -1,6 +1,8 @@
 #include "../include/GeometryUtils.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 /**
  * @brief Operator overload to compare Points lexicographically (by x, then y).
@@ -25,16 +27,14 @@ static double cross(const Point& O, const Point& A, const Point& B) {
 }
 
 /**
- * @brief Computes the convex hull of a set of points using the monotone chain algorithm.
- * 
- * @param points A deque of 2D points.
- * @return std::deque<Point> representing the convex hull in counter-clockwise order.
+ * @brief Runs the Monotone Chain scan over lexicographically sorted points.
+ *
+ * @param points A sorted container with at least two points.
+ * @return A deque of points forming the convex hull in counter-clockwise order.
  */
-std::deque<Point> compute_convex_hull_deque(std::deque<Point> points) {
+template <typename Points>
+static std::deque<Point> chain_of_sorted(const Points& points) {
     size_t n = points.size();
-    if (n <= 1) return points;
-
-    std::sort(points.begin(), points.end());
     std::deque<Point> hull;
 
     for (size_t i = 0; i < n; ++i) {
@@ -56,18 +56,1021 @@ std::deque<Point> compute_convex_hull_deque(std::deque<Point> points) {
 }
 
 /**
- * @brief Computes the area of a simple polygon using the shoelace formula.
+ * @brief Computes the convex hull of a set of points using the monotone chain algorithm.
  * 
- * @param polygon A deque of points forming the polygon (assumed to be in order).
+ * @param points A deque of 2D points.
+ * @return std::deque<Point> representing the convex hull in counter-clockwise order.
+ */
+std::deque<Point> compute_convex_hull_deque(std::deque<Point> points) {
+    if (points.size() <= 1) return points;
+    std::sort(points.begin(), points.end());
+    return chain_of_sorted(points);
+}
+
+/**
+ * @brief Monotone Chain over an index buffer, writing into a workspace.
+ *
+ * @param points A container with size() and operator[] returning points.
+ * @param workspace Receives the sorted indices and the hull.
+ */
+template <typename Points>
+static void chain_into(const Points& points, HullWorkspace& workspace) {
+    size_t n = points.size();
+    std::vector<size_t>& order = workspace.order;
+    std::vector<Point>& hull = workspace.hull;
+    order.resize(n);
+    for (size_t i = 0; i < n; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return points[a] < points[b]; });
+
+    hull.clear();
+    if (n <= 1) {
+        if (n == 1) hull.push_back(points[0]);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        Point p = points[order[i]];
+        while (hull.size() >= 2 && cross(hull[hull.size() - 2], hull.back(), p) <= 0) hull.pop_back();
+        hull.push_back(p);
+    }
+    size_t t = hull.size() + 1;
+    for (size_t i = n - 1; i-- > 0;) {
+        Point p = points[order[i]];
+        while (hull.size() >= t && cross(hull[hull.size() - 2], hull.back(), p) <= 0) hull.pop_back();
+        hull.push_back(p);
+    }
+    hull.pop_back();
+}
+
+const std::vector<Point>& compute_convex_hull_deque(const std::deque<Point>& points, HullWorkspace& workspace) {
+    chain_into(points, workspace);
+    return workspace.hull;
+}
+
+/**
+ * @brief Shoelace sum over any indexable container of ordered vertices.
+ *
+ * @param polygon A container with size() and operator[] returning points.
  * @return The absolute area of the polygon.
  */
-double compute_area(const std::deque<Point>& polygon) {
+template <typename Points>
+static double shoelace_area(const Points& polygon) {
     double area = 0;
     size_t n = polygon.size();
     for (size_t i = 0; i < n; ++i) {
-        const Point& p1 = polygon[i];
-        const Point& p2 = polygon[(i + 1) % n];
+        const Point p1 = polygon[i];
+        const Point p2 = polygon[(i + 1) % n];
         area += (p1.x * p2.y - p2.x * p1.y);
     }
     return std::abs(area) / 2.0;
 }
+
+/**
+ * @brief Computes the area of a simple polygon using the shoelace formula.
+ * 
+ * @param polygon A deque of points forming the polygon (assumed to be in order).
+ * @return The absolute area of the polygon.
+ */
+double compute_area(const std::deque<Point>& polygon) {
+    return shoelace_area(polygon);
+}
+
+#define NO_POINT 0xffffffffu // Index of no point: a free bucket or the end of a copy chain
+
+/**
+ * @brief Hashes a point by the bit patterns of its coordinates.
+ *
+ * -0.0 and 0.0 compare equal, so both hash as 0.0.
+ */
+static size_t point_hash(double px, double py) {
+    px += 0.0;
+    py += 0.0;
+    uint64_t a, b;
+    std::memcpy(&a, &px, sizeof(a));
+    std::memcpy(&b, &py, sizeof(b));
+    uint64_t h = a ^ (b * 0x9E3779B97F4A7C15ull);
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ull; // splitmix64 finalizer
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBull;
+    h ^= h >> 31;
+    return static_cast<size_t>(h);
+}
+
+size_t PointCloud::size() const {
+    return x.size();
+}
+
+bool PointCloud::empty() const {
+    return x.empty();
+}
+
+size_t PointCloud::capacity() const {
+    return std::min(x.capacity(), y.capacity());
+}
+
+void PointCloud::reserve(size_t n) {
+    x.reserve(n);
+    y.reserve(n);
+}
+
+void PointCloud::clear() {
+    x.clear();
+    y.clear();
+    buckets.clear();
+    next_copy.clear();
+    distinct = 0;
+}
+
+void PointCloud::push_back(const Point& p) {
+    x.push_back(static_cast<PointCoord>(p.x));
+    y.push_back(static_cast<PointCoord>(p.y));
+    if (buckets.empty()) return;
+    next_copy.push_back(NO_POINT);
+    if ((distinct + 1) * 2 > buckets.size()) build_index(); // Keep the table at most half full
+    else link(static_cast<uint32_t>(x.size() - 1));
+}
+
+Point PointCloud::operator[](size_t i) const {
+    return Point{x[i], y[i]};
+}
+
+const PointCoord* PointCloud::xs() const {
+    return x.data();
+}
+
+const PointCoord* PointCloud::ys() const {
+    return y.data();
+}
+
+size_t PointCloud::remove_all(const Point& p) {
+    ensure_index();
+    size_t removed = 0;
+    while (true) {
+        size_t b = find_bucket(p.x, p.y);
+        uint32_t first = buckets[b];
+        if (first == NO_POINT) break;
+        if (next_copy[first] == NO_POINT) erase_bucket(b);
+        else buckets[b] = next_copy[first];
+        move_last_into(first);
+        ++removed;
+    }
+    return removed;
+}
+
+bool PointCloud::push_unique(const Point& p) {
+    ensure_index();
+    if (buckets[find_bucket(p.x, p.y)] != NO_POINT) return false;
+    push_back(p);
+    return true;
+}
+
+size_t PointCloud::count(const Point& p) {
+    ensure_index();
+    size_t copies = 0;
+    for (uint32_t i = buckets[find_bucket(p.x, p.y)]; i != NO_POINT; i = next_copy[i]) ++copies;
+    return copies;
+}
+
+void PointCloud::swap(PointCloud& other) {
+    x.swap(other.x);
+    y.swap(other.y);
+    buckets.swap(other.buckets);
+    next_copy.swap(other.next_copy);
+    std::swap(distinct, other.distinct);
+}
+
+void PointCloud::build_index() {
+    size_t slots = 16;
+    while (slots < 2 * x.size() + 2) slots <<= 1;
+    buckets.assign(slots, NO_POINT);
+    next_copy.assign(x.size(), NO_POINT);
+    distinct = 0;
+    for (size_t i = 0; i < x.size(); ++i) link(static_cast<uint32_t>(i));
+}
+
+void PointCloud::ensure_index() {
+    if (buckets.empty()) build_index();
+}
+
+void PointCloud::link(uint32_t i) {
+    size_t b = find_bucket(x[i], y[i]);
+    if (buckets[b] == NO_POINT) ++distinct;
+    next_copy[i] = buckets[b];
+    buckets[b] = i;
+}
+
+size_t PointCloud::find_bucket(double px, double py) const {
+    size_t mask = buckets.size() - 1;
+    size_t b = point_hash(px, py) & mask;
+    while (buckets[b] != NO_POINT && !(x[buckets[b]] == px && y[buckets[b]] == py)) b = (b + 1) & mask;
+    return b;
+}
+
+void PointCloud::erase_bucket(size_t b) {
+    size_t mask = buckets.size() - 1;
+    size_t hole = b;
+    for (size_t j = (b + 1) & mask; buckets[j] != NO_POINT; j = (j + 1) & mask) {
+        uint32_t i = buckets[j];
+        size_t home = point_hash(x[i], y[i]) & mask;
+        if (((j - home) & mask) >= ((j - hole) & mask)) { // The hole lies on i's probe path
+            buckets[hole] = i;
+            hole = j;
+        }
+    }
+    buckets[hole] = NO_POINT;
+    --distinct;
+}
+
+void PointCloud::move_last_into(uint32_t hole) {
+    uint32_t last = static_cast<uint32_t>(x.size() - 1);
+    if (hole != last) {
+        uint32_t* ref = &buckets[find_bucket(x[last], y[last])]; // Whatever points at last now points at hole
+        while (*ref != last) ref = &next_copy[*ref];
+        *ref = hole;
+        x[hole] = x[last];
+        y[hole] = y[last];
+        next_copy[hole] = next_copy[last];
+    }
+    x.pop_back();
+    y.pop_back();
+    next_copy.pop_back();
+}
+
+/**
+ * @brief Copies any indexable point container into a lexicographically sorted vector.
+ *
+ * @param points A container with size() and operator[] returning points.
+ * @return The sorted points.
+ */
+template <typename Points>
+static std::vector<Point> sorted_points(const Points& points) {
+    std::vector<Point> sorted(points.size());
+    for (size_t i = 0; i < sorted.size(); ++i) sorted[i] = points[i];
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+std::deque<Point> compute_convex_hull_deque(const PointCloud& points) {
+    if (points.size() <= 1) {
+        std::deque<Point> hull;
+        if (!points.empty()) hull.push_back(points[0]);
+        return hull;
+    }
+    return chain_of_sorted(sorted_points(points));
+}
+
+double compute_area(const PointCloud& polygon) {
+    return shoelace_area(polygon);
+}
+
+double compute_area(const std::vector<Point>& polygon) {
+    return shoelace_area(polygon);
+}
+
+double compute_perimeter(const std::vector<Point>& polygon) {
+    size_t n = polygon.size();
+    if (n < 2) return 0;
+    double perimeter = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const Point& a = polygon[i];
+        const Point& b = polygon[(i + 1) % n];
+        perimeter += std::hypot(b.x - a.x, b.y - a.y);
+    }
+    return perimeter;
+}
+
+bool hull_contains(const std::vector<Point>& hull, const Point& p) {
+    size_t h = hull.size();
+    if (h == 0) return false;
+    const Point& o = hull[0];
+    if (h == 1) return p.x == o.x && p.y == o.y;
+    if (h == 2) {
+        const Point& b = hull[1];
+        return RobustOrientation::orient(o, b, p) == 0 && std::min(o.x, b.x) <= p.x && p.x <= std::max(o.x, b.x) &&
+               std::min(o.y, b.y) <= p.y && p.y <= std::max(o.y, b.y);
+    }
+    if (RobustOrientation::orient(o, hull[1], p) < 0 || RobustOrientation::orient(o, hull[h - 1], p) > 0) return false;
+
+    // Find the triangle o, hull[lo], hull[lo + 1] whose wedge holds p
+    size_t lo = 1, hi = h - 1;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (RobustOrientation::orient(o, hull[mid], p) >= 0) lo = mid;
+        else hi = mid;
+    }
+    return RobustOrientation::orient(hull[lo], hull[lo + 1], p) >= 0;
+}
+
+/**
+ * @brief Squared distance between two points.
+ */
+static double distance2(const Point& a, const Point& b) {
+    double dx = b.x - a.x, dy = b.y - a.y;
+    return dx * dx + dy * dy;
+}
+
+double hull_diameter(const std::vector<Point>& hull) {
+    size_t h = hull.size();
+    if (h < 2) return 0;
+    if (h == 2) return std::sqrt(distance2(hull[0], hull[1]));
+    double best = 0;
+    size_t j = 1;
+    for (size_t i = 0; i < h; ++i) {
+        const Point& a = hull[i];
+        const Point& b = hull[(i + 1) % h];
+        // Advance to the vertex farthest from edge a-b
+        while (cross(a, b, hull[(j + 1) % h]) > cross(a, b, hull[j])) j = (j + 1) % h;
+        best = std::max(best, std::max(distance2(a, hull[j]), distance2(b, hull[j])));
+    }
+    return std::sqrt(best);
+}
+
+BoundingRect min_bounding_rect(const std::vector<Point>& hull) {
+    BoundingRect best;
+    size_t h = hull.size();
+    if (h == 0) return best;
+    for (Point& corner : best.corners) corner = hull[0];
+    if (h == 1) return best;
+
+    bool found = false;
+    size_t right = 0, top = 0, left = 0; // Extreme vertices along, across and against the edge
+    for (size_t i = 0; i < h; ++i) {
+        const Point& a = hull[i];
+        const Point& b = hull[(i + 1) % h];
+        double length = std::sqrt(distance2(a, b));
+        if (length == 0) continue;
+        double ux = (b.x - a.x) / length, uy = (b.y - a.y) / length; // Along the edge
+        auto along = [&](size_t k) { return (hull[k].x - a.x) * ux + (hull[k].y - a.y) * uy; };
+        auto across = [&](size_t k) { return (hull[k].y - a.y) * ux - (hull[k].x - a.x) * uy; };
+
+        if (!found) right = i;
+        while (along((right + 1) % h) > along(right)) right = (right + 1) % h;
+        if (!found) top = right;
+        while (across((top + 1) % h) > across(top)) top = (top + 1) % h;
+        if (!found) left = top;
+        while (along((left + 1) % h) < along(left)) left = (left + 1) % h;
+
+        double min_along = along(left), max_along = along(right), height = across(top);
+        double area = (max_along - min_along) * height;
+        if (found && area >= best.area) continue;
+        found = true;
+        best.area = area;
+        // The normal (-uy, ux) points into the hull, so the corners come out counter-clockwise
+        best.corners[0] = Point{a.x + ux * min_along, a.y + uy * min_along};
+        best.corners[1] = Point{a.x + ux * max_along, a.y + uy * max_along};
+        best.corners[2] = Point{best.corners[1].x - uy * height, best.corners[1].y + ux * height};
+        best.corners[3] = Point{best.corners[0].x - uy * height, best.corners[0].y + ux * height};
+    }
+    return best;
+}
+
+const std::vector<Point>& compute_convex_hull_deque(const PointCloud& points, HullWorkspace& workspace) {
+    chain_into(points, workspace);
+    return workspace.hull;
+}
+
+/**
+ * @brief Error-free sum: x + y == a + b exactly, with x the rounded sum.
+ */
+static void two_sum(double a, double b, double& x, double& y) {
+    x = a + b;
+    double bv = x - a;
+    double av = x - bv;
+    y = (a - av) + (b - bv);
+}
+
+/**
+ * @brief Error-free difference: x + y == a - b exactly, with x the rounded difference.
+ */
+static void two_diff(double a, double b, double& x, double& y) {
+    x = a - b;
+    double bv = a - x;
+    double av = x + bv;
+    y = (a - av) + (bv - b);
+}
+
+/**
+ * @brief Error-free product: x + y == a * b exactly, with x the rounded product.
+ */
+static void two_product(double a, double b, double& x, double& y) {
+    x = a * b;
+    y = std::fma(a, b, -x);
+}
+
+/**
+ * @brief Adds a double to a nonoverlapping expansion, dropping zero components (Shewchuk's Grow-Expansion).
+ *
+ * @param e Components in increasing magnitude; receives the sum in the same form.
+ * @param n Number of components, updated.
+ * @param b The double to add.
+ */
+static void grow_expansion(double* e, size_t& n, double b) {
+    size_t m = 0;
+    double q = b;
+    for (size_t i = 0; i < n; ++i) {
+        double sum, error;
+        two_sum(q, e[i], sum, error);
+        if (error != 0) e[m++] = error;
+        q = sum;
+    }
+    if (q != 0) e[m++] = q;
+    n = m;
+}
+
+double orient_exact(const Point& o, const Point& a, const Point& b) {
+    // Split each coordinate difference into an exact two-term sum, then add up every partial product
+    double ax[2], ay[2], bx[2], by[2];
+    two_diff(a.x, o.x, ax[1], ax[0]);
+    two_diff(a.y, o.y, ay[1], ay[0]);
+    two_diff(b.x, o.x, bx[1], bx[0]);
+    two_diff(b.y, o.y, by[1], by[0]);
+    double e[32]; // 16 products of two components each
+    size_t n = 0;
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            double x, y;
+            two_product(ax[i], by[j], x, y);
+            grow_expansion(e, n, x);
+            grow_expansion(e, n, y);
+            two_product(ay[i], bx[j], x, y);
+            grow_expansion(e, n, -x);
+            grow_expansion(e, n, -y);
+        }
+    }
+    return n > 0 ? e[n - 1] : 0; // The largest component carries the sign of the whole sum
+}
+
+/**
+ * @struct DynamicHullNode
+ * @brief Node of the DynamicHull tree.
+ *
+ * Leaves hold the points. An internal node holds, for each chain (0 = lower,
+ * 1 = upper), the bridge between the hull of its left subtree and the hull of
+ * its right subtree: bridge[c][0] lies on the left hull, bridge[c][1] on the right one.
+ */
+struct DynamicHullNode {
+    DynamicHullNode* left = nullptr;
+    DynamicHullNode* right = nullptr;
+    Point key{0, 0};       // Leaf: the stored point. Internal: largest point of the left subtree.
+    size_t weight = 1;     // Number of leaves below this node
+    size_t copies = 1;     // Leaf only: how many times the point was inserted
+    Point bridge[2][2];    // Internal only: lower and upper bridges
+
+    bool leaf() const { return left == nullptr; }
+};
+
+/**
+ * @brief Checks whether two points have identical coordinates.
+ */
+static bool same_point(const Point& a, const Point& b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+/**
+ * @brief Returns the orientation sign of a chain: -1 for the lower chain, 1 for the upper chain.
+ *
+ * Along a chain walked left to right, s * Orientation::orient(a, b, c) < 0 for every three consecutive vertices.
+ */
+static int chain_side(int chain) {
+    return chain ? 1 : -1;
+}
+
+/**
+ * @brief Locates a window of a subtree's chain relative to the node's bridge.
+ *
+ * A window is the part of a chain between two of its vertices lo and hi
+ * (nullptr means unbounded). Both bounds are vertices of the chain, so each
+ * lies either left of the bridge (<= a) or right of it (>= b).
+ *
+ * @return 0 if the window is inside the left subtree, 1 if inside the right
+ *         subtree, 2 if it contains the bridge edge (a, b).
+ */
+static int window_side(const Point& a, const Point& b, const Point* lo, const Point* hi) {
+    if (hi && !(a < *hi)) return 0;
+    if (lo && !(*lo < b)) return 1;
+    return 2;
+}
+
+/**
+ * @brief Finds the tangent vertex on a subtree's chain as seen from a point to its right.
+ *
+ * @param u Root of the subtree.
+ * @param chain 0 for the lower chain, 1 for the upper chain.
+ * @param q A point lexicographically greater than every point of the subtree.
+ * @return The leftmost chain vertex t such that the whole chain lies on one side of line t-q.
+ */
+template <class Orientation>
+static Point tangent(const DynamicHullNode* u, int chain, const Point& q) {
+    int s = chain_side(chain);
+    const Point* lo = nullptr;
+    const Point* hi = nullptr;
+    while (!u->leaf()) {
+        const Point& a = u->bridge[chain][0];
+        const Point& b = u->bridge[chain][1];
+        int w = window_side(a, b, lo, hi);
+        if (w == 0) u = u->left;
+        else if (w == 1) u = u->right;
+        else if (s * Orientation::orient(a, b, q) < 0) { lo = &b; u = u->right; }
+        else { hi = &a; u = u->left; }
+    }
+    return u->key;
+}
+
+/**
+ * @brief Computes the bridge between the chains of two subtrees.
+ *
+ * Binary searches the right chain; each probe finds its tangent on the left chain.
+ * Collinear vertices on the bridge are excluded, matching the Monotone Chain output.
+ *
+ * @param L Left subtree.
+ * @param R Right subtree; all its points are greater than those of L.
+ * @param chain 0 for the lower chain, 1 for the upper chain.
+ * @param a Receives the bridge endpoint on the left chain.
+ * @param b Receives the bridge endpoint on the right chain.
+ */
+template <class Orientation>
+static void find_bridge(const DynamicHullNode* L, const DynamicHullNode* R, int chain, Point& a, Point& b) {
+    int s = chain_side(chain);
+    const Point* lo = nullptr;
+    const Point* hi = nullptr;
+    const DynamicHullNode* u = R;
+    while (!u->leaf()) {
+        const Point& ra = u->bridge[chain][0];
+        const Point& rb = u->bridge[chain][1];
+        int w = window_side(ra, rb, lo, hi);
+        if (w == 0) u = u->left;
+        else if (w == 1) u = u->right;
+        else if (s * Orientation::orient(tangent<Orientation>(L, chain, ra), ra, rb) >= 0) { lo = &rb; u = u->right; }
+        else { hi = &ra; u = u->left; }
+    }
+    b = u->key;
+    a = tangent<Orientation>(L, chain, b);
+}
+
+/**
+ * @brief Recomputes the weight and both bridges of an internal node from its children.
+ */
+template <class Orientation>
+static void pull(DynamicHullNode* u) {
+    u->weight = u->left->weight + u->right->weight;
+    for (int chain = 0; chain < 2; ++chain) {
+        Point a, b;
+        find_bridge<Orientation>(u->left, u->right, chain, a, b);
+        u->bridge[chain][0] = a;
+        u->bridge[chain][1] = b;
+    }
+}
+
+/**
+ * @brief Checks whether a point lies strictly on the inner side of one chain of a subtree.
+ *
+ * @param u Root of the subtree.
+ * @param chain 0 for the lower chain, 1 for the upper chain.
+ * @param p The point to test.
+ * @return true if p is strictly above the lower chain or strictly below the upper chain.
+ */
+template <class Orientation>
+static bool inside_chain(const DynamicHullNode* u, int chain, const Point& p) {
+    int s = chain_side(chain);
+    const Point* lo = nullptr;
+    const Point* hi = nullptr;
+    while (!u->leaf()) {
+        const Point& a = u->bridge[chain][0];
+        const Point& b = u->bridge[chain][1];
+        int w = window_side(a, b, lo, hi);
+        if (w == 0) { u = u->left; continue; }
+        if (w == 1) { u = u->right; continue; }
+        if (!(a < p)) {
+            if (same_point(a, p)) return false;
+            hi = &a;
+            u = u->left;
+        } else if (!(p < b)) {
+            if (same_point(b, p)) return false;
+            lo = &b;
+            u = u->right;
+        } else {
+            return s * Orientation::orient(a, b, p) < 0;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Checks whether a point lies strictly inside the convex hull of a subtree.
+ */
+template <class Orientation>
+static bool strictly_inside(const DynamicHullNode* u, const Point& p) {
+    return inside_chain<Orientation>(u, 0, p) && inside_chain<Orientation>(u, 1, p);
+}
+
+/**
+ * @brief Appends the vertices of a window of a subtree's chain, left to right.
+ *
+ * @param u Root of the subtree.
+ * @param chain 0 for the lower chain, 1 for the upper chain.
+ * @param lo First vertex of the window, or nullptr for the start of the chain.
+ * @param hi Last vertex of the window, or nullptr for the end of the chain.
+ * @param out Receives the vertices.
+ */
+template <typename Output>
+static void collect_chain(const DynamicHullNode* u, int chain, const Point* lo, const Point* hi, Output& out) {
+    if (u->leaf()) {
+        out.push_back(u->key);
+        return;
+    }
+    const Point& a = u->bridge[chain][0];
+    const Point& b = u->bridge[chain][1];
+    int w = window_side(a, b, lo, hi);
+    if (w == 0) {
+        collect_chain(u->left, chain, lo, hi, out);
+    } else if (w == 1) {
+        collect_chain(u->right, chain, lo, hi, out);
+    } else {
+        collect_chain(u->left, chain, lo, &a, out);
+        collect_chain(u->right, chain, &b, hi, out);
+    }
+}
+
+/**
+ * @brief Deletes a subtree.
+ */
+static void destroy(DynamicHullNode* u) {
+    if (!u) return;
+    destroy(u->left);
+    destroy(u->right);
+    delete u;
+}
+
+/**
+ * @brief Collects the leaves of a subtree in order and deletes its internal nodes.
+ */
+static void collect_leaves(DynamicHullNode* u, std::vector<DynamicHullNode*>& leaves) {
+    if (u->leaf()) {
+        leaves.push_back(u);
+        return;
+    }
+    collect_leaves(u->left, leaves);
+    collect_leaves(u->right, leaves);
+    delete u;
+}
+
+/**
+ * @brief Builds a perfectly balanced tree over leaves[lo, hi) and computes its bridges.
+ */
+template <class Orientation>
+static DynamicHullNode* build_balanced(const std::vector<DynamicHullNode*>& leaves, size_t lo, size_t hi) {
+    if (hi - lo == 1) return leaves[lo];
+    size_t mid = lo + (hi - lo) / 2;
+    DynamicHullNode* u = new DynamicHullNode;
+    u->left = build_balanced<Orientation>(leaves, lo, mid);
+    u->right = build_balanced<Orientation>(leaves, mid, hi);
+    u->key = leaves[mid - 1]->key;
+    pull<Orientation>(u);
+    return u;
+}
+
+/**
+ * @brief Checks the weight-balance condition: no child holds more than 3/4 of the leaves.
+ */
+static bool balanced(const DynamicHullNode* u) {
+    return 4 * std::max(u->left->weight, u->right->weight) <= 3 * u->weight;
+}
+
+/**
+ * @brief Replaces a child pointer of a node (or the root) with another subtree.
+ */
+static void replace_child(DynamicHullNode*& root, DynamicHullNode* parent,
+                          DynamicHullNode* from, DynamicHullNode* to) {
+    if (!parent) root = to;
+    else if (parent->left == from) parent->left = to;
+    else parent->right = to;
+}
+
+/**
+ * @brief Rebuilds the highest unbalanced subtree on an update path, if any.
+ *
+ * Rebuilding does not change the set of points below the subtree, so the
+ * bridges of its ancestors stay valid.
+ *
+ * @param root The tree root, updated if the root itself is rebuilt.
+ * @param path Internal nodes from the root down to the updated leaf.
+ */
+template <class Orientation>
+static void rebalance(DynamicHullNode*& root, const std::vector<DynamicHullNode*>& path) {
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (balanced(path[i])) continue;
+        std::vector<DynamicHullNode*> leaves;
+        collect_leaves(path[i], leaves);
+        replace_child(root, i ? path[i - 1] : nullptr, path[i], build_balanced<Orientation>(leaves, 0, leaves.size()));
+        return;
+    }
+}
+
+/**
+ * @brief Creates an empty dynamic hull.
+ */
+template <class Orientation>
+BasicDynamicHull<Orientation>::BasicDynamicHull() : root(nullptr), count(0), area_valid(true), cached_area(0) {}
+
+/**
+ * @brief Frees every node of the tree.
+ */
+template <class Orientation>
+BasicDynamicHull<Orientation>::~BasicDynamicHull() {
+    destroy(root);
+}
+
+/**
+ * @brief Adds a point, then recomputes bridges bottom-up until the point is buried.
+ *
+ * @param p The point to add.
+ */
+template <class Orientation>
+void BasicDynamicHull<Orientation>::insert(const Point& p) {
+    ++count;
+    if (!root) {
+        root = new DynamicHullNode;
+        root->key = p;
+        area_valid = false;
+        return;
+    }
+
+    std::vector<DynamicHullNode*> path;
+    DynamicHullNode* u = root;
+    while (!u->leaf()) {
+        path.push_back(u);
+        u = (u->key < p) ? u->right : u->left;
+    }
+    if (same_point(u->key, p)) {
+        ++u->copies;
+        return;
+    }
+
+    DynamicHullNode* leaf = new DynamicHullNode;
+    leaf->key = p;
+    DynamicHullNode* split = new DynamicHullNode;
+    if (p < u->key) { split->left = leaf; split->right = u; }
+    else { split->left = u; split->right = leaf; }
+    split->key = split->left->key;
+    replace_child(root, path.empty() ? nullptr : path.back(), u, split);
+    path.push_back(split);
+
+    // Once p is strictly inside a subtree hull, no hull above it can change
+    bool settled = false;
+    for (size_t i = path.size(); i-- > 0;) {
+        DynamicHullNode* v = path[i];
+        if (settled) {
+            v->weight = v->left->weight + v->right->weight;
+        } else {
+            pull<Orientation>(v);
+            settled = strictly_inside<Orientation>(v, p);
+        }
+    }
+    if (!settled) area_valid = false;
+    rebalance<Orientation>(root, path);
+}
+
+/**
+ * @brief Removes every copy of a point, recomputing only the bridges that can change.
+ *
+ * @param p The point to remove.
+ * @return The number of copies removed.
+ */
+template <class Orientation>
+size_t BasicDynamicHull<Orientation>::erase(const Point& p) {
+    if (!root) return 0;
+
+    std::vector<DynamicHullNode*> path;
+    DynamicHullNode* u = root;
+    while (!u->leaf()) {
+        path.push_back(u);
+        u = (u->key < p) ? u->right : u->left;
+    }
+    if (!same_point(u->key, p)) return 0;
+
+    size_t removed = u->copies;
+    count -= removed;
+    if (path.empty()) {
+        delete u;
+        root = nullptr;
+        area_valid = false;
+        return removed;
+    }
+
+    // Subtrees whose hull strictly contains p keep their hull (and bridges) after removal
+    size_t first_pull = 0;
+    for (size_t i = path.size(); i-- > 0;) {
+        if (strictly_inside<Orientation>(path[i], p)) {
+            first_pull = i + 1;
+            break;
+        }
+    }
+
+    DynamicHullNode* parent = path.back();
+    path.pop_back();
+    DynamicHullNode* sibling = (parent->left == u) ? parent->right : parent->left;
+    replace_child(root, path.empty() ? nullptr : path.back(), parent, sibling);
+    delete parent;
+    delete u;
+
+    for (size_t i = path.size(); i-- > 0;) {
+        DynamicHullNode* v = path[i];
+        if (i >= first_pull) pull<Orientation>(v);
+        else v->weight = v->left->weight + v->right->weight;
+    }
+    if (first_pull == 0) area_valid = false;
+    rebalance<Orientation>(root, path);
+    return removed;
+}
+
+/**
+ * @brief Merges a sorted batch into the in-order leaves and rebuilds the tree over the result.
+ */
+template <class Orientation>
+void BasicDynamicHull<Orientation>::insert_batch(const std::vector<Point>& points) {
+    if (points.size() * HULL_BATCH_REBUILD < count) {
+        for (const Point& p : points) insert(p);
+        return;
+    }
+    std::vector<Point> sorted(points);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<DynamicHullNode*> old_leaves;
+    if (root) collect_leaves(root, old_leaves);
+
+    std::vector<DynamicHullNode*> leaves;
+    leaves.reserve(old_leaves.size() + sorted.size());
+    size_t next = 0;
+    for (const Point& p : sorted) {
+        while (next < old_leaves.size() && old_leaves[next]->key < p) leaves.push_back(old_leaves[next++]);
+        if (next < old_leaves.size() && same_point(old_leaves[next]->key, p)) leaves.push_back(old_leaves[next++]);
+        if (!leaves.empty() && same_point(leaves.back()->key, p)) {
+            ++leaves.back()->copies;
+            continue;
+        }
+        DynamicHullNode* leaf = new DynamicHullNode;
+        leaf->key = p;
+        leaves.push_back(leaf);
+    }
+    while (next < old_leaves.size()) leaves.push_back(old_leaves[next++]);
+    root = leaves.empty() ? nullptr : build_balanced<Orientation>(leaves, 0, leaves.size());
+    count += points.size();
+    area_valid = false;
+}
+
+/**
+ * @brief Drops the leaves found in a sorted batch and rebuilds the tree over the others.
+ */
+template <class Orientation>
+size_t BasicDynamicHull<Orientation>::erase_batch(const std::vector<Point>& points) {
+    size_t removed = 0;
+    if (points.size() * HULL_BATCH_REBUILD < count) {
+        for (const Point& p : points) removed += erase(p);
+        return removed;
+    }
+    if (!root) return 0;
+    std::vector<Point> sorted(points);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<DynamicHullNode*> old_leaves;
+    collect_leaves(root, old_leaves);
+
+    std::vector<DynamicHullNode*> leaves;
+    leaves.reserve(old_leaves.size());
+    size_t next = 0;
+    for (DynamicHullNode* leaf : old_leaves) {
+        while (next < sorted.size() && sorted[next] < leaf->key) ++next;
+        if (next < sorted.size() && same_point(sorted[next], leaf->key)) {
+            removed += leaf->copies;
+            delete leaf;
+        } else {
+            leaves.push_back(leaf);
+        }
+    }
+    root = leaves.empty() ? nullptr : build_balanced<Orientation>(leaves, 0, leaves.size());
+    count -= removed;
+    if (removed > 0) area_valid = false;
+    return removed;
+}
+
+/**
+ * @brief Replaces the whole set: sorts the points, merges duplicates and builds a balanced tree.
+ *
+ * @param points The new point set.
+ */
+template <class Orientation>
+void BasicDynamicHull<Orientation>::assign(const std::deque<Point>& points) {
+    build(sorted_points(points));
+}
+
+template <class Orientation>
+void BasicDynamicHull<Orientation>::assign(const PointCloud& points) {
+    build(sorted_points(points));
+}
+
+template <class Orientation>
+void BasicDynamicHull<Orientation>::build(const std::vector<Point>& sorted) {
+    clear();
+    if (sorted.empty()) return;
+
+    std::vector<DynamicHullNode*> leaves;
+    for (const Point& p : sorted) {
+        if (!leaves.empty() && same_point(leaves.back()->key, p)) {
+            ++leaves.back()->copies;
+            continue;
+        }
+        DynamicHullNode* leaf = new DynamicHullNode;
+        leaf->key = p;
+        leaves.push_back(leaf);
+    }
+    root = build_balanced<Orientation>(leaves, 0, leaves.size());
+    count = sorted.size();
+    area_valid = false;
+}
+
+/**
+ * @brief Removes all points.
+ */
+template <class Orientation>
+void BasicDynamicHull<Orientation>::clear() {
+    destroy(root);
+    root = nullptr;
+    count = 0;
+    area_valid = true;
+    cached_area = 0;
+}
+
+template <class Orientation>
+void BasicDynamicHull<Orientation>::swap(BasicDynamicHull& other) {
+    std::swap(root, other.root);
+    std::swap(count, other.count);
+    std::swap(area_valid, other.area_valid);
+    std::swap(cached_area, other.cached_area);
+}
+
+/**
+ * @brief Returns the number of points in the set, counting duplicates.
+ */
+template <class Orientation>
+size_t BasicDynamicHull<Orientation>::size() const {
+    return count;
+}
+
+/**
+ * @brief Returns the hull vertices in counter-clockwise order.
+ *
+ * The lower chain is walked left to right, then the upper chain right to left
+ * without repeating the two shared endpoints.
+ *
+ * @return A deque of points forming the convex hull.
+ */
+template <class Orientation>
+std::deque<Point> BasicDynamicHull<Orientation>::vertices() const {
+    std::deque<Point> hull;
+    if (!root) return hull;
+    collect_chain(root, 0, nullptr, nullptr, hull);
+    if (root->leaf()) return hull;
+
+    std::deque<Point> upper;
+    collect_chain(root, 1, nullptr, nullptr, upper);
+    if (upper.size() > 2) hull.insert(hull.end(), upper.rbegin() + 1, upper.rend() - 1);
+    return hull;
+}
+
+/**
+ * @brief Returns the area of the convex hull, recomputing it only after the hull changed.
+ */
+template <class Orientation>
+double BasicDynamicHull<Orientation>::area() const {
+    if (!area_valid) {
+        cached_area = compute_area(vertices());
+        area_valid = true;
+    }
+    return cached_area;
+}
+
+template <class Orientation>
+const std::vector<Point>& BasicDynamicHull<Orientation>::vertices(HullWorkspace& workspace) const {
+    std::vector<Point>& hull = workspace.hull;
+    std::vector<Point>& upper = workspace.chain;
+    hull.clear();
+    if (!root) return hull;
+    collect_chain(root, 0, nullptr, nullptr, hull);
+    if (root->leaf()) return hull;
+
+    upper.clear();
+    collect_chain(root, 1, nullptr, nullptr, upper);
+    if (upper.size() > 2) hull.insert(hull.end(), upper.rbegin() + 1, upper.rend() - 1);
+    return hull;
+}
+
+template <class Orientation>
+double BasicDynamicHull<Orientation>::area(HullWorkspace& workspace) const {
+    if (!area_valid) {
+        cached_area = shoelace_area(vertices(workspace));
+        area_valid = true;
+    }
+    return cached_area;
+}
+
+// Both orientation policies are compiled here, so the header only declares the template
+template class BasicDynamicHull<FastOrientation>;
+template class BasicDynamicHull<RobustOrientation>;
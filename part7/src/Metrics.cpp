@@ -0,0 +1,120 @@
+#include "../include/Metrics.hpp"
+#include <cstdio>
+
+thread_local ThreadMetrics* thread_metrics_slot = nullptr;
+
+static std::atomic<ThreadMetrics*> all_metrics{nullptr}; // Every slot ever allocated, newest first
+static std::atomic<int64_t> gauges[static_cast<size_t>(Gauge::Count)];
+static const uint64_t started_at = metrics_clock();
+
+/**
+ * @struct SlotRelease
+ * @brief Hands a thread's slot back when the thread exits.
+ */
+struct SlotRelease {
+    ~SlotRelease() {
+        if (thread_metrics_slot) thread_metrics_slot->in_use.store(false, std::memory_order_release);
+        thread_metrics_slot = nullptr;
+    }
+};
+
+ThreadMetrics* claim_thread_metrics() {
+    static thread_local SlotRelease release;
+    (void)release;
+    for (ThreadMetrics* slot = all_metrics.load(std::memory_order_acquire); slot; slot = slot->next) {
+        bool free = false;
+        if (!slot->in_use.load(std::memory_order_relaxed) &&
+            slot->in_use.compare_exchange_strong(free, true, std::memory_order_acquire))
+            return thread_metrics_slot = slot;
+    }
+
+    ThreadMetrics* slot = new ThreadMetrics(); // Zeroed; never freed, as Stats may be reading it
+    slot->in_use.store(true, std::memory_order_relaxed);
+    slot->next = all_metrics.load(std::memory_order_relaxed);
+    while (!all_metrics.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    return thread_metrics_slot = slot;
+}
+
+void metrics_gauge_add(Gauge gauge, int64_t delta) {
+#if METRICS
+    gauges[static_cast<size_t>(gauge)].fetch_add(delta, std::memory_order_relaxed);
+#else
+    (void)gauge;
+    (void)delta;
+#endif
+}
+
+/**
+ * @struct HistogramTotals
+ * @brief A LatencyHistogram summed over every thread.
+ */
+struct HistogramTotals {
+    uint64_t buckets[LATENCY_BUCKETS] = {0};
+    uint64_t total_ns = 0;
+
+    void add(const LatencyHistogram& histogram) {
+        for (unsigned i = 0; i < LATENCY_BUCKETS; ++i) buckets[i] += histogram.buckets[i].load(std::memory_order_relaxed);
+        total_ns += histogram.total_ns.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Appends " name=count/mean/p50/p99/max" for a histogram that recorded anything.
+ */
+static void append_histogram(std::string& out, const char* name, const HistogramTotals& totals) {
+    uint64_t count = 0;
+    for (uint64_t n : totals.buckets) count += n;
+    if (count == 0) return;
+
+    // Upper bound of the bucket holding the q-th fraction of the durations
+    auto quantile_us = [&](double q) {
+        uint64_t rank = static_cast<uint64_t>(q * (count - 1)) + 1, seen = 0;
+        unsigned bucket = 0;
+        for (; bucket + 1 < LATENCY_BUCKETS; ++bucket) {
+            seen += totals.buckets[bucket];
+            if (seen >= rank) break;
+        }
+        return static_cast<double>(uint64_t(2) << bucket) / 1000.0;
+    };
+    char field[160];
+    std::snprintf(field, sizeof(field), " %s=%llu/%.3g/%.3g/%.3g/%.3g", name, static_cast<unsigned long long>(count),
+                  static_cast<double>(totals.total_ns) / count / 1000.0, quantile_us(0.5), quantile_us(0.99),
+                  quantile_us(1.0));
+    out += field;
+}
+
+std::string metrics_report() {
+    uint64_t counters[static_cast<size_t>(Counter::Count)] = {0};
+    HistogramTotals latencies[static_cast<size_t>(Latency::Count)], commands[METRIC_COMMANDS];
+    for (ThreadMetrics* slot = all_metrics.load(std::memory_order_acquire); slot; slot = slot->next) {
+        for (size_t i = 0; i < static_cast<size_t>(Counter::Count); ++i)
+            counters[i] += slot->counters[i].load(std::memory_order_relaxed);
+        for (size_t i = 0; i < static_cast<size_t>(Latency::Count); ++i) latencies[i].add(slot->latencies[i]);
+        for (size_t i = 0; i < METRIC_COMMANDS; ++i) commands[i].add(slot->commands[i]);
+    }
+
+    char field[64];
+    std::snprintf(field, sizeof(field), "uptime_s=%.3f", static_cast<double>(metrics_clock() - started_at) / 1e9);
+    std::string out = field;
+    static const char* const counter_names[] = {"loop_iterations", "loop_ready_fds", "hull_joins"};
+    static_assert(sizeof(counter_names) / sizeof(counter_names[0]) == static_cast<size_t>(Counter::Count),
+                  "One name per Counter");
+    for (size_t i = 0; i < static_cast<size_t>(Counter::Count); ++i)
+        out += std::string(" ") + counter_names[i] + "=" + std::to_string(counters[i]);
+    static const char* const gauge_names[] = {"proactor_threads"};
+    static_assert(sizeof(gauge_names) / sizeof(gauge_names[0]) == static_cast<size_t>(Gauge::Count),
+                  "One name per Gauge");
+    for (size_t i = 0; i < static_cast<size_t>(Gauge::Count); ++i)
+        out += std::string(" ") + gauge_names[i] + "=" + std::to_string(gauges[i].load(std::memory_order_relaxed));
+
+    static const char* const latency_names[] = {"lock_wait", "lock_hold", "hull_build", "hull_read"};
+    static_assert(sizeof(latency_names) / sizeof(latency_names[0]) == static_cast<size_t>(Latency::Count),
+                  "One name per Latency");
+    for (size_t i = 0; i < static_cast<size_t>(Latency::Count); ++i) append_histogram(out, latency_names[i], latencies[i]);
+    for (size_t i = 0; i < METRIC_COMMANDS; ++i) {
+        std::string name = std::string("cmd_") + command_name(static_cast<CommandType>(i));
+        append_histogram(out, name.c_str(), commands[i]);
+    }
+    return out;
+}
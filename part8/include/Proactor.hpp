@@ -2,6 +2,7 @@
 #define PROACTOR_HPP
 
 #include <pthread.h>
+#include <cstddef>
 
 /**
  * @typedef proactorFunc
@@ -36,4 +37,106 @@ pthread_t startProactor(int sockfd, proactorFunc threadFunc);
  */
 int stopProactor(pthread_t tid);
 
+/**
+ * @typedef proactorReadyFunc
+ * @brief Callback run by a pool worker when a socket has data or was closed by the peer.
+ *
+ * The callback should read what is available without blocking for more.
+ * @param sockfd The ready socket.
+ * @return true to keep the socket, false to have the pool close it.
+ */
+typedef bool (*proactorReadyFunc)(int sockfd);
+
+/**
+ * @brief Starts a proactor pool with a fixed number of worker threads.
+ *
+ * Workers take ready sockets from a shared kernel event queue (epoll on Linux,
+ * kqueue on BSD/macOS), so adding a connection never creates a thread and each
+ * socket is handled by one worker at a time.
+ *
+ * @param workers Number of worker threads; 0 or less uses one per hardware thread.
+ * @param func The callback invoked for every ready socket.
+ * @return A pointer to the pool (opaque to user), or nullptr on failure.
+ */
+void* startProactorPool(int workers, proactorReadyFunc func);
+
+/**
+ * @brief Hands a connected socket to the pool.
+ *
+ * @param pool The pool returned by `startProactorPool`.
+ * @param sockfd The socket to watch; the pool closes it when the callback returns false.
+ * @return 0 on success, -1 on failure.
+ */
+int addSocketToProactorPool(void* pool, int sockfd);
+
+/**
+ * @brief Stops the workers, closes every remaining socket and frees the pool.
+ *
+ * @param pool The pool to stop.
+ * @return 0 on success, -1 on failure.
+ */
+int stopProactorPool(void* pool);
+
+/**
+ * @typedef proactorAcceptFunc
+ * @brief Callback run by the io_uring proactor for every accepted connection.
+ *
+ * @param sockfd The new client socket.
+ * @return true to serve the client, false to close it straight away.
+ */
+typedef bool (*proactorAcceptFunc)(int sockfd);
+
+/**
+ * @typedef proactorRecvFunc
+ * @brief Completion callback run by the io_uring proactor when data arrived.
+ *
+ * The buffer belongs to the proactor and is reused once the callback returns.
+ * A final call with len 0 (and data nullptr) reports that the connection ended,
+ * whether the client disconnected or the callback asked to close it.
+ *
+ * @param proactor The proactor, for `proactorSend`.
+ * @param sockfd The client socket.
+ * @param data The received bytes.
+ * @param len Number of received bytes.
+ * @return true to keep the connection, false to close it once queued output is sent.
+ */
+typedef bool (*proactorRecvFunc)(void* proactor, int sockfd, const char* data, size_t len);
+
+/**
+ * @brief Starts a completion-based proactor on Linux io_uring.
+ *
+ * One thread owns the ring: the listener is served by a multishot accept, clients
+ * by multishot receives into kernel-selected provided buffers, and both callbacks
+ * run on that thread.
+ *
+ * @param listener A listening socket; the proactor accepts on it.
+ * @param onAccept Called for every accepted client.
+ * @param onRecv Called for every receive completion.
+ * @return A pointer to the proactor (opaque to user), or nullptr if io_uring is unavailable.
+ */
+void* startUringProactor(int listener, proactorAcceptFunc onAccept, proactorRecvFunc onRecv);
+
+/**
+ * @brief Queues data to send to a client of the io_uring proactor.
+ *
+ * Must be called from the proactor's callbacks. Output is copied and sent in order.
+ *
+ * @param proactor The proactor passed to the callback.
+ * @param sockfd The client socket.
+ * @param data The bytes to send.
+ * @param len Number of bytes.
+ * @return 0 on success, -1 if the socket is not a client of this proactor.
+ */
+int proactorSend(void* proactor, int sockfd, const char* data, size_t len);
+
+/**
+ * @brief Stops the io_uring proactor thread and closes its ring and client sockets.
+ *
+ * The listener is left open for the caller.
+ *
+ * @param proactor The proactor to stop.
+ * @return 0 on success, -1 on failure.
+ */
+int stopUringProactor(void* proactor);
+
 #endif // PROACTOR_HPP
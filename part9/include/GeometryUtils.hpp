@@ -1,5 +1,14 @@
 #pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
+#include <limits>
+#include <vector>
+
+#ifndef COMPACT_POINTS
+#define COMPACT_POINTS 0 // 1 stores PointCloud coordinates as float, see PointCoord
+#endif
 
 /**
  * @struct Point
@@ -19,6 +28,58 @@ struct Point {
     bool operator<(const Point& other) const;
 };
 
+#define ORIENT_ERROR_BOUND ((3.0 + 16.0 * 0x1p-53) * 0x1p-53) // Relative error bound of the double orientation test
+
+/**
+ * @brief Exact orientation of three points, in expansion arithmetic.
+ *
+ * Slow; RobustOrientation only calls it when the double result is ambiguous.
+ *
+ * @return A value with the exact sign of (a - o) x (b - o): positive for a
+ *         counter-clockwise turn, negative for a clockwise one, 0 if collinear.
+ */
+double orient_exact(const Point& o, const Point& a, const Point& b);
+
+/**
+ * @struct FastOrientation
+ * @brief Orientation policy in plain double arithmetic.
+ *
+ * The fastest choice, but rounding can give the wrong sign for nearly
+ * collinear points, which then end up on or off the hull by mistake.
+ */
+struct FastOrientation {
+    /**
+     * @brief Cross product of vectors o->a and o->b.
+     */
+    static double orient(const Point& o, const Point& a, const Point& b) {
+        return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+    }
+};
+
+/**
+ * @struct RobustOrientation
+ * @brief Orientation policy with an always-correct sign (Shewchuk's adaptive orient2d).
+ *
+ * The double cross product is trusted whenever it is larger than its error
+ * bound, which costs one multiply and compare more than FastOrientation;
+ * only the nearly collinear cases inside the bound call orient_exact().
+ */
+struct RobustOrientation {
+    /**
+     * @brief A value with the exact sign of the cross product of vectors o->a and o->b.
+     */
+    static double orient(const Point& o, const Point& a, const Point& b) {
+        double left = (a.x - o.x) * (b.y - o.y);
+        double right = (a.y - o.y) * (b.x - o.x);
+        double det = left - right;
+        // Products of opposite signs cannot cancel, and the sign of a rounded difference is exact
+        if ((left > 0 && right <= 0) || (left < 0 && right >= 0) || left == 0) return det;
+        double bound = ORIENT_ERROR_BOUND * (std::fabs(left) + std::fabs(right));
+        if (det > bound || -det > bound) return det;
+        return orient_exact(o, a, b);
+    }
+};
+
 /**
  * @brief Computes the convex hull of a set of 2D points using a deque-based approach.
  * 
@@ -38,3 +99,430 @@ std::deque<Point> compute_convex_hull_deque(std::deque<Point> points);
  * @return The area of the polygon.
  */
 double compute_area(const std::deque<Point>& polygon);
+
+/**
+ * Coordinate type PointCloud stores. Building with COMPACT_POINTS=1 makes it
+ * float, halving the memory of every point set for deployments that hold
+ * hundreds of millions of points. Points are rounded to it once, when parsed,
+ * so the point set, the hull and the queries all see the same decoded values
+ * and the hull predicates stay exact on them.
+ */
+#if COMPACT_POINTS
+typedef float PointCoord;
+#else
+typedef double PointCoord;
+#endif
+
+/**
+ * @brief True if a coordinate is finite and within the range of PointCoord.
+ */
+inline bool coord_fits(double v) {
+    return std::fabs(v) <= static_cast<double>(std::numeric_limits<PointCoord>::max());
+}
+
+/**
+ * @brief Rounds a coordinate that passes coord_fits() to the precision PointCloud stores.
+ */
+inline double stored_coord(double v) {
+    return static_cast<PointCoord>(v);
+}
+
+/**
+ * @class PointCloud
+ * @brief Contiguous point storage with separate x and y arrays.
+ *
+ * Holds the server point sets instead of std::deque<Point>: coordinates live in
+ * two flat arrays, so linear scans prefetch well and hull and area code read
+ * them in place. Index i names the i-th stored point until the next removal;
+ * appending never moves existing indices, only reallocates past capacity().
+ */
+class PointCloud {
+public:
+    /**
+     * @brief Number of stored points.
+     */
+    size_t size() const;
+
+    /**
+     * @brief True if no points are stored.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Number of points that fit before the arrays reallocate.
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Grows the capacity to at least n points.
+     *
+     * @param n The number of points to make room for.
+     */
+    void reserve(size_t n);
+
+    /**
+     * @brief Removes every point, keeping the capacity.
+     */
+    void clear();
+
+    /**
+     * @brief Appends a point, rounded to PointCoord.
+     *
+     * @param p The point to append; its coordinates must pass coord_fits().
+     */
+    void push_back(const Point& p);
+
+    /**
+     * @brief Returns the point at index i.
+     *
+     * @param i Index below size().
+     * @return A copy of the point.
+     */
+    Point operator[](size_t i) const;
+
+    /**
+     * @brief Raw x coordinates, size() entries.
+     */
+    const PointCoord* xs() const;
+
+    /**
+     * @brief Raw y coordinates, size() entries.
+     */
+    const PointCoord* ys() const;
+
+    /**
+     * @brief Removes every copy of a point in expected O(1 + copies) time.
+     *
+     * The last points move into the freed slots, so the order of the others
+     * is not kept.
+     *
+     * @param p The point to remove.
+     * @return The number of points removed.
+     */
+    size_t remove_all(const Point& p);
+
+    /**
+     * @brief Appends a point unless an equal one is already stored.
+     *
+     * @param p The point to append.
+     * @return true if the point was appended.
+     */
+    bool push_unique(const Point& p);
+
+    /**
+     * @brief Number of stored copies of a point, in expected O(1 + copies) time.
+     *
+     * @param p The point to look up.
+     */
+    size_t count(const Point& p);
+
+    /**
+     * @brief Exchanges the contents of two clouds without copying.
+     *
+     * @param other The cloud to swap with.
+     */
+    void swap(PointCloud& other);
+
+private:
+    /**
+     * @brief Builds the point index from scratch, sized for the current points.
+     */
+    void build_index();
+
+    /**
+     * @brief Builds the index if point lookups have not needed it yet.
+     */
+    void ensure_index();
+
+    /**
+     * @brief Adds the point at index i to the index as the first of its copies.
+     */
+    void link(uint32_t i);
+
+    /**
+     * @brief Bucket holding the copies of (px, py), or the free bucket where they would go.
+     */
+    size_t find_bucket(double px, double py) const;
+
+    /**
+     * @brief Empties a bucket, shifting later entries of its probe run back.
+     */
+    void erase_bucket(size_t b);
+
+    /**
+     * @brief Moves the last point into index hole and drops the last index.
+     */
+    void move_last_into(uint32_t hole);
+
+    std::vector<PointCoord> x; // X coordinates
+    std::vector<PointCoord> y; // Y coordinates
+
+    // Point index, built on the first lookup and then kept in step with every
+    // change. Each bucket of the open-addressing table holds the index of one
+    // copy of a distinct point (hashed by its coordinate bits, linear probing);
+    // the other copies follow through next_copy. Bulk loads therefore pay
+    // nothing until a Removepoint needs it.
+    std::vector<uint32_t> buckets;   // First copy per distinct point, NO_POINT if free; empty while unbuilt
+    std::vector<uint32_t> next_copy; // Next copy of the same point, NO_POINT after the last
+    size_t distinct = 0;             // Occupied buckets
+};
+
+/**
+ * @brief Computes the convex hull of the points of a PointCloud.
+ *
+ * Same result as the deque overload, read directly from the SoA arrays.
+ *
+ * @param points The input points.
+ * @return A deque of points forming the convex hull in counter-clockwise order.
+ */
+std::deque<Point> compute_convex_hull_deque(const PointCloud& points);
+
+/**
+ * @brief Computes the area of a polygon stored in a PointCloud.
+ *
+ * @param polygon The polygon's vertices in order.
+ * @return The absolute area of the polygon.
+ */
+double compute_area(const PointCloud& polygon);
+
+/**
+ * @brief Computes the area of a polygon stored in a vector, e.g. a HullWorkspace hull.
+ *
+ * @param polygon The polygon's vertices in order.
+ * @return The absolute area of the polygon.
+ */
+double compute_area(const std::vector<Point>& polygon);
+
+/**
+ * @brief Computes the perimeter of a polygon stored in a vector.
+ *
+ * @param polygon The polygon's vertices in order; a lone segment counts both ways.
+ * @return The length of the closed boundary, 0 for fewer than two vertices.
+ */
+double compute_perimeter(const std::vector<Point>& polygon);
+
+/**
+ * @brief Tests whether a point lies in a convex hull, boundary included, in O(log h).
+ *
+ * Binary-searches the fan of triangles around the first vertex.
+ *
+ * @param hull Hull vertices in counter-clockwise order without collinear
+ *             vertices, as returned by DynamicHull::vertices().
+ * @param p The point to test.
+ * @return true if p is inside or on the hull; always false for an empty hull.
+ */
+bool hull_contains(const std::vector<Point>& hull, const Point& p);
+
+/**
+ * @brief Computes the largest distance between two points of a convex hull in O(h).
+ *
+ * Walks the antipodal vertex pairs with rotating calipers.
+ *
+ * @param hull Hull vertices in counter-clockwise order.
+ * @return The diameter, 0 for fewer than two vertices.
+ */
+double hull_diameter(const std::vector<Point>& hull);
+
+/**
+ * @struct BoundingRect
+ * @brief A rectangle given by its corners, as returned by min_bounding_rect().
+ */
+struct BoundingRect {
+    Point corners[4]; // Counter-clockwise; all equal for a single point
+    double area = 0;
+};
+
+/**
+ * @brief Finds the minimum-area rectangle enclosing a convex hull in O(h).
+ *
+ * One side of that rectangle lies on a hull edge, so rotating calipers try
+ * every edge while the extreme vertices along and across it only move forward.
+ *
+ * @param hull Hull vertices in counter-clockwise order, at least one.
+ * @return The rectangle; degenerate (area 0) when the hull is a point or a segment.
+ */
+BoundingRect min_bounding_rect(const std::vector<Point>& hull);
+
+/**
+ * @struct HullWorkspace
+ * @brief Reusable scratch and output storage for hull computations.
+ *
+ * The buffers only grow, so once they have reached the working size a hull
+ * computation performs no allocation. Keep one workspace per thread; it must
+ * not be used by two calls at the same time.
+ */
+struct HullWorkspace {
+    std::vector<size_t> order; // Input indices, sorted lexicographically by point
+    std::vector<Point> hull;   // Output: hull vertices in counter-clockwise order
+    std::vector<Point> chain;  // Scratch chain used while walking a DynamicHull
+};
+
+/**
+ * @brief Computes the convex hull without copying the input or allocating after warm-up.
+ *
+ * Sorts an index buffer instead of the points and writes the hull into the
+ * workspace. The result matches the by-value overload.
+ *
+ * @param points A deque of input points.
+ * @param workspace Scratch storage reused across calls.
+ * @return workspace.hull, holding the hull in counter-clockwise order.
+ */
+const std::vector<Point>& compute_convex_hull_deque(const std::deque<Point>& points, HullWorkspace& workspace);
+
+/**
+ * @brief Computes the convex hull of a PointCloud into a reusable workspace.
+ *
+ * @param points The input points.
+ * @param workspace Scratch storage reused across calls.
+ * @return workspace.hull, holding the hull in counter-clockwise order.
+ */
+const std::vector<Point>& compute_convex_hull_deque(const PointCloud& points, HullWorkspace& workspace);
+
+/**
+ * @brief Tree node used internally by DynamicHull.
+ */
+struct DynamicHullNode;
+
+#define HULL_BATCH_REBUILD 8 // A batch of size() / HULL_BATCH_REBUILD points or more rebuilds the tree
+
+/**
+ * @class BasicDynamicHull
+ * @brief Convex hull of a point set that supports both insertion and deletion.
+ *
+ * Points are kept in the leaves of a weight-balanced binary tree ordered
+ * lexicographically. Every internal node stores the upper and lower bridges
+ * between the hulls of its two subtrees (Overmars-van Leeuwen), so the hull of
+ * any subtree can be walked without being stored explicitly. An update
+ * recomputes the bridges on one root-to-leaf path and stops as soon as the
+ * point is strictly inside a subtree hull, giving O(log^3 n) worst case and
+ * close to O(log n) for the usual interior points. The area is cached until
+ * the hull changes.
+ *
+ * Every orientation test goes through the Orientation policy,
+ * FastOrientation or RobustOrientation; both are compiled in GeometryUtils.cpp.
+ */
+template <class Orientation>
+class BasicDynamicHull {
+public:
+    BasicDynamicHull();
+    ~BasicDynamicHull();
+    BasicDynamicHull(const BasicDynamicHull&) = delete;
+    BasicDynamicHull& operator=(const BasicDynamicHull&) = delete;
+
+    /**
+     * @brief Adds a point to the set. Duplicates are counted.
+     *
+     * @param p The point to add.
+     */
+    void insert(const Point& p);
+
+    /**
+     * @brief Removes every copy of a point from the set.
+     *
+     * @param p The point to remove.
+     * @return The number of copies removed (0 if the point was not present).
+     */
+    size_t erase(const Point& p);
+
+    /**
+     * @brief Adds a batch of points. Duplicates are counted.
+     *
+     * A batch of at least size() / HULL_BATCH_REBUILD points is merged into
+     * the sorted leaves and the tree rebuilt once, which beats one update per
+     * point; smaller batches go through insert().
+     *
+     * @param points The points to add.
+     */
+    void insert_batch(const std::vector<Point>& points);
+
+    /**
+     * @brief Removes every copy of each point of a batch, like erase() per point.
+     *
+     * Large batches rebuild the tree once, as in insert_batch().
+     *
+     * @param points The points to remove; points not in the set are ignored.
+     * @return The number of copies removed.
+     */
+    size_t erase_batch(const std::vector<Point>& points);
+
+    /**
+     * @brief Replaces the whole set with the given points in O(n log n).
+     *
+     * @param points The new point set.
+     */
+    void assign(const std::deque<Point>& points);
+
+    /**
+     * @brief Replaces the whole set with the points of a PointCloud in O(n log n).
+     *
+     * @param points The new point set.
+     */
+    void assign(const PointCloud& points);
+
+    /**
+     * @brief Removes all points.
+     */
+    void clear();
+
+    /**
+     * @brief Exchanges the contents of two hulls in O(1).
+     *
+     * Lets a replacement hull be built without holding the lock that guards
+     * the one in use.
+     *
+     * @param other The hull to swap with.
+     */
+    void swap(BasicDynamicHull& other);
+
+    /**
+     * @brief Returns the number of points in the set, counting duplicates.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Returns the hull vertices in counter-clockwise order.
+     *
+     * The result matches compute_convex_hull_deque() on the same set, in O(h log n).
+     *
+     * @return A deque of points forming the convex hull.
+     */
+    std::deque<Point> vertices() const;
+
+    /**
+     * @brief Returns the area of the convex hull, cached until the hull changes.
+     */
+    double area() const;
+
+    /**
+     * @brief Writes the hull vertices into a workspace in counter-clockwise order.
+     *
+     * Same result as vertices() without allocating once the workspace is warm.
+     *
+     * @param workspace Scratch storage reused across calls.
+     * @return workspace.hull.
+     */
+    const std::vector<Point>& vertices(HullWorkspace& workspace) const;
+
+    /**
+     * @brief Returns the cached area, recomputing it through a workspace when stale.
+     *
+     * @param workspace Scratch storage reused across calls.
+     */
+    double area(HullWorkspace& workspace) const;
+
+private:
+    /**
+     * @brief Rebuilds the tree from lexicographically sorted points.
+     */
+    void build(const std::vector<Point>& sorted);
+
+    DynamicHullNode* root;      // Root of the tree, nullptr when empty
+    size_t count;               // Number of points, counting duplicates
+    mutable bool area_valid;    // True if cached_area matches the current hull
+    mutable double cached_area; // Area of the current hull
+};
+
+/**
+ * @brief The hull engine the servers use: robust orientation at close to the speed of plain doubles.
+ */
+using DynamicHull = BasicDynamicHull<RobustOrientation>;
@@ -1,78 +1,338 @@
 #include "../include/Reactor.hpp"
+#include "../include/Metrics.hpp"
 #include <unordered_map>
 #include <sys/select.h>
+#if defined(__linux__)
+#define REACTOR_EPOLL 1
+#include <sys/epoll.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#define REACTOR_KQUEUE 1
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
 #include <unistd.h>
+#include <fcntl.h>
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <chrono>
 #include <vector>
+#include <algorithm>
+#if defined(REACTOR_EPOLL)
+#include <sys/eventfd.h>
+#endif
+
+typedef std::chrono::steady_clock::time_point ReactorTime;
+
+/**
+ * @struct ReactorHandler
+ * @brief The callback of a descriptor and the events it waits for.
+ */
+struct ReactorHandler {
+    reactorFunc func;
+    int events; // REACTOR_READ and/or REACTOR_WRITE
+};
+
+/**
+ * @struct ReactorTimer
+ * @brief A task the loop runs at a deadline, then every interval if it repeats.
+ */
+struct ReactorTimer {
+    std::chrono::milliseconds interval; // 0 for a one-shot timer
+    reactorTask task;
+};
 
 /**
  * @struct Reactor
  * @brief Internal data structure for the reactor loop.
  */
 struct Reactor {
-    std::unordered_map<int, reactorFunc> handlers;
+    std::unordered_map<int, ReactorHandler> handlers;
     std::mutex lock;
     std::atomic<bool> running;
     std::thread loopThread;
+    int pollFd;
+    int wakeFd; // Read end of the wakeup eventfd or pipe, watched by the loop
+    int wakeWriteFd; // Write end, the same descriptor for an eventfd
+    std::atomic<bool> wakePending{false}; // A wakeup was written and not drained yet
+    // Guarded by `lock`, like `handlers`
+    std::vector<reactorTask> tasks; // Posted by postToReactor(), run in order by the loop
+    std::vector<std::pair<ReactorTime, int>> timerHeap; // Deadline and id, earliest first; cancelled ids are skipped
+    std::unordered_map<int, ReactorTimer> timers; // Live timers by id
+    int nextTimerId = 1;
 };
 
 /**
- * @brief The internal event loop that waits for I/O and dispatches handlers.
- * 
- * @param reactor Pointer to the Reactor instance.
+ * @brief Maximum number of ready descriptors fetched per wait.
  */
-static void reactorLoop(Reactor* reactor) {
-    while (reactor->running) {
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        int maxfd = -1;
-
-        // Collect all active file descriptors
-        {
-            std::lock_guard<std::mutex> guard(reactor->lock);
-            for (const auto& pair : reactor->handlers) {
-                FD_SET(pair.first, &readfds);
-                if (pair.first > maxfd) maxfd = pair.first;
-            }
+static const int REACTOR_MAX_EVENTS = 256;
+
+/**
+ * @brief Opens the kernel event queue backing the reactor.
+ *
+ * @param reactor Pointer to the reactor instance.
+ * @return true on success.
+ */
+static bool openPoller(Reactor* reactor) {
+#if defined(REACTOR_EPOLL)
+    reactor->pollFd = epoll_create1(EPOLL_CLOEXEC);
+#elif defined(REACTOR_KQUEUE)
+    reactor->pollFd = kqueue();
+#else
+    reactor->pollFd = -1;
+    return true;
+#endif
+    return reactor->pollFd >= 0;
+}
+
+/**
+ * @brief Opens the descriptor other threads write to wake the loop: an eventfd on Linux, a pipe elsewhere.
+ *
+ * @param reactor Pointer to the reactor instance.
+ * @return true on success.
+ */
+static bool openWakeup(Reactor* reactor) {
+#if defined(REACTOR_EPOLL)
+    reactor->wakeFd = reactor->wakeWriteFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return reactor->wakeFd >= 0;
+#else
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    for (int fd : fds) {
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    reactor->wakeFd = fds[0];
+    reactor->wakeWriteFd = fds[1];
+    return true;
+#endif
+}
+
+/**
+ * @brief Makes the loop return from its wait, once however many threads ask before it drains.
+ *
+ * @param reactor Pointer to the reactor instance.
+ */
+static void wakeReactor(Reactor* reactor) {
+    if (reactor->wakePending.exchange(true)) return;
+    uint64_t one = 1;
+    ssize_t written = write(reactor->wakeWriteFd, &one, sizeof(one));
+    (void)written; // Only fails if the pipe is full, which already wakes the loop
+}
+
+/**
+ * @brief Empties the wakeup descriptor. Called by the loop before it runs the posted tasks.
+ *
+ * @param reactor Pointer to the reactor instance.
+ */
+static void drainWakeup(Reactor* reactor) {
+    reactor->wakePending = false; // Before reading, so a post racing with the drain wakes the loop again
+    char buffer[64];
+    while (read(reactor->wakeFd, buffer, sizeof(buffer)) > 0) {
+    }
+}
+
+/**
+ * @brief Starts watching a descriptor, or changes the events it is watched for. Called with `lock` held.
+ *
+ * @param reactor Pointer to the reactor instance.
+ * @param fd The file descriptor to watch.
+ * @param events REACTOR_READ and/or REACTOR_WRITE.
+ * @param modify true if fd is already watched.
+ * @return 0 on success, -1 on failure.
+ */
+static int watchFd(Reactor* reactor, int fd, int events, bool modify) {
+#if defined(REACTOR_EPOLL)
+    epoll_event ev{};
+    ev.events = ((events & REACTOR_READ) ? EPOLLIN : 0) | ((events & REACTOR_WRITE) ? EPOLLOUT : 0);
+    ev.data.fd = fd;
+    return epoll_ctl(reactor->pollFd, modify ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev) == 0 ? 0 : -1;
+#elif defined(REACTOR_KQUEUE)
+    // kqueue has one filter per event; deleting one that was never added fails harmlessly
+    struct kevent ev[2];
+    EV_SET(&ev[0], fd, EVFILT_READ, (events & REACTOR_READ) ? EV_ADD : EV_DELETE, 0, 0, nullptr);
+    EV_SET(&ev[1], fd, EVFILT_WRITE, (events & REACTOR_WRITE) ? EV_ADD : EV_DELETE, 0, 0, nullptr);
+    for (struct kevent& change : ev) {
+        if (kevent(reactor->pollFd, &change, 1, nullptr, 0, nullptr) != 0 && (change.flags & EV_ADD)) return -1;
+    }
+    (void)modify;
+    return 0;
+#else
+    (void)reactor;
+    (void)events;
+    (void)modify;
+    return fd < FD_SETSIZE ? 0 : -1;
+#endif
+}
+
+/**
+ * @brief Stops watching a descriptor. Called with `lock` held.
+ *
+ * Errors are ignored: the kernel already dropped the registration if the
+ * descriptor was closed first.
+ *
+ * @param reactor Pointer to the reactor instance.
+ * @param fd The file descriptor to forget.
+ */
+static void unwatchFd(Reactor* reactor, int fd) {
+#if defined(REACTOR_EPOLL)
+    epoll_ctl(reactor->pollFd, EPOLL_CTL_DEL, fd, nullptr);
+#elif defined(REACTOR_KQUEUE)
+    struct kevent ev[2];
+    EV_SET(&ev[0], fd, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+    EV_SET(&ev[1], fd, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+    for (struct kevent& change : ev) kevent(reactor->pollFd, &change, 1, nullptr, 0, nullptr);
+#else
+    (void)reactor;
+    (void)fd;
+#endif
+}
+
+/**
+ * @brief Returns how long the loop may wait: until the earliest timer, or -1 for no limit.
+ *
+ * @param reactor Pointer to the reactor instance.
+ * @return The timeout in milliseconds, rounded up so the loop never wakes just before a deadline.
+ */
+static int nextTimeoutMs(Reactor* reactor) {
+    std::lock_guard<std::mutex> guard(reactor->lock);
+    if (reactor->timerHeap.empty()) return -1;
+    auto wait = reactor->timerHeap.front().first - std::chrono::steady_clock::now();
+    if (wait <= wait.zero()) return 0;
+    return static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(wait).count());
+}
+
+/**
+ * @brief Waits until a descriptor is ready, the timeout expires or another thread wakes the loop.
+ *
+ * epoll (Linux) and kqueue (BSD/macOS) keep the registrations in the kernel
+ * and return only the ready descriptors, so a wakeup costs O(ready) and there
+ * is no FD_SETSIZE limit. Other systems rebuild the fd_sets for select().
+ *
+ * @param reactor Pointer to the reactor instance.
+ * @param ready Receives the ready file descriptors, the wakeup descriptor included.
+ *              With kqueue a descriptor both readable and writable appears twice.
+ * @param timeoutMs Longest wait in milliseconds, -1 for no limit.
+ */
+static void waitForEvents(Reactor* reactor, std::vector<int>& ready, int timeoutMs) {
+    ready.clear();
+#if defined(REACTOR_EPOLL)
+    epoll_event events[REACTOR_MAX_EVENTS];
+    int n = epoll_wait(reactor->pollFd, events, REACTOR_MAX_EVENTS, timeoutMs);
+    for (int i = 0; i < n; ++i) ready.push_back(events[i].data.fd);
+#elif defined(REACTOR_KQUEUE)
+    struct kevent events[REACTOR_MAX_EVENTS];
+    struct timespec timeout = {timeoutMs / 1000, (timeoutMs % 1000) * 1000000L};
+    int n = kevent(reactor->pollFd, nullptr, 0, events, REACTOR_MAX_EVENTS, timeoutMs < 0 ? nullptr : &timeout);
+    for (int i = 0; i < n; ++i) ready.push_back(static_cast<int>(events[i].ident));
+#else
+    fd_set readfds, writefds;
+    FD_ZERO(&readfds);
+    FD_ZERO(&writefds);
+    FD_SET(reactor->wakeFd, &readfds);
+    int maxfd = reactor->wakeFd;
+    {
+        std::lock_guard<std::mutex> guard(reactor->lock);
+        for (const auto& pair : reactor->handlers) {
+            if (pair.second.events & REACTOR_READ) FD_SET(pair.first, &readfds);
+            if (pair.second.events & REACTOR_WRITE) FD_SET(pair.first, &writefds);
+            if (pair.first > maxfd) maxfd = pair.first;
         }
-        // No FDs to wait on, sleep briefly
-        if (maxfd == -1) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            continue;
+    }
+
+    struct timeval tv = {timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+    if (select(maxfd + 1, &readfds, &writefds, nullptr, timeoutMs < 0 ? nullptr : &tv) <= 0) return;
+
+    if (FD_ISSET(reactor->wakeFd, &readfds)) ready.push_back(reactor->wakeFd);
+    std::lock_guard<std::mutex> guard(reactor->lock);
+    for (const auto& pair : reactor->handlers) {
+        if (FD_ISSET(pair.first, &readfds) || FD_ISSET(pair.first, &writefds)) ready.push_back(pair.first);
+    }
+#endif
+}
+
+/**
+ * @brief Runs the timers whose deadline has passed, rescheduling the repeating ones.
+ *
+ * A repeating timer that fell behind skips the ticks it missed instead of
+ * firing once per missed tick.
+ *
+ * @param reactor Pointer to the reactor instance.
+ */
+static void runDueTimers(Reactor* reactor) {
+    ReactorTime now = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> guard(reactor->lock);
+    std::vector<std::pair<ReactorTime, int>>& heap = reactor->timerHeap;
+    while (!heap.empty() && heap.front().first <= now) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<ReactorTime, int>>());
+        std::pair<ReactorTime, int> due = heap.back();
+        heap.pop_back();
+        auto it = reactor->timers.find(due.second);
+        if (it == reactor->timers.end()) continue; // Cancelled
+        reactorTask task = it->second.task;
+        std::chrono::milliseconds interval = it->second.interval;
+        if (interval.count() > 0) {
+            ReactorTime next = due.first + interval;
+            if (next <= now) next = now + interval;
+            heap.emplace_back(next, due.second);
+            std::push_heap(heap.begin(), heap.end(), std::greater<std::pair<ReactorTime, int>>());
+        } else {
+            reactor->timers.erase(it);
         }
+        guard.unlock(); // The task may add or cancel timers
+        task();
+        guard.lock();
+    }
+}
 
-        // Wait for activity on any file descriptor
-        struct timeval tv = {1, 0}; // Timeout: 1 second
-        int ready = select(maxfd + 1, &readfds, nullptr, nullptr, &tv);
+/**
+ * @brief Runs the tasks posted since the last iteration, in posting order.
+ *
+ * @param reactor Pointer to the reactor instance.
+ * @param batch Scratch vector, swapped with the queue so posting threads never wait for the tasks.
+ */
+static void runPostedTasks(Reactor* reactor, std::vector<reactorTask>& batch) {
+    {
+        std::lock_guard<std::mutex> guard(reactor->lock);
+        batch.swap(reactor->tasks);
+    }
+    for (reactorTask& task : batch) task();
+    batch.clear();
+}
 
-        if (ready > 0) {
-            std::vector<int> ready_fds;
+/**
+ * @brief The internal loop that runs the reactor.
+ *
+ * Sleeps until a descriptor is ready, the earliest timer is due or a task is
+ * posted. Each iteration invokes the callback of every ready descriptor that
+ * is still registered (a callback may remove other descriptors before their
+ * turn), then the due timers, then the posted tasks.
+ *
+ * @param reactor Pointer to the reactor instance.
+ */
+static void reactorLoop(Reactor* reactor) {
+    std::vector<int> ready_fds;
+    std::vector<reactorTask> tasks;
+    while (reactor->running) {
+        waitForEvents(reactor, ready_fds, nextTimeoutMs(reactor));
+        metrics_count(Counter::LoopIterations);
+        metrics_count(Counter::LoopReadyFds, ready_fds.size());
+        for (int fd : ready_fds) {
+            if (fd == reactor->wakeFd) {
+                drainWakeup(reactor);
+                continue;
+            }
+            reactorFunc func;
             {
                 std::lock_guard<std::mutex> guard(reactor->lock);
-                for (const auto& pair : reactor->handlers) {
-                    if (FD_ISSET(pair.first, &readfds)) {
-                        ready_fds.push_back(pair.first);
-                    }
-                }
-            }
-
-            // Call handlers for all ready file descriptors
-            for (int fd : ready_fds) {
-                reactorFunc func;
-                {
-                    std::lock_guard<std::mutex> guard(reactor->lock);
-                    auto it = reactor->handlers.find(fd);
-                    if (it != reactor->handlers.end()) {
-                        func = it->second;
-                    } else {
-                        continue;
-                    }
-                }
-                func(fd);
+                auto it = reactor->handlers.find(fd);
+                if (it == reactor->handlers.end()) continue;
+                func = it->second.func;
             }
+            func(fd);
         }
+        runDueTimers(reactor);
+        runPostedTasks(reactor, tasks);
     }
 }
 
@@ -83,6 +343,15 @@ static void reactorLoop(Reactor* reactor) {
  */
 void* startReactor() {
     Reactor* reactor = new Reactor;
+    if (!openPoller(reactor)) {
+        delete reactor;
+        return nullptr;
+    }
+    if (!openWakeup(reactor) || watchFd(reactor, reactor->wakeFd, REACTOR_READ, false) != 0) {
+        if (reactor->pollFd >= 0) close(reactor->pollFd);
+        delete reactor;
+        return nullptr;
+    }
     reactor->running = true;
     reactor->loopThread = std::thread(reactorLoop, reactor);
     return reactor;
@@ -94,12 +363,38 @@ void* startReactor() {
  * @param reactorPtr Pointer to the Reactor instance
  * @param fd File descriptor to monitor
  * @param func Callback function to call when fd is ready
- * @return int Always returns 0
+ * @param events REACTOR_READ and/or REACTOR_WRITE.
+ * @return 0 on success, -1 on failure.
  */
-int addFdToReactor(void* reactorPtr, int fd, reactorFunc func) {
+int addFdToReactor(void* reactorPtr, int fd, reactorFunc func, int events) {
     Reactor* reactor = static_cast<Reactor*>(reactorPtr);
     std::lock_guard<std::mutex> guard(reactor->lock);
-    reactor->handlers[fd] = func;
+    auto it = reactor->handlers.find(fd);
+    if (it == reactor->handlers.end()) {
+        if (watchFd(reactor, fd, events, false) != 0) return -1;
+    } else if (it->second.events != events && watchFd(reactor, fd, events, true) != 0) {
+        return -1;
+    }
+    reactor->handlers[fd] = ReactorHandler{func, events};
+    return 0;
+}
+
+/**
+ * @brief Changes the events a registered file descriptor is watched for.
+ *
+ * @param reactorPtr Pointer to the reactor instance.
+ * @param fd A registered file descriptor.
+ * @param events REACTOR_READ and/or REACTOR_WRITE.
+ * @return 0 on success, -1 if fd is not registered or the kernel refused.
+ */
+int modifyFdInReactor(void* reactorPtr, int fd, int events) {
+    Reactor* reactor = static_cast<Reactor*>(reactorPtr);
+    std::lock_guard<std::mutex> guard(reactor->lock);
+    auto it = reactor->handlers.find(fd);
+    if (it == reactor->handlers.end()) return -1;
+    if (it->second.events == events) return 0;
+    if (watchFd(reactor, fd, events, true) != 0) return -1;
+    it->second.events = events;
     return 0;
 }
 
@@ -113,7 +408,67 @@ int addFdToReactor(void* reactorPtr, int fd, reactorFunc func) {
 int removeFdFromReactor(void* reactorPtr, int fd) {
     Reactor* reactor = static_cast<Reactor*>(reactorPtr);
     std::lock_guard<std::mutex> guard(reactor->lock);
-    reactor->handlers.erase(fd);
+    if (reactor->handlers.erase(fd) > 0) unwatchFd(reactor, fd);
+    return 0;
+}
+
+/**
+ * @brief Schedules a task on the reactor's loop after a delay, and optionally every interval after that.
+ *
+ * Wakes the loop if the new timer is due before the one it is sleeping for.
+ *
+ * @param reactorPtr Pointer to the reactor instance.
+ * @param delayMs Milliseconds until the first run.
+ * @param task The task to run.
+ * @param intervalMs Milliseconds between later runs, 0 for a one-shot timer.
+ * @return The timer's id, or -1 if a delay or interval is negative.
+ */
+int addTimerToReactor(void* reactorPtr, int delayMs, reactorTask task, int intervalMs) {
+    Reactor* reactor = static_cast<Reactor*>(reactorPtr);
+    if (delayMs < 0 || intervalMs < 0) return -1;
+    ReactorTime deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(delayMs);
+    int id;
+    bool earliest;
+    {
+        std::lock_guard<std::mutex> guard(reactor->lock);
+        id = reactor->nextTimerId++;
+        reactor->timers[id] = ReactorTimer{std::chrono::milliseconds(intervalMs), std::move(task)};
+        reactor->timerHeap.emplace_back(deadline, id);
+        std::push_heap(reactor->timerHeap.begin(), reactor->timerHeap.end(),
+                       std::greater<std::pair<ReactorTime, int>>());
+        earliest = reactor->timerHeap.front().second == id;
+    }
+    if (earliest) wakeReactor(reactor);
+    return id;
+}
+
+/**
+ * @brief Cancels a timer; a run already in progress still completes.
+ *
+ * @param reactorPtr Pointer to the reactor instance.
+ * @param timerId An id returned by addTimerToReactor().
+ * @return 0 on success, -1 if the timer already fired (one-shot) or was cancelled.
+ */
+int cancelReactorTimer(void* reactorPtr, int timerId) {
+    Reactor* reactor = static_cast<Reactor*>(reactorPtr);
+    std::lock_guard<std::mutex> guard(reactor->lock);
+    return reactor->timers.erase(timerId) > 0 ? 0 : -1; // Its heap entry is skipped when it comes up
+}
+
+/**
+ * @brief Queues a task for the reactor's loop and wakes it.
+ *
+ * @param reactorPtr Pointer to the reactor instance.
+ * @param task The task to run.
+ * @return 0 on success.
+ */
+int postToReactor(void* reactorPtr, reactorTask task) {
+    Reactor* reactor = static_cast<Reactor*>(reactorPtr);
+    {
+        std::lock_guard<std::mutex> guard(reactor->lock);
+        reactor->tasks.push_back(std::move(task));
+    }
+    wakeReactor(reactor);
     return 0;
 }
 
@@ -126,9 +481,179 @@ int removeFdFromReactor(void* reactorPtr, int fd) {
 int stopReactor(void* reactorPtr) {
     Reactor* reactor = static_cast<Reactor*>(reactorPtr);
     reactor->running = false;
+    wakeReactor(reactor); // Instead of waiting for the next event or timer
     if (reactor->loopThread.joinable()) {
         reactor->loopThread.join();
     }
+    if (reactor->pollFd >= 0) close(reactor->pollFd);
+    if (reactor->wakeWriteFd != reactor->wakeFd) close(reactor->wakeWriteFd);
+    close(reactor->wakeFd);
     delete reactor;
     return 0;
 }
+
+/**
+ * @struct ReactorPool
+ * @brief Several reactors sharing the descriptors of one server.
+ */
+struct ReactorPool {
+    std::vector<Reactor*> loops;
+    std::unordered_map<int, size_t> owner; // Loop index watching each descriptor
+    std::mutex lock;                        // Guards `owner` and `next`
+    size_t next = 0;                        // Where the next least-loaded scan starts
+};
+
+/**
+ * @brief Picks the loop watching the fewest descriptors. Called with the pool lock held.
+ *
+ * Scanning starts after the previous pick, so equally loaded loops are used round-robin.
+ *
+ * @param pool Pointer to the pool instance.
+ * @return Index of the chosen loop.
+ */
+static size_t leastLoadedLoop(ReactorPool* pool) {
+    size_t n = pool->loops.size(), best = pool->next % n, bestLoad = static_cast<size_t>(-1);
+    for (size_t k = 0; k < n; ++k) {
+        size_t i = (pool->next + k) % n;
+        std::lock_guard<std::mutex> guard(pool->loops[i]->lock);
+        if (pool->loops[i]->handlers.size() < bestLoad) {
+            bestLoad = pool->loops[i]->handlers.size();
+            best = i;
+        }
+    }
+    pool->next = best + 1;
+    return best;
+}
+
+/**
+ * @brief Starts n reactors, each with its own loop thread.
+ *
+ * @param n Number of loops; 0 or less starts one per hardware thread.
+ * @return Pointer to the pool, or nullptr on failure.
+ */
+void* startReactorPool(int n) {
+    if (n <= 0) n = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    ReactorPool* pool = new ReactorPool;
+    for (int i = 0; i < n; ++i) {
+        void* loop = startReactor();
+        if (!loop) {
+            stopReactorPool(pool);
+            return nullptr;
+        }
+        pool->loops.push_back(static_cast<Reactor*>(loop));
+    }
+    return pool;
+}
+
+/**
+ * @brief Returns the number of loops in the pool.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @return The loop count.
+ */
+int reactorPoolSize(void* poolPtr) {
+    return static_cast<int>(static_cast<ReactorPool*>(poolPtr)->loops.size());
+}
+
+/**
+ * @brief Returns one loop of the pool, for addTimerToReactor() and postToReactor().
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @param loop Index of the loop.
+ * @return The loop's reactor, or nullptr if loop is out of range.
+ */
+void* reactorPoolLoop(void* poolPtr, int loop) {
+    ReactorPool* pool = static_cast<ReactorPool*>(poolPtr);
+    if (loop < 0 || static_cast<size_t>(loop) >= pool->loops.size()) return nullptr;
+    return pool->loops[loop];
+}
+
+/**
+ * @brief Registers a file descriptor with one loop of the pool.
+ *
+ * A descriptor that is already registered keeps its loop and only gets the new callback.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @param fd The file descriptor to monitor.
+ * @param func The callback function to invoke when the fd is ready.
+ * @param loop Index of the loop to use, or -1 for the least loaded one.
+ * @param events REACTOR_READ and/or REACTOR_WRITE.
+ * @return 0 on success, -1 on failure.
+ */
+int addFdToReactorPool(void* poolPtr, int fd, reactorFunc func, int loop, int events) {
+    ReactorPool* pool = static_cast<ReactorPool*>(poolPtr);
+    std::lock_guard<std::mutex> guard(pool->lock);
+    size_t index;
+    auto it = pool->owner.find(fd);
+    if (it != pool->owner.end()) {
+        index = it->second;
+    } else if (loop >= 0) {
+        if (static_cast<size_t>(loop) >= pool->loops.size()) return -1;
+        index = static_cast<size_t>(loop);
+    } else {
+        index = leastLoadedLoop(pool);
+    }
+    if (addFdToReactor(pool->loops[index], fd, func, events) != 0) return -1;
+    pool->owner[fd] = index;
+    return 0;
+}
+
+/**
+ * @brief Changes the events a descriptor is watched for by the loop that watches it.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @param fd A registered file descriptor.
+ * @param events REACTOR_READ and/or REACTOR_WRITE.
+ * @return 0 on success, -1 on failure.
+ */
+int modifyFdInReactorPool(void* poolPtr, int fd, int events) {
+    ReactorPool* pool = static_cast<ReactorPool*>(poolPtr);
+    std::lock_guard<std::mutex> guard(pool->lock);
+    auto it = pool->owner.find(fd);
+    if (it == pool->owner.end()) return -1;
+    return modifyFdInReactor(pool->loops[it->second], fd, events);
+}
+
+/**
+ * @brief Removes a file descriptor from the loop that watches it.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @param fd The file descriptor to remove.
+ * @return 0 on success, -1 on failure.
+ */
+int removeFdFromReactorPool(void* poolPtr, int fd) {
+    ReactorPool* pool = static_cast<ReactorPool*>(poolPtr);
+    std::lock_guard<std::mutex> guard(pool->lock);
+    auto it = pool->owner.find(fd);
+    if (it == pool->owner.end()) return 0;
+    removeFdFromReactor(pool->loops[it->second], fd);
+    pool->owner.erase(it);
+    return 0;
+}
+
+/**
+ * @brief Returns the index of the loop watching a file descriptor.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @param fd A registered file descriptor.
+ * @return The loop index, or -1 if fd is not registered.
+ */
+int reactorPoolLoopOf(void* poolPtr, int fd) {
+    ReactorPool* pool = static_cast<ReactorPool*>(poolPtr);
+    std::lock_guard<std::mutex> guard(pool->lock);
+    auto it = pool->owner.find(fd);
+    return it == pool->owner.end() ? -1 : static_cast<int>(it->second);
+}
+
+/**
+ * @brief Stops every loop of the pool, joins their threads and deletes the pool.
+ *
+ * @param poolPtr Pointer to the pool instance.
+ * @return 0 on success, -1 on failure.
+ */
+int stopReactorPool(void* poolPtr) {
+    ReactorPool* pool = static_cast<ReactorPool*>(poolPtr);
+    for (Reactor* loop : pool->loops) stopReactor(loop);
+    delete pool;
+    return 0;
+}
@@ -0,0 +1,293 @@
+#include "../include/StateStore.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Writes a whole buffer, retrying short and interrupted writes.
+ *
+ * @return false on a write error (errno is set).
+ */
+static bool write_all(int fd, const void* data, size_t length) {
+    const char* bytes = static_cast<const char*>(data);
+    while (length > 0) {
+        ssize_t written = ::write(fd, bytes, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        length -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * @brief Maps a snapshot file and loads its points and hull.
+ *
+ * @param fd The open snapshot file; closed by this call.
+ * @param points Receives the points.
+ * @param hull Receives the hull vertices.
+ * @param generation Receives the first log to replay.
+ * @param error Receives a message on failure.
+ * @return true on success.
+ */
+static bool load_snapshot(int fd, PointCloud& points, std::vector<Point>& hull, uint64_t& generation,
+                          std::string& error) {
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        error = std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    size_t length = static_cast<size_t>(info.st_size);
+    if (length < sizeof(SnapshotHeader)) {
+        error = "snapshot is truncated";
+        ::close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (base == MAP_FAILED) {
+        error = std::strerror(errno);
+        return false;
+    }
+    madvise(base, length, MADV_SEQUENTIAL);
+
+    SnapshotHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    size_t payload = length - sizeof(SnapshotHeader);
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        error = "not a snapshot file";
+    } else if (header.byte_order != STATE_BYTE_ORDER) {
+        error = "snapshot was written on a host of the other byte order";
+    } else if (header.point_count > payload / (2 * sizeof(double)) ||
+               header.hull_count > payload / (2 * sizeof(double)) ||
+               payload != (header.point_count + header.hull_count) * 2 * sizeof(double)) {
+        error = "snapshot size does not match its header";
+    } else {
+        const double* xs = reinterpret_cast<const double*>(static_cast<const char*>(base) + sizeof(header));
+        const double* ys = xs + header.point_count;
+        const double* vertices = ys + header.point_count;
+        points.reserve(header.point_count);
+        for (uint64_t i = 0; i < header.point_count; ++i) points.push_back(Point{xs[i], ys[i]});
+        hull.reserve(header.hull_count);
+        for (uint64_t i = 0; i < header.hull_count; ++i) hull.push_back(Point{vertices[2 * i], vertices[2 * i + 1]});
+        generation = header.generation;
+    }
+    munmap(base, length);
+    return error.empty();
+}
+
+/**
+ * @brief Applies the whole records of a log to a point set.
+ *
+ * Replay stops at the first record with an unknown op, which is where a
+ * write was cut short.
+ *
+ * @param fd The open log file.
+ * @param points The point set to update.
+ * @param records Receives the number of records applied.
+ * @param error Receives a message on failure.
+ * @return true on success, including for a torn log.
+ */
+static bool replay_log(int fd, PointCloud& points, size_t& records, std::string& error) {
+    records = 0;
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+    size_t length = static_cast<size_t>(info.st_size);
+    if (length < sizeof(LogRecord)) return true;
+    void* base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) {
+        error = std::strerror(errno);
+        return false;
+    }
+    madvise(base, length, MADV_SEQUENTIAL);
+
+    const LogRecord* log = static_cast<const LogRecord*>(base);
+    size_t whole = length / sizeof(LogRecord);
+    for (; records < whole; ++records) {
+        const LogRecord& record = log[records];
+        Point p{record.x, record.y};
+        if (record.op == static_cast<uint32_t>(LogOp::Insert)) {
+            points.push_back(p);
+        } else if (record.op == static_cast<uint32_t>(LogOp::Remove)) {
+            points.remove_all(p);
+        } else {
+            break;
+        }
+    }
+    munmap(base, length);
+    return true;
+}
+
+StateStore::~StateStore() {
+    if (writer.joinable()) writer.join();
+    if (log_fd >= 0) ::close(log_fd);
+}
+
+std::string StateStore::log_path(uint64_t log_generation) const {
+    return directory + "/log." + std::to_string(log_generation);
+}
+
+bool StateStore::open(const std::string& dir, PointCloud& points, std::vector<Point>& hull, std::string& error) {
+    directory = dir;
+    if (mkdir(dir.c_str(), 0755) < 0 && errno != EEXIST) {
+        error = dir + ": " + std::strerror(errno);
+        return false;
+    }
+
+    points.clear();
+    hull.clear();
+    generation = 0;
+    std::string snapshot_path = directory + "/snapshot";
+    int fd = ::open(snapshot_path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        if (!load_snapshot(fd, points, hull, generation, error)) {
+            error = snapshot_path + ": " + error;
+            return false;
+        }
+    } else if (errno != ENOENT) {
+        error = snapshot_path + ": " + std::strerror(errno);
+        return false;
+    }
+    oldest_log = generation;
+
+    // Replay the logs after the snapshot; more than one exists if a snapshot never completed
+    size_t replayed = 0;
+    size_t kept_bytes = 0; // Whole records of the newest log
+    for (uint64_t g = generation;; ++g) {
+        int log = ::open(log_path(g).c_str(), O_RDONLY);
+        if (log < 0) {
+            if (errno == ENOENT) break;
+            error = log_path(g) + ": " + std::strerror(errno);
+            return false;
+        }
+        size_t records = 0;
+        bool ok = replay_log(log, points, records, error);
+        ::close(log);
+        if (!ok) {
+            error = log_path(g) + ": " + error;
+            return false;
+        }
+        generation = g;
+        replayed += records;
+        kept_bytes = records * sizeof(LogRecord);
+    }
+    if (replayed > 0) hull.clear(); // The snapshot's hull is stale
+
+    // Keep appending to the newest log, dropping a torn tail so records stay aligned
+    log_fd = ::open(log_path(generation).c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (log_fd < 0 || ftruncate(log_fd, static_cast<off_t>(kept_bytes)) < 0) {
+        error = log_path(generation) + ": " + std::strerror(errno);
+        if (log_fd >= 0) ::close(log_fd);
+        log_fd = -1;
+        return false;
+    }
+    logged = replayed;
+    return true;
+}
+
+void StateStore::append(const LogRecord* records, size_t count) {
+    if (log_fd < 0 || count == 0) return;
+    if (!write_all(log_fd, records, count * sizeof(LogRecord))) {
+        std::cerr << "Cannot append to " << log_path(generation) << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    logged += count;
+}
+
+void StateStore::log_insert(const Point& p) {
+    LogRecord record{static_cast<uint32_t>(LogOp::Insert), 0, p.x, p.y};
+    append(&record, 1);
+}
+
+void StateStore::log_inserts(const std::vector<Point>& points) {
+    if (log_fd < 0) return;
+    batch.clear();
+    for (const Point& p : points) batch.push_back(LogRecord{static_cast<uint32_t>(LogOp::Insert), 0, p.x, p.y});
+    append(batch.data(), batch.size());
+}
+
+void StateStore::log_remove(const Point& p) {
+    LogRecord record{static_cast<uint32_t>(LogOp::Remove), 0, p.x, p.y};
+    append(&record, 1);
+}
+
+void StateStore::log_removes(const std::vector<Point>& points) {
+    if (log_fd < 0) return;
+    batch.clear();
+    for (const Point& p : points) batch.push_back(LogRecord{static_cast<uint32_t>(LogOp::Remove), 0, p.x, p.y});
+    append(batch.data(), batch.size());
+}
+
+bool StateStore::snapshot_due() const {
+    return log_fd >= 0 && logged >= SNAPSHOT_LOG_RECORDS && !writing;
+}
+
+bool StateStore::snapshot(const PointCloud& points, const std::vector<Point>& hull) {
+    if (log_fd < 0) return false;
+    if (writer.joinable()) writer.join();
+
+    // Changes made from now on belong to the new snapshot's log
+    int next = ::open(log_path(generation + 1).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (next < 0) {
+        std::cerr << "Cannot create " << log_path(generation + 1) << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    ::close(log_fd);
+    log_fd = next;
+    ++generation;
+    logged = 0;
+
+    std::vector<double> xs(points.xs(), points.xs() + points.size());
+    std::vector<double> ys(points.ys(), points.ys() + points.size());
+    writing = true;
+    writer = std::thread(&StateStore::write_snapshot, this, generation, std::move(xs), std::move(ys), hull);
+    return true;
+}
+
+void StateStore::write_snapshot(uint64_t snapshot_generation, std::vector<double> xs, std::vector<double> ys,
+                                std::vector<Point> hull) {
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.byte_order = STATE_BYTE_ORDER;
+    header.generation = snapshot_generation;
+    header.point_count = xs.size();
+    header.hull_count = hull.size();
+
+    std::vector<double> vertices;
+    vertices.reserve(2 * hull.size());
+    for (const Point& p : hull) {
+        vertices.push_back(p.x);
+        vertices.push_back(p.y);
+    }
+
+    // Write beside the old snapshot and rename, so a crash leaves one of the two intact
+    std::string path = directory + "/snapshot";
+    std::string temp = path + ".tmp";
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0 && write_all(fd, &header, sizeof(header)) &&
+              write_all(fd, xs.data(), xs.size() * sizeof(double)) &&
+              write_all(fd, ys.data(), ys.size() * sizeof(double)) &&
+              write_all(fd, vertices.data(), vertices.size() * sizeof(double)) && fsync(fd) == 0;
+    int saved_errno = errno;
+    if (fd >= 0) ::close(fd);
+    if (ok && std::rename(temp.c_str(), path.c_str()) == 0) {
+        for (; oldest_log < snapshot_generation; ++oldest_log) unlink(log_path(oldest_log).c_str());
+    } else {
+        if (ok) saved_errno = errno;
+        std::cerr << "Snapshot to " << path << " failed: " << std::strerror(saved_errno) << std::endl;
+        unlink(temp.c_str());
+    }
+    writing = false;
+}